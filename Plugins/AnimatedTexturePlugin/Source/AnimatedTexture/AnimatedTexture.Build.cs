@@ -23,6 +23,10 @@ public class AnimatedTexture : ModuleRules
 			);
 			
 		
+		// libwebp: enable the multi-threaded decode paths, the worker itself is provided by WebpWorker.cpp
+		PrivateDefinitions.Add("WEBP_USE_THREAD=1");
+		PrivateDefinitions.Add("WEBP_USE_EXTERNAL_WORKER=1");
+
 		PublicDependencyModuleNames.AddRange(
 			new string[]
 			{
@@ -45,6 +49,22 @@ public class AnimatedTexture : ModuleRules
 			);
 		
 		
+		if (Target.bBuildEditor)
+		{
+			// ITargetPlatform, used to strip the file data when cooking for servers
+			PrivateDependencyModuleNames.Add("TargetPlatform");
+
+			// bCookCompressedFrames: ITextureFormat compression, cached in the DDC
+			PrivateDependencyModuleNames.AddRange(
+				new string[]
+				{
+					"DerivedDataCache",
+					"ImageCore",
+					"TextureCompressor"
+				}
+				);
+		}
+
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
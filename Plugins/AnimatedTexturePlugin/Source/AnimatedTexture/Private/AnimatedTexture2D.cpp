@@ -11,74 +11,1033 @@
 
 // ReSharper disable All
 #include "AnimatedTexture2D.h"
+#include "AnimatedTexturePalette.h"
+#include "AnimatedTextureFrameArrayTiming.h"
+#include "AnimatedTexturePixelPacker.h"
 #include "AnimatedTextureResource.h"
 #include "AnimatedTextureCompat.h"
-#include "GIFDecoder.h"
-#include "WebpDecoder.h"
+#include "AnimatedTextureDecodeAhead.h"
+#include "AnimatedTextureFrameArray.h"
+#include "AnimatedTextureBakedFrames.h"
+#include "AnimatedTextureSubsystem.h"
+#include "AnimatedTextureStagingPool.h"
+#include "AnimatedTextureSharedSource.h"
+#include "AnimatedTextureSequenceDecoder.h"
+#include "AnimatedTextureLoadTask.h"
+#include "AnimatedTextureModule.h"
+#include "WebpEncoder.h"
 #include "RenderingThread.h"
+#include "Async/Async.h"
+#include "Misc/App.h"
 #include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_EDITOR
+#include "Interfaces/ITargetPlatform.h"
+
+static TAutoConsoleVariable<int32> CVarAnimTextureStripServerData(
+	TEXT("AnimatedTexture.StripServerData"),
+	1,
+	TEXT("Strip the GIF/WebP file data of animated textures when cooking for server-only targets.\n")
+	TEXT(" 0: keep the file data\n")
+	TEXT(" 1: keep only size/duration/frame count (default)"));
+#endif // WITH_EDITOR
+
+static TAutoConsoleVariable<float> CVarAnimTextureRenderedTimeout(
+	TEXT("AnimatedTexture.RenderedTimeout"),
+	1.0f,
+	TEXT("Textures with the WhenRendered tick policy pause decoding when no material has sampled them for this many seconds."));
+
+static TAutoConsoleVariable<int32> CVarAnimTextureMaxCatchUpFrames(
+	TEXT("AnimatedTexture.MaxCatchUpFrames"),
+	16,
+	TEXT("Maximum number of frames a texture skips in one tick to catch up with the clock after a hitch or a high PlayRate.\n")
+	TEXT("The rest of the backlog is caught up over the following ticks. Frames before a keyframe are skipped without decoding.\n")
+	TEXT(" 0: no limit"));
+
+static TAutoConsoleVariable<int32> CVarAnimTextureCompactUpload(
+	TEXT("AnimatedTexture.CompactUpload"),
+	0,
+	TEXT("Upload format of streamed animated textures whose Upload Format is Default, e.g. set per device profile for low-end devices.\n")
+	TEXT(" 0: BGRA8 (default)\n")
+	TEXT(" 1: 16-bit, RGB565 for opaque animations and RGBA5551 for GIF transparency\n")
+	TEXT("Takes effect when a texture resource is recreated."),
+	ECVF_Scalability);
+
+// 资源格式版本
+struct FAnimatedTextureCustomVersion
+{
+	enum Type
+	{
+		BeforeCustomVersionWasAdded = 0,
+
+		// 文件数据从 FileBlob 属性移到 FileBulkData
+		FileBulkData,
+
+		// Cook 时烘焙的压缩切片（BakedFormat + BakedFramesBulkData）
+		BakedFrames,
+
+		// 转码为 WebP 之前的原始文件（编辑器数据）
+		OriginalSource,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+const FGuid FAnimatedTextureCustomVersion::GUID(0x6A1E52C3, 0x4F0B4D8E, 0x9B27C1D4, 0x38E5A907);
+static FCustomVersionRegistration GRegisterAnimatedTextureCustomVersion(
+	FAnimatedTextureCustomVersion::GUID, FAnimatedTextureCustomVersion::LatestVersion, TEXT("AnimatedTextureVer"));
 
 float UAnimatedTexture2D::GetSurfaceWidth() const
 {
-	if (Decoder) return Decoder->GetWidth();
-	return 1.0f;
+	if (Decoder) return Decoder->GetWidth();
+	if (SourceWidth > 0) return SourceWidth;
+	return 1.0f;
+}
+
+float UAnimatedTexture2D::GetSurfaceHeight() const
+{
+	if (Decoder) return Decoder->GetHeight();
+	if (SourceHeight > 0) return SourceHeight;
+	return 1.0f;
+}
+
+bool UAnimatedTexture2D::IsHeadless()
+{
+	if (GIsEditor || IsRunningCommandlet())
+		return false;
+	return IsRunningDedicatedServer() || !FApp::CanEverRender();
+}
+
+void UAnimatedTexture2D::UpdateSourceMetadata(const FAnimatedTextureDecoder& InDecoder)
+{
+	SourceWidth = InDecoder.GetWidth();
+	SourceHeight = InDecoder.GetHeight();
+	SourceFrameCount = InDecoder.GetNumFrames();
+	AnimationLength = InDecoder.GetDuration(DefaultFrameDelay * 1000) / 1000.0f;
+	SupportsTransparency = InDecoder.SupportsTransparency();
+	bSourcePaletteIndexable = InDecoder.SupportsIndexedOutput();
+}
+
+void UAnimatedTexture2D::EnsureSourceMetadata()
+{
+	if (SourceFrameCount > 0)
+		return;
+
+	// 文件数据还在 bulk data 里时临时读入一份
+	TArray<uint8> BulkBytes;
+	const TArray<uint8>& Bytes = FileBlob.Num() > 0 || !ReadBulkPayload(BulkBytes) ? FileBlob : BulkBytes;
+	if (Bytes.Num() <= 0)
+		return;
+
+	// 只建立帧索引，不解码任何帧，用完立即释放
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Probe = CreateAnimatedTextureDecoder(FileType);
+	if (Probe && Probe->LoadFromMemory(Bytes.GetData(), Bytes.Num()))
+	{
+		UpdateSourceMetadata(*Probe);
+	}
+}
+
+bool UAnimatedTexture2D::ReadBulkPayload(TArray<uint8>& OutBytes)
+{
+	const int64 Size = FileBulkData.GetBulkDataSize();
+	if (Size <= 0 || Size > MAX_int32)
+		return false;
+
+	OutBytes.SetNumUninitialized(int32(Size));
+	void* Dest = OutBytes.GetData();
+	FileBulkData.GetCopy(&Dest, /*bDiscardInternalCopy=*/ true);
+	return true;
+}
+
+void UAnimatedTexture2D::RequestPayload()
+{
+	FByteBulkData& BulkData = HasBakedFrames() ? BakedFramesBulkData : FileBulkData;
+	if (bPayloadPending || BulkData.GetBulkDataSize() <= 0)
+		return;
+
+	// 读入的内存直接交给共享源，不再拷贝
+	const int64 Size = BulkData.GetBulkDataSize();
+	FSharedBuffer Payload = FSharedBuffer::TakeOwnership(FMemory::Malloc(Size), Size, FMemory::Free);
+
+	TWeakObjectPtr<UAnimatedTexture2D> WeakThis(this);
+	const uint32 Serial = ++PayloadSerial;
+	FBulkDataIORequestCallBack Callback = [WeakThis, Serial, Payload](bool bWasCancelled, IBulkDataIORequest*)
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Serial, Payload, bWasCancelled]()
+				{
+					UAnimatedTexture2D* Texture = WeakThis.Get();
+					if (Texture && Texture->PayloadSerial == Serial)
+						Texture->OnPayloadRead(bWasCancelled ? FSharedBuffer() : Payload);
+				});
+		};
+
+	PayloadIORequest = BulkData.CreateStreamingRequest(AIOP_Normal, &Callback,
+		static_cast<uint8*>(const_cast<void*>(Payload.GetData())));
+	if (!PayloadIORequest)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("UAnimatedTexture2D: failed to start reading the file data of %s."), *GetPathName());
+		return;
+	}
+	bPayloadPending = true;
+}
+
+void UAnimatedTexture2D::OnPayloadRead(FSharedBuffer Payload)
+{
+	check(IsInGameThread());
+
+	if (PayloadIORequest)
+	{
+		PayloadIORequest->WaitCompletion();
+		delete PayloadIORequest;
+		PayloadIORequest = nullptr;
+	}
+
+	if (Payload.IsNull())
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("UAnimatedTexture2D: reading the file data of %s was canceled."), *GetPathName());
+		bPayloadPending = false;
+		return;
+	}
+
+	if (HasBakedFrames())
+	{
+		bPayloadPending = false;
+		UploadBakedFrames(MoveTemp(Payload));
+		return;
+	}
+
+	// 解析与第一帧解码放在后台线程，GameThread 只在完成时交接
+	PayloadTask = FAnimatedTextureLoadTask::Prepare(Payload, FileType, EAnimatedTextureLoadPriority::Normal,
+		FAnimatedTextureLoadTask::FOnPrepared::CreateUObject(this, &UAnimatedTexture2D::OnPayloadPrepared));
+}
+
+void UAnimatedTexture2D::OnPayloadPrepared(FAnimatedTexturePreparedLoad& Prepared, EAnimatedTextureLoadError Error)
+{
+	PayloadTask.Reset();
+	bPayloadPending = false;
+
+	if (Error != EAnimatedTextureLoadError::None)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("UAnimatedTexture2D: failed to decode the file data of %s."), *GetPathName());
+		return;
+	}
+
+	SharedSource = MoveTemp(Prepared.Source);
+	PreparedDecoder = MoveTemp(Prepared.Decoder);
+
+	// 淘汰后重新读入：沿用原来的 RHI 纹理；首次读入：用真正的解码器重建占位资源
+	if (bDecodeStateEvicted)
+		RestoreDecodeState();
+	else
+		UpdateResource();
+}
+
+void UAnimatedTexture2D::CancelPayloadRequest()
+{
+	++PayloadSerial;
+	bPayloadPending = false;
+
+	if (PayloadTask)
+	{
+		PayloadTask->Cancel();
+		PayloadTask.Reset();
+	}
+
+	if (PayloadIORequest)
+	{
+		PayloadIORequest->Cancel();
+		PayloadIORequest->WaitCompletion();
+		delete PayloadIORequest;
+		PayloadIORequest = nullptr;
+	}
+}
+
+void UAnimatedTexture2D::ReleaseSourceForHeadless()
+{
+	EnsureSourceMetadata();
+	FileBlob.Empty();
+}
+
+bool UAnimatedTexture2D::AcquireSharedSource()
+{
+	if (!SharedSource)
+	{
+		// 游戏进程：FileBlob 整块交给共享源，不再拷贝一份
+		if (GIsEditor)
+			SharedSource = FAnimatedTextureSharedSource::FindOrCreate(FileType, FileBlob.GetData(), FileBlob.Num());
+		else
+			SharedSource = FAnimatedTextureSharedSource::FindOrCreate(FileType, MakeSharedBufferFromArray(MoveTemp(FileBlob)));
+		if (!SharedSource)
+			return false;
+	}
+
+	if (!GIsEditor)
+		FileBlob.Empty();
+	return true;
+}
+
+void UAnimatedTexture2D::LeaveTextureGroup()
+{
+	if (SharedSource && bInTextureGroup)
+		SharedSource->LeaveTextureGroup(this);
+	bInTextureGroup = false;
+}
+
+void UAnimatedTexture2D::PostLoad()
+{
+	// 编辑器需要完整的 FileBlob（重新保存、Cook），在 Super::PostLoad 创建资源之前读入
+	if (GIsEditor && FileBlob.Num() == 0 && !IsTemplate())
+		ReadBulkPayload(FileBlob);
+
+	Super::PostLoad();
+
+	// Headless 进程不会调用 CreateResource（FApp::CanEverRender() == false），在这里释放文件数据
+	if (IsHeadless() && !IsTemplate())
+		ReleaseSourceForHeadless();
+}
+
+void UAnimatedTexture2D::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FAnimatedTextureCustomVersion::GUID);
+
+	// 复制、撤销等非持久化的序列化仍然通过 FileBlob 属性传递文件数据
+	if (!Ar.IsPersistent() || !(Ar.IsLoading() || Ar.IsSaving()))
+	{
+		// 游戏进程里文件数据已经交给共享源（见 AcquireSharedSource），保存时临时放回
+		if (Ar.IsSaving() && FileBlob.Num() == 0 && SharedSource)
+		{
+			FileBlob = TArray<uint8>(SharedSource->GetData(), SharedSource->GetDataSize());
+			Super::Serialize(Ar);
+			FileBlob.Empty();
+			return;
+		}
+
+		Super::Serialize(Ar);
+		return;
+	}
+
+	if (Ar.IsLoading())
+	{
+		// 旧资源的文件数据随 FileBlob 属性读入；新资源只读 bulk data 的描述，数据留在磁盘上
+		Super::Serialize(Ar);
+		const int32 Version = Ar.CustomVer(FAnimatedTextureCustomVersion::GUID);
+		if (Version >= FAnimatedTextureCustomVersion::FileBulkData)
+			FileBulkData.Serialize(Ar, this);
+		if (Version >= FAnimatedTextureCustomVersion::BakedFrames)
+		{
+			uint8 Format = PF_Unknown;
+			Ar << Format;
+			BakedFormat = EPixelFormat(Format);
+			BakedFramesBulkData.Serialize(Ar, this);
+		}
+		SerializeOriginalSource(Ar);
+		return;
+	}
+
+	// 保存：文件数据写进 bulk data，FileBlob 在序列化期间临时移走
+	EnsureSourceMetadata();
+
+	TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> BakedToSave;
+#if WITH_EDITOR
+	if (Ar.IsCooking())
+		BakedToSave = FindOrBakeFrames(Ar.CookingTarget());
+#endif
+
+	TArray<uint8> SavedBlob = MoveTemp(FileBlob);
+	FileBlob.Reset();
+
+	const uint8* Payload = nullptr;
+	int64 PayloadSize = 0;
+	bool bRewritePayload = true;
+	if (SavedBlob.Num() > 0)
+	{
+		Payload = SavedBlob.GetData();
+		PayloadSize = SavedBlob.Num();
+	}
+	else if (SharedSource)
+	{
+		Payload = SharedSource->GetData();
+		PayloadSize = SharedSource->GetDataSize();
+	}
+	else
+	{
+		// 游戏进程里还没有读入过：bulk data 原样保存
+		bRewritePayload = false;
+	}
+
+#if WITH_EDITOR
+	if (Ar.IsCooking()
+		&& Ar.CookingTarget() && Ar.CookingTarget()->IsServerOnly()
+		&& CVarAnimTextureStripServerData.GetValueOnAnyThread() != 0)
+	{
+		// 服务器永远不会解码：只保存元数据
+		PayloadSize = 0;
+		bRewritePayload = true;
+	}
+	else if (BakedToSave)
+	{
+		// 烘焙成压缩切片之后运行时不再需要 GIF/WebP 数据
+		PayloadSize = 0;
+		bRewritePayload = true;
+	}
+#endif // WITH_EDITOR
+
+	if (bRewritePayload)
+	{
+		if (PayloadSize > 0)
+		{
+			FileBulkData.Lock(LOCK_READ_WRITE);
+			FMemory::Memcpy(FileBulkData.Realloc(PayloadSize), Payload, PayloadSize);
+			FileBulkData.Unlock();
+		}
+		else
+		{
+			FileBulkData.RemoveBulkData();
+		}
+	}
+
+	// 烘焙结果只写进 Cook 产物；编辑器里的格式与切片数在保存之后还原
+	const EPixelFormat SavedBakedFormat = BakedFormat;
+	const int32 SavedFrameArraySlices = FrameArraySlices;
+	const float SavedFrameArrayLength = FrameArrayLength;
+	if (BakedToSave)
+	{
+		TArray<uint8> BakedBytes;
+		FMemoryWriter Writer(BakedBytes);
+		Writer << *BakedToSave;
+
+		BakedFramesBulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memcpy(BakedFramesBulkData.Realloc(BakedBytes.Num()), BakedBytes.GetData(), BakedBytes.Num());
+		BakedFramesBulkData.Unlock();
+
+		BakedFormat = BakedToSave->Format;
+		FrameArraySlices = BakedToSave->Layout.NumSlices;
+		FrameArrayLength = BakedToSave->Layout.Duration / 1000.0f;
+	}
+	else if (bRewritePayload)
+	{
+		BakedFramesBulkData.RemoveBulkData();
+		BakedFormat = PF_Unknown;
+	}
+
+	// 不内联：Cook 后数据位于单独的 bulk 文件 / IoStore chunk，加载包时不会读入
+	FileBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+	BakedFramesBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+
+	Super::Serialize(Ar);
+	FileBulkData.Serialize(Ar, this);
+
+	uint8 Format = BakedFormat;
+	Ar << Format;
+	BakedFramesBulkData.Serialize(Ar, this);
+	SerializeOriginalSource(Ar);
+
+	FileBlob = MoveTemp(SavedBlob);
+	if (BakedToSave)
+	{
+		BakedFormat = SavedBakedFormat;
+		FrameArraySlices = SavedFrameArraySlices;
+		FrameArrayLength = SavedFrameArrayLength;
+	}
+}
+
+void UAnimatedTexture2D::SerializeOriginalSource(FArchive& Ar)
+{
+#if WITH_EDITORONLY_DATA
+	if (Ar.IsFilterEditorOnly() || Ar.CustomVer(FAnimatedTextureCustomVersion::GUID) < FAnimatedTextureCustomVersion::OriginalSource)
+		return;
+
+	uint8 Type = uint8(OriginalFileType);
+	Ar << Type;
+	OriginalFileType = EAnimatedTextureType(Type);
+	OriginalFileData.Serialize(Ar, this);
+#endif // WITH_EDITORONLY_DATA
+}
+
+#if WITH_EDITOR
+bool UAnimatedTexture2D::TranscodeToWebp(const FAnimatedTextureWebpSettings& Settings)
+{
+	return ReencodeGifAsWebp(Settings, false);
+}
+
+bool UAnimatedTexture2D::OptimizeAnimation()
+{
+	FAnimatedTextureWebpSettings Lossless;
+	Lossless.Compression = EAnimatedTextureWebpCompression::Lossless;
+	return ReencodeGifAsWebp(Lossless, true);
+}
+
+bool UAnimatedTexture2D::ReencodeGifAsWebp(const FAnimatedTextureWebpSettings& Settings, bool bOptimize)
+{
+	if (FileType != EAnimatedTextureType::Gif || FileBlob.Num() <= 0)
+		return false;
+
+	const uint32 DefaultDelayMs = DefaultFrameDelay * 1000;
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> GifDecoder = CreateAnimatedTextureDecoder(FileType);
+	if (!GifDecoder || !GifDecoder->LoadFromMemory(FileBlob.GetData(), FileBlob.Num()))
+		return false;
+
+	// 转码会把 DefaultFrameDelay 写死到这些帧里，之后修改 DefaultFrameDelay 不再对它们生效
+	if (FWebpEncoder::HasUnspecifiedFrameDelay(*GifDecoder))
+	{
+		UE_LOG(LogAnimTexture, Log, TEXT("%s: some GIF frames have no delay, which WebP cannot keep unspecified, keeping the GIF."), *GetPathName());
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const FAnimatedTextureDecodeCost GifCost = FAnimatedTextureDecodeCost::Measure(*GifDecoder, DefaultDelayMs);
+
+	TArray<uint8> Webp;
+	if (!FWebpEncoder::EncodeAnimation(*GifDecoder, DefaultDelayMs, Settings, bOptimize, Webp))
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("%s: failed to transcode to WebP, keeping the GIF."), *GetPathName());
+		return false;
+	}
+	GifDecoder.Reset();
+
+	FAnimatedTextureDecodeCost WebpCost;
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> WebpDecoder = CreateAnimatedTextureDecoder(EAnimatedTextureType::Webp);
+	if (WebpDecoder && WebpDecoder->LoadFromMemory(Webp.GetData(), Webp.Num()))
+		WebpCost = FAnimatedTextureDecodeCost::Measure(*WebpDecoder, DefaultDelayMs);
+	WebpDecoder.Reset();
+
+	const int32 GifSize = FileBlob.Num();
+	UE_LOG(LogAnimTexture, Log, TEXT("%s: GIF %d frames, %.2f Mpixel/s, %d KB -> WebP %d frames, %.2f Mpixel/s, %d KB (%.2f s)."),
+		*GetPathName(),
+		GifCost.NumFrames, GifCost.PixelsPerSecond / 1e6, GifSize / 1024,
+		WebpCost.NumFrames, WebpCost.PixelsPerSecond / 1e6, Webp.Num() / 1024,
+		FPlatformTime::Seconds() - StartTime);
+
+	if (WebpCost.NumFrames <= 0)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("%s: the encoded WebP does not decode, keeping the GIF."), *GetPathName());
+		return false;
+	}
+
+	if (bOptimize)
+	{
+		// 只看文件内容，结果不随导入机器的负载变化：同样的像素 VP8L 比 LZW 解码得慢，
+		// 要求合成的像素明显减少；熵解码的工作量大致随压缩数据增长，文件也不能变大
+		static constexpr double MaxPixelRatio = 0.75;
+		if (WebpCost.DecodedPixels > GifCost.DecodedPixels * MaxPixelRatio || Webp.Num() > GifSize)
+		{
+			UE_LOG(LogAnimTexture, Log, TEXT("%s: the optimized WebP does not save at least %d%% of the decoded pixels without growing the file, keeping the GIF."),
+				*GetPathName(), int32((1.0 - MaxPixelRatio) * 100.0 + 0.5));
+			return false;
+		}
+	}
+	else if (Webp.Num() >= GifSize)
+	{
+		UE_LOG(LogAnimTexture, Log, TEXT("%s: WebP (%d KB) is not smaller than the GIF (%d KB), keeping the GIF."),
+			*GetPathName(), Webp.Num() / 1024, GifSize / 1024);
+		return false;
+	}
+
+	Modify();
+
+	// ImportFile 会清空原始文件，先取出来
+	TArray<uint8> Original = MoveTemp(FileBlob);
+	ImportFile(EAnimatedTextureType::Webp, MakeSharedBufferFromArray(MoveTemp(Webp)));
+
+	OriginalFileType = EAnimatedTextureType::Gif;
+	OriginalFileData.UpdatePayload(MakeSharedBufferFromArray(MoveTemp(Original)));
+
+	UpdateResource();
+	return true;
+}
+
+TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> UAnimatedTexture2D::FindOrBakeFrames(const ITargetPlatform* TargetPlatform)
+{
+	if (!bCookCompressedFrames || !IsFrameArrayMode() || !TargetPlatform || TargetPlatform->IsServerOnly() || FileBlob.Num() <= 0)
+		return nullptr;
+
+	// 失败的结果也记下来，同一次 Cook 里不再重试
+	const FString PlatformName = TargetPlatform->PlatformName();
+	if (const TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe>* Cached = CookedBakedFrames.Find(PlatformName))
+		return *Cached;
+
+	FAnimatedTextureBakedFrames::FSettings Settings;
+	Settings.DefaultFrameDelay = DefaultFrameDelay * 1000;
+	Settings.MaxSlices = MaxFrameArraySlices;
+	Settings.bSRGB = SRGB;
+	Settings.bHasAlpha = SupportsTransparency;
+
+	TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Baked = FAnimatedTextureBakedFrames::Bake(FileType, FileBlob, Settings, TargetPlatform, GetPathName());
+	CookedBakedFrames.Add(PlatformName, Baked);
+	return Baked;
+}
+
+void UAnimatedTexture2D::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+	Super::BeginCacheForCookedPlatformData(TargetPlatform);
+	FindOrBakeFrames(TargetPlatform);
+}
+
+void UAnimatedTexture2D::ClearAllCachedCookedPlatformData()
+{
+	Super::ClearAllCachedCookedPlatformData();
+	CookedBakedFrames.Empty();
+}
+#endif // WITH_EDITOR
+
+FTextureResource* UAnimatedTexture2D::CreateResource()
+{
+	UnregisterFromTick();
+
+	if (FileType == EAnimatedTextureType::None
+		|| (FileBlob.Num() <= 0 && !SharedSource && !PreparedDecoder && !HasBulkPayload() && !HasBakedFrames()))
+		return nullptr;
+
+	// 只有 StartPlayback 会重新登记，其余分支都不保留解码器
+	UnregisterDecodeState();
+
+	// 旧的预解码 worker 仍可能持有旧解码器，先等它结束
+	if (DecodeAhead)
+	{
+		DecodeAhead->Shutdown();
+		DecodeAhead.Reset();
+	}
+
+	bDecodeStateEvicted = false;
+	EvictedPosition = -1.0f;
+
+	// Headless：没有人能看到像素，不创建解码器、不上传、不 Tick，只保留元数据
+	if (IsHeadless())
+	{
+		Decoder.Reset();
+		StagingPool.Reset();
+		ReleaseSourceForHeadless();
+		return nullptr;
+	}
+
+	// Cook 时烘焙好的压缩切片：不创建解码器，读入之后直接上传
+	if (HasBakedFrames() && IsFrameArrayMode())
+		return CreateBakedFrameArrayResource();
+
+	// 文件数据还在磁盘上：先按保存的元数据创建占位资源，
+	// 数据异步读入、解析并解码出第一帧之后再重建资源（见 OnPayloadPrepared）
+	if (!PreparedDecoder && !SharedSource && FileBlob.Num() <= 0)
+	{
+		Decoder.Reset();
+		StagingPool.Reset();
+		LeaveTextureGroup();
+		RequestPayload();
+		return new FAnimatedTextureResource(this);
+	}
+
+	// create decoder：同样内容的纹理共用文件数据、帧索引与帧缓存，只各自持有播放头；
+	// 异步加载的纹理直接使用加载管线交接过来的解码器
+	if (PreparedDecoder)
+		Decoder = MoveTemp(PreparedDecoder);
+	else
+		Decoder = AcquireSharedSource() ? SharedSource->CreateDecoder() : nullptr;
+	if (!Decoder)
+	{
+		LeaveTextureGroup();
+		return nullptr;
+	}
+	UpdateSourceMetadata(*Decoder);
+
+	// 调色板纹理随资源保存、被材质引用：开启索引模式或导入之后重建资源时就创建，不等到开始播放
+	// （UpdateSourceMetadata 也会在保存时调用，那时不能创建子对象）
+	if (IsPaletteIndexed() && Decoder->GetPalette())
+		UpdatePaletteTexture(Decoder->GetPalette());
+
+	if (IsFrameArrayMode())
+	{
+		LeaveTextureGroup();
+		return CreateFrameArrayResource();
+	}
+
+	// 共用 RHI 纹理：只有 leader 解码、上传和 Tick，其余纹理的资源直接引用同一张 RHI 纹理
+	bool bGroupLeader = true;
+	if (bShareTexture)
+		bInTextureGroup = SharedSource->JoinTextureGroup(this, bGroupLeader);
+	else
+		LeaveTextureGroup();
+
+	if (!bGroupLeader)
+	{
+		Decoder.Reset();
+		StagingPool.Reset();
+		return new FAnimatedTextureResource(this, SharedSource);
+	}
+
+	// create RHI resource object
+	FTextureResource* NewResource = new FAnimatedTextureResource(this, bInTextureGroup ? SharedSource : nullptr);
+	StartPlayback();
+	return NewResource;
+}
+
+void UAnimatedTexture2D::StartPlayback()
+{
+	check(Decoder);
+
+	// 在包装成反向/往返解码器之前切换，切换会重置解码器
+	EnableIndexedOutput();
+	ResolveStreamingFormat();
+
+	// 加载管线已经在后台线程上解码出第 0 帧：第一次 Tick 直接使用它，不再解码一遍
+	bFirstFrameDecoded = PlayDirection == EAnimatedTexturePlayDirection::Forward && Decoder->GetCurrentFrame() == 0;
+
+	// 反向/往返播放：包装成按播放顺序排列帧的解码器，之后的播放逻辑与正向相同
+	if (PlayDirection != EAnimatedTexturePlayDirection::Forward)
+		Decoder = MakeShared<FAnimatedTextureSequenceDecoder, ESPMode::ThreadSafe>(Decoder.ToSharedRef(), PlayDirection);
+
+	// 在 worker 接管解码器之前设置
+	Decoder->SetSnapshotInterval(SeekSnapshotInterval);
+
+	if (bAsyncDecode)
+	{
+		DecodeAhead = MakeShared<FAnimatedTextureDecodeAhead, ESPMode::ThreadSafe>(Decoder, DecodeAheadFrames, Packer);
+		DecodeAhead->SetPlaybackParams(DefaultFrameDelay * 1000, bLooping);
+		if (bFirstFrameDecoded)
+			DecodeAhead->AdoptCurrentFrame();
+		bFirstFrameDecoded = false;
+		DecodeAhead->Kick();
+	}
+
+	// staging buffer 按整张画布分配，播放期间复用
+	StagingPool = MakeShared<FAnimatedTextureStagingPool, ESPMode::ThreadSafe>(Decoder->GetWidth() * Decoder->GetHeight() * GPixelFormats[StreamingFormat].BlockBytes);
+
+	// 第一帧立即到期，并且完整上传一次（新建的 RHI 纹理内容未初始化）
+	FrameTime = 0;
+	FrameDelay = 0;
+	PendingDirtyRect = FIntRect();
+	bForceFullUpload = true;
+	CurrentFrame = INDEX_NONE;
+	bFinished = false;
+	bDecodeStateEvicted = false;
+	LastUsedTime = FApp::GetCurrentTime();
+	RegisterDecodeState();
+	UpdateTickRegistration();
+}
+
+void UAnimatedTexture2D::EnableIndexedOutput()
+{
+	bIndexedUpload = false;
+	if (!IsPaletteIndexed())
+		return;
+
+	// 共享帧缓存里是合成好的 BGRA：换成直接读共享文件数据的 GIF 解码器
+	if (!Decoder->SetIndexedOutput(true) && SharedSource)
+	{
+		TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> GifDecoder = CreateAnimatedTextureDecoder(FileType);
+		if (GifDecoder && GifDecoder->LoadFromMemory(SharedSource->GetData(), SharedSource->GetDataSize())
+			&& GifDecoder->SetIndexedOutput(true))
+		{
+			Decoder = GifDecoder;
+		}
+	}
+
+	bIndexedUpload = Decoder->IsIndexedOutput();
+	if (!bIndexedUpload)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("%s: palette indexed upload is not available, uploading BGRA."), *GetPathName());
+		return;
+	}
+
+	UpdatePaletteTexture(Decoder->GetPalette());
+}
+
+void UAnimatedTexture2D::UpdatePaletteTexture(const FColor* Colors)
+{
+	// 材质引用调色板纹理，它需要和所属纹理一起保存、可以被其他包引用
+	if (!PaletteTexture)
+		PaletteTexture = NewObject<UAnimatedTexturePalette>(this, TEXT("Palette"), GetMaskedFlags(RF_PropagateToSubObjects) | RF_Public);
+	PaletteTexture->SetColors(Colors);
+}
+
+void UAnimatedTexture2D::ResolveStreamingFormat()
+{
+	Packer.Reset();
+	StreamingFormat = bIndexedUpload ? PF_R8 : PF_B8G8R8A8;
+	if (bIndexedUpload || bInTextureGroup)
+		return;	// 共用的 RHI 纹理固定为 BGRA8
+
+	EAnimatedTextureUploadFormat Format = UploadFormat;
+	if (Format == EAnimatedTextureUploadFormat::Default)
+	{
+		Format = CVarAnimTextureCompactUpload.GetValueOnAnyThread() != 0
+			? EAnimatedTextureUploadFormat::Compact : EAnimatedTextureUploadFormat::BGRA8;
+	}
+
+	// 没有 4444 格式：WebP 的半透明 alpha 只能保留 BGRA8，GIF 的透明度本来就只有 1 位
+	EPixelFormat PackedFormat = PF_Unknown;
+	if (Format == EAnimatedTextureUploadFormat::Compact)
+	{
+		if (!Decoder->SupportsTransparency())
+			PackedFormat = PF_R5G6B5_UNORM;
+		else if (FileType == EAnimatedTextureType::Gif)
+			PackedFormat = PF_B5G5R5A1_UNORM;
+	}
+	else if (Format == EAnimatedTextureUploadFormat::RGBA5551)
+	{
+		PackedFormat = PF_B5G5R5A1_UNORM;
+	}
+
+	if (PackedFormat == PF_Unknown)
+		return;
+
+	// 16 位格式没有 sRGB 版本，采样器不会解码 sRGB 曲线：量化 sRGB 编码值会被当成线性颜色读出（偏亮），
+	// 先转到线性再量化到 5 位则暗部色带严重，两种都与 BGRA8 的 sRGB 纹理不一致，sRGB 纹理保留 BGRA8
+	if (SRGB)
+	{
+		UE_LOG(LogAnimTexture, Log, TEXT("%s: %s has no sRGB variant, uploading BGRA (turn off sRGB to use 16-bit upload)."), *GetPathName(), GPixelFormats[PackedFormat].Name);
+		return;
+	}
+
+	if (!GPixelFormats[PackedFormat].Supported)
+	{
+		UE_LOG(LogAnimTexture, Log, TEXT("%s: %s is not supported by this RHI, uploading BGRA."), *GetPathName(), GPixelFormats[PackedFormat].Name);
+		return;
+	}
+
+	StreamingFormat = PackedFormat;
+	Packer = MakeShared<FAnimatedTexturePixelPacker, ESPMode::ThreadSafe>(PackedFormat, bDitherUpload);
+}
+
+SIZE_T UAnimatedTexture2D::GetDecodeStateSize() const
+{
+	SIZE_T Size = 0;
+	if (Decoder)
+		Size += Decoder->GetAllocatedSize();
+	if (DecodeAhead)
+		Size += DecodeAhead->GetAllocatedSize();
+	if (StagingPool)
+		Size += StagingPool->GetAllocatedSize();
+	return Size;
+}
+
+double UAnimatedTexture2D::GetLastUsedTime() const
+{
+	return FMath::Max<double>(GetLastRenderTimeForStreaming(), LastUsedTime);
 }
 
-float UAnimatedTexture2D::GetSurfaceHeight() const
+bool UAnimatedTexture2D::CanEvictDecodeState() const
 {
-	if (Decoder) return Decoder->GetHeight();
-	return 1.0f;
+	// 分组 leader 的 RHI 纹理由其他纹理显示，自身的渲染时间不能代表分组是否可见
+	return Decoder && !bInTextureGroup && !IsFrameArrayMode();
 }
 
-FTextureResource* UAnimatedTexture2D::CreateResource()
+void UAnimatedTexture2D::RegisterDecodeState()
 {
-	if (FileType == EAnimatedTextureType::None
-		|| FileBlob.Num() <= 0)
-		return nullptr;
+	if (UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get())
+		Subsystem->RegisterDecodeState(this);
+}
+
+void UAnimatedTexture2D::UnregisterDecodeState()
+{
+	if (UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get())
+		Subsystem->UnregisterDecodeState(this);
+}
 
-	// create decoder
-	switch (FileType)
+void UAnimatedTexture2D::EvictDecodeState(bool bReleaseSource)
+{
+	// 记下播放位置与时钟，恢复时按时钟补上淘汰期间流逝的时间
+	if (!bDecodeStateEvicted)
 	{
-	case EAnimatedTextureType::Gif:
-		Decoder = MakeShared<FGIFDecoder, ESPMode::ThreadSafe>();
-		break;
-	case EAnimatedTextureType::Webp:
-		Decoder = MakeShared<FWebpDecoder, ESPMode::ThreadSafe>();
-		break;
+		EvictedPosition = Decoder && CurrentFrame != INDEX_NONE ? GetPlaybackPosition() : -1.0f;
+		UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get();
+		EvictedClock = Subsystem ? Subsystem->GetClock() : 0;
 	}
 
-	check(Decoder);
-	if (Decoder->LoadFromMemory(FileBlob.GetData(), FileBlob.Num()))
+	UnregisterFromTick();
+	UnregisterDecodeState();
+
+	if (DecodeAhead)
+	{
+		DecodeAhead->Shutdown();
+		DecodeAhead.Reset();
+	}
+
+	// 渲染命令持有 staging pool 自己的引用，这里释放是安全的
+	Decoder.Reset();
+	bFirstFrameDecoded = false;
+	StagingPool.Reset();
+	bDecodeStateEvicted = true;
+
+	// 游戏进程里文件数据可以从 bulk data 重新读入，共享源不再被其他纹理使用时随之释放
+	if (bReleaseSource && !GIsEditor && HasBulkPayload())
+		SharedSource.Reset();
+}
+
+void UAnimatedTexture2D::RestoreDecodeState()
+{
+	if (!bDecodeStateEvicted || !GetResource())
+		return;
+
+	if (PreparedDecoder)
 	{
-		AnimationLength = Decoder->GetDuration(DefaultFrameDelay * 1000) / 1000.0f;
-		SupportsTransparency = Decoder->SupportsTransparency();
+		Decoder = MoveTemp(PreparedDecoder);
+	}
+	else if (SharedSource)
+	{
+		Decoder = SharedSource->CreateDecoder();
 	}
 	else
 	{
+		// 共享源已随淘汰释放：重新读入之后回到这里
+		RequestPayload();
+		return;
+	}
+	if (!Decoder)
+		return;
+
+	// StartPlayback 会回到第 0 帧，恢复到按时钟应当显示的位置
+	float Position = EvictedPosition;
+	EvictedPosition = -1.0f;
+	UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get();
+	if (Position >= 0.0f && Subsystem && bPlaying && !bFinished)
+		Position += float((Subsystem->GetClock() - EvictedClock) * PlayRate);
+
+	const EPixelFormat ResourceFormat = StreamingFormat;
+	StartPlayback();
+
+	// 淘汰期间 AnimatedTexture.CompactUpload 改变了：保留的 RHI 纹理格式不对，需要重建
+	if (StreamingFormat != ResourceFormat)
+		UpdateResource();
+
+	if (Position >= 0.0f)
+		SetPlaybackPosition(Position);
+}
+
+void UAnimatedTexture2D::ApplyPlayDirection()
+{
+	if (!Decoder || IsFrameArrayMode())
+		return;	// 下一次创建资源时生效
+
+	const int32 SourceFrame = GetCurrentFrame();
+	EvictDecodeState(/*bReleaseSource=*/ false);
+	EvictedPosition = -1.0f;	// 换方向后时间轴不同，按源帧定位
+	RestoreDecodeState();
+	if (SourceFrame != INDEX_NONE)
+		SeekToFrame(SourceFrame);
+}
+
+void UAnimatedTexture2D::TouchDecodeState()
+{
+	LastUsedTime = FApp::GetCurrentTime();
+	if (bDecodeStateEvicted)
+		RestoreDecodeState();
+}
+
+FTextureResource* UAnimatedTexture2D::CreateFrameArrayResource()
+{
+	// 切片布局只依赖帧索引，可以立即确定，RHI 纹理数组按此创建
+	const uint32 DefaultDelayMs = DefaultFrameDelay * 1000;
+	const FAnimatedTextureFrameArrayLayout Layout = FAnimatedTextureFrameArrayLayout::Plan(*Decoder, DefaultDelayMs, MaxFrameArraySlices);
+	FrameArraySlices = Layout.NumSlices;
+	FrameArrayLength = Layout.Duration / 1000.0f;
+	StagingPool.Reset();
+	UpdateFrameArrayTiming();
+
+	FTextureResource* NewResource = new FAnimatedTextureResource(this);
+	if (Layout.NumSlices <= 0)
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("UAnimatedTexture2D: %s (%dx%d) does not fit one slice into AnimatedTexture.FrameArrayMaxMB, no frame array is built."),
+			*GetPathName(), Layout.Width, Layout.Height);
 		Decoder.Reset();
+		return NewResource;
+	}
+
+	// 解码器交给 worker 独占，合成结束后随 worker 一起释放；纹理本身不再 Tick
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> BuildDecoder = MoveTemp(Decoder);
+	TWeakObjectPtr<UAnimatedTexture2D> WeakThis(this);
+	const uint32 BuildSerial = ++FrameArrayBuildSerial;
+
+	Async(EAsyncExecution::ThreadPool, [BuildDecoder, Layout, DefaultDelayMs, WeakThis, BuildSerial]()
+		{
+			TSharedPtr<FAnimatedTextureFrameArray, ESPMode::ThreadSafe> FrameArray = MakeShared<FAnimatedTextureFrameArray, ESPMode::ThreadSafe>();
+			FrameArray->Layout = Layout;
+			FrameArray->Build(*BuildDecoder, DefaultDelayMs);
+
+			AsyncTask(ENamedThreads::GameThread, [FrameArray, WeakThis, BuildSerial]()
+				{
+					UAnimatedTexture2D* Texture = WeakThis.Get();
+					if (Texture && Texture->FrameArrayBuildSerial == BuildSerial && Texture->IsFrameArrayMode())
+						EnqueueAnimatedTextureFrameArrayUpload(Texture->GetResource(), FrameArray);
+				});
+		});
+
+	return NewResource;
+}
+
+FTextureResource* UAnimatedTexture2D::CreateBakedFrameArrayResource()
+{
+	Decoder.Reset();
+	StagingPool.Reset();
+	LeaveTextureGroup();
+
+	if (!GPixelFormats[BakedFormat].Supported)
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("UAnimatedTexture2D: %s was cooked with %s, which this RHI does not support."),
+			*GetPathName(), GPixelFormats[BakedFormat].Name);
 		return nullptr;
 	}
 
-	// create RHI resource object
 	FTextureResource* NewResource = new FAnimatedTextureResource(this);
+	++FrameArrayBuildSerial;
+	UpdateFrameArrayTiming();
+	RequestPayload();
 	return NewResource;
 }
 
-void UAnimatedTexture2D::Tick(float DeltaTime)
+void UAnimatedTexture2D::UpdateFrameArrayTiming()
 {
-	if (!bPlaying)
-		return;
-	if (!Decoder)
-		return;
+	// 材质引用它，需要和所属纹理一起保存、可以被其他包引用
+	if (!FrameArrayTiming)
+		FrameArrayTiming = NewObject<UAnimatedTextureFrameArrayTiming>(this, TEXT("FrameArrayTiming"), GetMaskedFlags(RF_PropagateToSubObjects) | RF_Public);
+	FrameArrayTiming->SetTiming(PlayRate, FrameArraySlices, FrameArrayLength);
+}
 
-	FrameTime += DeltaTime * PlayRate;
-	if (FrameTime < FrameDelay)
-		return;
+void UAnimatedTexture2D::UploadBakedFrames(FSharedBuffer Payload)
+{
+	TWeakObjectPtr<UAnimatedTexture2D> WeakThis(this);
+	const uint32 BuildSerial = FrameArrayBuildSerial;
 
-	FrameTime = 0;
-	FrameDelay = RenderFrameToTexture();
+	Async(EAsyncExecution::ThreadPool, [Payload = MoveTemp(Payload), WeakThis, BuildSerial]()
+		{
+			TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Baked = MakeShared<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe>();
+			FMemoryReaderView Reader(MakeArrayView(static_cast<const uint8*>(Payload.GetData()), int32(Payload.GetSize())));
+			Reader << *Baked;
+			if (Reader.IsError() || !Baked->IsValid())
+			{
+				UE_LOG(LogAnimTexture, Error, TEXT("UAnimatedTexture2D: invalid baked frame data."));
+				return;
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [Baked, WeakThis, BuildSerial]()
+				{
+					UAnimatedTexture2D* Texture = WeakThis.Get();
+					if (Texture && Texture->FrameArrayBuildSerial == BuildSerial)
+						EnqueueAnimatedTextureBakedFramesUpload(Texture->GetResource(), Baked);
+				});
+		});
 }
 
+void UAnimatedTexture2D::BeginDestroy()
+{
+	UnregisterFromTick();
+	UnregisterDecodeState();
+	LeaveTextureGroup();
+	CancelPayloadRequest();
+
+	if (DecodeAhead)
+	{
+		DecodeAhead->Shutdown();
+		DecodeAhead.Reset();
+	}
+
+	Super::BeginDestroy();
+}
 
 #if WITH_EDITOR
 void UAnimatedTexture2D::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
@@ -87,6 +1046,7 @@ void UAnimatedTexture2D::PostEditChangeProperty(FPropertyChangedEvent& PropertyC
 
 	bool RequiresNotifyMaterials = false;
 	bool ResetAnimState = false;
+	bool RequiresUpdateResource = false;
 
 	const FProperty* PropertyThatChanged = PropertyChangedEvent.Property;
 	if (PropertyThatChanged)
@@ -94,20 +1054,62 @@ void UAnimatedTexture2D::PostEditChangeProperty(FPropertyChangedEvent& PropertyC
 		const FName PropertyName = PropertyThatChanged->GetFName();
 
 		static const FName SupportsTransparencyName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, SupportsTransparency);
+		static const FName AsyncDecodeName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, bAsyncDecode);
+		static const FName DecodeAheadFramesName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, DecodeAheadFrames);
+		static const FName ShareTextureName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, bShareTexture);
+		static const FName PlaybackModeName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, PlaybackMode);
+		static const FName MaxFrameArraySlicesName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, MaxFrameArraySlices);
+		static const FName PlayDirectionName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, PlayDirection);
+		static const FName PaletteIndexedName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, bPaletteIndexed);
+		static const FName UploadFormatName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, UploadFormat);
+		static const FName PlayRateName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, PlayRate);
+		static const FName DitherUploadName = GET_MEMBER_NAME_CHECKED(UAnimatedTexture2D, bDitherUpload);
 
 		if (PropertyName == SupportsTransparencyName)
 		{
 			RequiresNotifyMaterials = true;
 			ResetAnimState = true;
 		}
+		else if (PropertyName == AsyncDecodeName
+			|| PropertyName == DecodeAheadFramesName
+			|| PropertyName == ShareTextureName
+			|| PropertyName == UploadFormatName
+			|| PropertyName == DitherUploadName
+			|| PropertyName == MaxFrameArraySlicesName)
+		{
+			RequiresUpdateResource = true;
+		}
+		else if (PropertyName == PlaybackModeName
+			|| PropertyName == PaletteIndexedName)
+		{
+			// 纹理类型在 2D 与 2DArray 之间切换（或改变了像素的含义），材质需要重新编译
+			RequiresUpdateResource = true;
+			RequiresNotifyMaterials = true;
+		}
+		else if (PropertyName == PlayDirectionName)
+		{
+			ApplyPlayDirection();
+		}
+		else if (PropertyName == PlayRateName && IsFrameArrayMode())
+		{
+			UpdateFrameArrayTiming();
+		}
 	}// end of if(prop is valid)
 
-	if (ResetAnimState)
+	if (RequiresUpdateResource)
 	{
-		FrameDelay = RenderFrameToTexture();
-		FrameTime = 0;
+		// 重新创建解码器 + 预解码队列
+		UpdateResource();
 	}
 
+	if (ResetAnimState)
+		RenderFrameToTexture();
+
+	// PlayRate、bLooping、TickPolicy 等播放参数可能被修改，重新注册并计算下一帧的到期时间
+	if (bLooping)
+		bFinished = false;
+	UpdateTickRegistration();
+
 	if (RequiresNotifyMaterials)
 		NotifyMaterials();
 }
@@ -115,8 +1117,77 @@ void UAnimatedTexture2D::PostEditChangeProperty(FPropertyChangedEvent& PropertyC
 
 void UAnimatedTexture2D::ImportFile(EAnimatedTextureType InFileType, const uint8* InBuffer, uint32 InBufferSize)
 {
+	ImportFile(InFileType, FSharedBuffer::MakeView(InBuffer, InBufferSize));
+}
+
+void UAnimatedTexture2D::ImportFile(EAnimatedTextureType InFileType, const FSharedBuffer& InBuffer)
+{
+	const uint8* InData = static_cast<const uint8*>(InBuffer.GetData());
+	const int32 InSize = int32(InBuffer.GetSize());
+
+	LeaveTextureGroup();
+	CancelPayloadRequest();
+	SharedSource.Reset();
+	PreparedDecoder.Reset();
+	FileBulkData.RemoveBulkData();
+	BakedFramesBulkData.RemoveBulkData();
+	BakedFormat = PF_Unknown;
+#if WITH_EDITORONLY_DATA
+	CookedBakedFrames.Empty();
+	OriginalFileType = EAnimatedTextureType::None;
+	OriginalFileData.Reset();
+#endif
+
 	FileType = InFileType;
-	FileBlob = TArray<uint8>(InBuffer, InBufferSize);
+
+	// 新文件：元数据在下次创建解码器时刷新
+	SourceWidth = SourceHeight = SourceFrameCount = 0;
+	AnimationLength = 0.0f;
+	bSourcePaletteIndexable = false;
+
+	if (IsHeadless())
+	{
+		FileBlob = TArray<uint8>(InData, InSize);
+		ReleaseSourceForHeadless();
+		return;
+	}
+
+	// 游戏进程：内容已登记过时直接复用，否则共享源接管 InBuffer
+	if (!GIsEditor)
+		SharedSource = FAnimatedTextureSharedSource::FindOrCreate(InFileType, InBuffer);
+
+	if (SharedSource)
+		FileBlob.Empty();
+	else
+		FileBlob = TArray<uint8>(InData, InSize);
+}
+
+void UAnimatedTexture2D::ImportPrepared(FAnimatedTexturePreparedLoad& Prepared)
+{
+	check(Prepared.Source && Prepared.Decoder);
+
+	LeaveTextureGroup();
+	CancelPayloadRequest();
+	FileBulkData.RemoveBulkData();
+	BakedFramesBulkData.RemoveBulkData();
+	BakedFormat = PF_Unknown;
+
+	FileType = Prepared.Type;
+	SharedSource = MoveTemp(Prepared.Source);
+	FileBlob = MoveTemp(Prepared.FileBlob);
+	UpdateSourceMetadata(*Prepared.Decoder);
+
+	if (IsHeadless())
+	{
+		// 只保留元数据，与 ImportFile 相同
+		SharedSource.Reset();
+		FileBlob.Empty();
+		PreparedDecoder.Reset();
+		Prepared.Decoder.Reset();
+		return;
+	}
+
+	PreparedDecoder = MoveTemp(Prepared.Decoder);
 }
 
 EAnimatedTextureType UAnimatedTexture2D::DetectTypeFromExtension(const FString& FilenameOrExt)
@@ -176,45 +1247,279 @@ EAnimatedTextureType UAnimatedTexture2D::DetectTypeFromMagic(const uint8* Buffer
 
 float UAnimatedTexture2D::RenderFrameToTexture()
 {
+	if (!Decoder)
+		return 0.0f;
+
+	// 只前进一帧，不按时间追赶
+	FrameTime = FrameDelay;
+	UpdateFrameNow();
+	return FrameDelay;
+}
+
+void UAnimatedTexture2D::UpdateFrameNow()
+{
+	FAnimatedTextureFrameUpdateList* Updates = AllocAnimatedTextureFrameUpdates();
+	DecodeFrame(Updates->AddDefaulted_GetRef());
+	FinishFrame();
+	EnqueueAnimatedTextureFrameUpdates(Updates);
+}
+
+static int32 GetNextFrameIndex(int32 CurrentFrame, int32 NumFrames, bool bLooping)
+{
+	if (CurrentFrame + 1 < NumFrames)
+		return CurrentFrame + 1;
+	return bLooping ? 0 : NumFrames - 1;
+}
+
+float UAnimatedTexture2D::CountElapsedFrames(uint32 DefaultDelayMs, uint32& OutNumSkip) const
+{
+	OutNumSkip = 0;
+	const int32 NumFrames = Decoder->GetNumFrames();
+	if (NumFrames <= 0)
+		return 0.0f;
+
+	// 当前帧结束之后又过去了多久（毫秒）；循环播放时整圈的时间不改变帧位置，直接去掉
+	double Remain = FMath::Max(0.0, double(FrameTime) - FrameDelay) * 1000.0;
+	const uint32 Duration = Decoder->GetDuration(DefaultDelayMs);
+	if (bLooping && Duration > 0 && Remain >= Duration)
+		Remain = FMath::Fmod(Remain, double(Duration));
+
+	// 一次追赶的帧数有上限，剩下的时间保留在 FrameTime 中，之后的 Tick 继续追赶
+	const int32 MaxCatchUp = CVarAnimTextureMaxCatchUpFrames.GetValueOnAnyThread();
+	const uint32 MaxSkip = MaxCatchUp > 0 ? FMath::Min(MaxCatchUp, NumFrames) : NumFrames;
+
+	int32 Index = GetNextFrameIndex(CurrentFrame, NumFrames, bLooping);
+	while (OutNumSkip < MaxSkip)
+	{
+		const uint32 Delay = Decoder->GetFrameDelay(Index, DefaultDelayMs);
+		if (Remain < Delay)
+			break;
+
+		// 不循环时停在最后一帧
+		if (!bLooping && Index == NumFrames - 1)
+		{
+			Remain = 0;
+			break;
+		}
+
+		Remain -= Delay;
+		OutNumSkip++;
+		Index = GetNextFrameIndex(Index, NumFrames, bLooping);
+	}
+
+	return Remain / 1000.0;
+}
+
+void UAnimatedTexture2D::DecodeFrame(FAnimatedTextureFrameUpdate& OutUpdate)
+{
+	// 注意：可能在工作线程上执行，只能访问本纹理自己的状态
+	PendingFrameDelay = 0;
+	bPendingFromDecodeAhead = false;
+	bPendingFrame = false;
+
+	// 到期的可能不止一帧（高 PlayRate、卡顿、从不可见恢复）：按流逝的时间找到应该显示的帧，只上传这一帧；
+	// 中间的帧只在合成需要时解码，之后有关键帧完整覆盖画布时直接跳过
+	const uint32 DefaultDelayMs = DefaultFrameDelay * 1000;
+	uint32 NumSkip = 0;
+	PendingFrameTime = CountElapsedFrames(DefaultDelayMs, NumSkip);
+
+	// 被跳过的最后一帧：跳过之后没有拿到新帧时，播放位置停在这里
+	const bool bSkipped = NumSkip > 0;
+	int32 SkippedFrame = CurrentFrame;
+	for (uint32 i = 0; i < NumSkip; i++)
+		SkippedFrame = GetNextFrameIndex(SkippedFrame, Decoder->GetNumFrames(), bLooping);
+
+	// 解码器停在预解码的第 0 帧上：需要显示第 0 帧时直接使用，否则它算作跳过的第一帧
+	const bool bUseDecodedFrame = bFirstFrameDecoded && NumSkip == 0;
+	if (bFirstFrameDecoded && NumSkip > 0)
+		NumSkip--;
+	bFirstFrameDecoded = false;
+
+	if (NumSkip > 0)
+	{
+		if (DecodeAhead)
+			DecodeAhead->Skip(NumSkip, PendingDirtyRect);
+		else
+			Decoder->SkipFrames(NumSkip, DefaultDelayMs, bLooping, PendingDirtyRect);
+	}
+
 	// 解码新的一帧到内存缓冲区
-	int nFrameDelay = Decoder->NextFrame(DefaultFrameDelay * 1000, bLooping);
+	// 异步模式下帧已由 worker 预先解码到环形队列中，这里只取队首帧
+	const uint8* SrcCanvas = nullptr;
+	if (DecodeAhead)
+	{
+		const FAnimatedTextureDecodeAhead::FFrame* ReadyFrame = DecodeAhead->PeekFrame();
+		if (!ReadyFrame)
+		{
+			// 解码跟不上：本帧不更新，下一次 Tick 立即重试。
+			// 已经跳过的帧不能再跳一次：把播放位置提交到被跳过的最后一帧（已经到期），
+			// 消耗掉的时间随之结算，FinishFrame 会 Kick worker 解码后面的帧
+			if (bSkipped)
+			{
+				const uint32 SkippedDelay = Decoder->GetFrameDelay(SkippedFrame, DefaultDelayMs);
+				PendingFrameIndex = SkippedFrame;
+				PendingFrameDelay = SkippedDelay;
+				PendingFrameTime += SkippedDelay / 1000.0f;
+				bPendingFrame = true;
+			}
+			return;
+		}
+
+		PendingFrameDelay = ReadyFrame->FrameDelay;
+		PendingFrameIndex = ReadyFrame->FrameIndex;
+		PendingDirtyRect = FAnimatedTextureDecoder::UnionRect(PendingDirtyRect, ReadyFrame->DirtyRect);
+		bPendingFromDecodeAhead = true;
+		SrcCanvas = ReadyFrame->Pixels.GetData();
+	}
+	else
+	{
+		PendingFrameDelay = bUseDecodedFrame
+			? Decoder->GetFrameDelay(Decoder->GetCurrentFrame(), DefaultDelayMs)
+			: Decoder->NextFrame(DefaultDelayMs, bLooping);
+		PendingFrameIndex = Decoder->GetCurrentFrame();
+		PendingDirtyRect = FAnimatedTextureDecoder::UnionRect(PendingDirtyRect, Decoder->GetDirtyRect());
+		SrcCanvas = Decoder->GetCanvasData();
+	}
+	bPendingFrame = true;
 
-	// 获取帧缓冲数据
-	const FColor* SrcFrameBuffer = Decoder->GetFrameBuffer();
+	// 获取帧缓冲数据；没有上传的脏区域会累积到下一次上传
 	FTextureResource* TextureResource = GetResource();
-	if (!SrcFrameBuffer || !TextureResource)
-		return nFrameDelay / 1000.0f;
+	if (!SrcCanvas || !TextureResource)
+		return;
+
+	const int32 FrameWidth = Decoder->GetWidth();
+	const int32 FrameHeight = Decoder->GetHeight();
+	if (bForceFullUpload)
+		PendingDirtyRect = FIntRect(0, 0, FrameWidth, FrameHeight);
 
-	// 拷贝帧缓冲数据的副本，确保渲染线程读取时游戏线程不会修改该数据
+	FIntRect Rect = PendingDirtyRect;
+	Rect.Clip(FIntRect(0, 0, FrameWidth, FrameHeight));
+	if (Rect.Width() <= 0 || Rect.Height() <= 0)
+		return;	// 画面没有变化，跳过上传
+
+	// 渲染线程还没有归还任何 staging buffer：本次不上传，脏区域留到下一帧
+	const int32 StagingIndex = StagingPool->Acquire();
+	if (StagingIndex == INDEX_NONE)
+		return;
+
+	// 只把脏矩形区域拷贝到 staging buffer，确保渲染线程读取时游戏线程不会修改该数据
 	// （GIF 解码器的 FrameBuffer 在下一帧解码时会被覆盖，
-	//  WebP 解码器的 FrameBuffer 由 libwebp 内部管理，同样可能被覆盖）
-	const uint32 FrameWidth = Decoder->GetWidth();
-	const uint32 FrameHeight = Decoder->GetHeight();
-	const uint32 BufferSize = FrameWidth * FrameHeight * sizeof(FColor);
+	//  WebP 解码器的 FrameBuffer 由 libwebp 内部管理，同样可能被覆盖，
+	//  预解码队列的槽位在 PopFrame 之后会被 worker 复用）
+	const int32 BytesPerPixel = GPixelFormats[StreamingFormat].BlockBytes;
+	const int32 RowBytes = Rect.Width() * BytesPerPixel;
+	OutUpdate.Resource = TextureResource;
+	OutUpdate.Rect = Rect;
+	OutUpdate.BytesPerPixel = BytesPerPixel;
+	OutUpdate.StagingPool = StagingPool;
+	OutUpdate.StagingIndex = StagingIndex;
 
-	struct FRenderCommandData
+	uint8* Dest = StagingPool->GetBuffer(StagingIndex);
+	if (Packer && !bPendingFromDecodeAhead)
 	{
-		FTextureResource* RHIResource;
-		TArray<uint8> FrameBufferCopy;
-	};
+		// 同步解码：只转换脏矩形，转换与解码在同一个线程上
+		Packer->PackRect(Dest, reinterpret_cast<const FColor*>(SrcCanvas), FrameWidth, Rect);
+	}
+	else
+	{
+		for (int32 y = Rect.Min.Y; y < Rect.Max.Y; y++)
+		{
+			FMemory::Memcpy(Dest, SrcCanvas + (y * FrameWidth + Rect.Min.X) * BytesPerPixel, RowBytes);
+			Dest += RowBytes;
+		}
+	}
 
-	typedef TSharedPtr<FRenderCommandData, ESPMode::ThreadSafe> FCommandDataPtr;
-	FCommandDataPtr CommandData = MakeShared<FRenderCommandData, ESPMode::ThreadSafe>();
-	CommandData->RHIResource = TextureResource;
-	CommandData->FrameBufferCopy.SetNumUninitialized(BufferSize);
-	FMemory::Memcpy(CommandData->FrameBufferCopy.GetData(), SrcFrameBuffer, BufferSize);
+	PendingDirtyRect = FIntRect();
+	bForceFullUpload = false;
+}
 
-	//-- 提交渲染命令
-	ENQUEUE_RENDER_COMMAND(AnimTexture2D_RenderFrame)(
-		[CommandData](FRHICommandListImmediate& RHICmdList)
-		{
-			if (!CommandData->RHIResource || !CommandData->RHIResource->TextureRHI)
-				return;
+void UAnimatedTexture2D::FinishFrame()
+{
+	if (DecodeAhead)
+	{
+		// 槽位已拷贝完毕，交还给 worker；队列为空时 Kick 让 worker 继续解码
+		if (bPendingFromDecodeAhead)
+			DecodeAhead->PopFrame();
+		else
+			DecodeAhead->Kick();
+		DecodeAhead->SetPlaybackParams(DefaultFrameDelay * 1000, bLooping);
+		bPendingFromDecodeAhead = false;
+	}
 
-			AnimatedTextureCompat::AT_UpdateFrameToTexture(RHICmdList, CommandData->RHIResource->TextureRHI, CommandData->FrameBufferCopy.GetData());
-		});
+	UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get();
+	LastSyncClock = Subsystem ? Subsystem->GetClock() : 0;
+
+	// 没有拿到新帧（预解码跟不上）时保持到期状态，下一次 Tick 立即重试
+	if (!bPendingFrame)
+		return;
+
+	// 保留追赶之后的余量，播放时间与时钟保持同步
+	CurrentFrame = PendingFrameIndex;
+	FrameTime = PendingFrameTime;
+	FrameDelay = PendingFrameDelay / 1000.0f;
+	bFinished = !bLooping && Decoder && CurrentFrame == int32(Decoder->GetNumFrames()) - 1;
+	bPendingFrame = false;
+}
+
+void UAnimatedTexture2D::SyncFrameTime()
+{
+	UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get();
+	if (!Subsystem)
+		return;
+
+	const double Now = Subsystem->GetClock();
+	if (bPlaying)
+		FrameTime += (Now - LastSyncClock) * PlayRate;
+	LastSyncClock = Now;
+}
+
+double UAnimatedTexture2D::GetNextFrameClock() const
+{
+	if (!ShouldTick())
+		return TNumericLimits<double>::Max();
+
+	return LastSyncClock + FMath::Max(0.0f, FrameDelay - FrameTime) / PlayRate;
+}
+
+bool UAnimatedTexture2D::ShouldTick() const
+{
+	return Decoder && bPlaying && !bFinished && PlayRate > 0.0f
+		&& TickPolicy != EAnimatedTextureTickPolicy::Manual;
+}
+
+void UAnimatedTexture2D::UpdateTickRegistration()
+{
+	if (!ShouldTick())
+	{
+		// 停止、播完、暂停（PlayRate <= 0）或 Manual：完全退出管理器，不占用调度开销
+		UnregisterFromTick();
+		return;
+	}
+
+	if (UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get())
+		Subsystem->Register(this);
+}
+
+bool UAnimatedTexture2D::IsRenderedRecently(double Now) const
+{
+	if (TickPolicy != EAnimatedTextureTickPolicy::WhenRendered)
+		return true;
+
+	const float LastRenderTime = GetLastRenderTimeForStreaming();
+	if (LastRenderTime < 0.0f)
+		return true;
+
+	return Now - LastRenderTime <= CVarAnimTextureRenderedTimeout.GetValueOnGameThread();
+}
+
+void UAnimatedTexture2D::UnregisterFromTick()
+{
+	if (TickSlot == INDEX_NONE)
+		return;
 
-	return nFrameDelay / 1000.0f;
+	if (UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get())
+		Subsystem->Unregister(this);
+	TickSlot = INDEX_NONE;
 }
 
 float UAnimatedTexture2D::GetAnimationLength() const
@@ -224,18 +1529,159 @@ float UAnimatedTexture2D::GetAnimationLength() const
 
 void UAnimatedTexture2D::Play()
 {
+	TouchDecodeState();
+	SyncFrameTime();
 	bPlaying = true;
+	UpdateTickRegistration();
 }
 
 void UAnimatedTexture2D::PlayFromStart()
 {
+	TouchDecodeState();
 	FrameTime = 0;
 	FrameDelay = 0;
+	CurrentFrame = INDEX_NONE;
+	bFinished = false;
 	bPlaying = true;
-	if (Decoder) Decoder->Reset();
+	bFirstFrameDecoded = false;
+	if (DecodeAhead)
+		DecodeAhead->Reset();
+	else if (Decoder)
+		Decoder->Reset();
+
+	if (UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get())
+		LastSyncClock = Subsystem->GetClock();
+	UpdateTickRegistration();
 }
 
 void UAnimatedTexture2D::Stop()
 {
+	SyncFrameTime();
 	bPlaying = false;
+	UpdateTickRegistration();
+}
+
+void UAnimatedTexture2D::SetPlayRate(float NewRate)
+{
+	// 先用旧的 PlayRate 结算已经流逝的时间，再切换
+	SyncFrameTime();
+	PlayRate = NewRate;
+	if (IsFrameArrayMode() && FrameArrayTiming)
+		UpdateFrameArrayTiming();
+	UpdateTickRegistration();
+}
+
+void UAnimatedTexture2D::SetLooping(bool bNewLooping)
+{
+	SyncFrameTime();
+	bLooping = bNewLooping;
+	if (bLooping)
+		bFinished = false;
+	if (DecodeAhead)
+		DecodeAhead->SetPlaybackParams(DefaultFrameDelay * 1000, bLooping);
+	UpdateTickRegistration();
+}
+
+void UAnimatedTexture2D::SetPlayDirection(EAnimatedTexturePlayDirection NewDirection)
+{
+	if (PlayDirection == NewDirection)
+		return;
+
+	PlayDirection = NewDirection;
+	ApplyPlayDirection();
+}
+
+void UAnimatedTexture2D::SetTickPolicy(EAnimatedTextureTickPolicy NewPolicy)
+{
+	SyncFrameTime();
+	TickPolicy = NewPolicy;
+	UpdateTickRegistration();
+}
+
+void UAnimatedTexture2D::AdvancePlayback(float DeltaSeconds)
+{
+	TouchDecodeState();
+	if (!Decoder || !bPlaying || bFinished || DeltaSeconds <= 0.0f)
+		return;
+
+	FrameTime += DeltaSeconds * PlayRate;
+	if (FrameTime < FrameDelay)
+		return;
+
+	UpdateFrameNow();
+}
+
+void UAnimatedTexture2D::SetPlaybackPosition(float Seconds)
+{
+	TouchDecodeState();
+	if (!Decoder || Decoder->GetNumFrames() == 0)
+		return;
+
+	const uint32 DefaultDelayMs = DefaultFrameDelay * 1000;
+	const uint32 Duration = Decoder->GetDuration(DefaultDelayMs);
+	double TimeMs = FMath::Max(0.0, Seconds * 1000.0);
+	if (bLooping && Duration > 0)
+		TimeMs = FMath::Fmod(TimeMs, double(Duration));
+	else
+		TimeMs = FMath::Min(TimeMs, double(Duration));
+
+	const int32 FrameIndex = Decoder->FindFrameAtTime(uint32(TimeMs), DefaultDelayMs);
+	const double StartMs = Decoder->GetFrameStartTime(FrameIndex, DefaultDelayMs);
+	SeekInternal(FrameIndex, float(FMath::Max(0.0, TimeMs - StartMs) / 1000.0));
+}
+
+float UAnimatedTexture2D::GetPlaybackPosition() const
+{
+	if (!Decoder || CurrentFrame == INDEX_NONE)
+		return 0.0f;
+
+	// FrameTime 只在换帧时结算，加上之后流逝的时间
+	double Elapsed = FrameTime;
+	UAnimatedTextureSubsystem* Subsystem = UAnimatedTextureSubsystem::Get();
+	if (Subsystem && bPlaying && TickSlot != INDEX_NONE)
+		Elapsed += (Subsystem->GetClock() - LastSyncClock) * PlayRate;
+
+	const uint32 DefaultDelayMs = DefaultFrameDelay * 1000;
+	const double StartMs = Decoder->GetFrameStartTime(CurrentFrame, DefaultDelayMs);
+	return float(StartMs / 1000.0 + FMath::Clamp<double>(Elapsed, 0.0, FrameDelay));
+}
+
+void UAnimatedTexture2D::SeekToFrame(int32 FrameIndex)
+{
+	TouchDecodeState();
+	if (!Decoder || Decoder->GetNumFrames() == 0)
+		return;
+
+	SeekInternal(Decoder->FromSourceFrame(FrameIndex), 0.0f);
+}
+
+int32 UAnimatedTexture2D::GetCurrentFrame() const
+{
+	if (!Decoder || CurrentFrame == INDEX_NONE)
+		return CurrentFrame;
+
+	return Decoder->ToSourceFrame(CurrentFrame);
+}
+
+void UAnimatedTexture2D::SeekInternal(int32 FrameIndex, float OffsetSeconds)
+{
+	const int32 Target = FMath::Clamp(FrameIndex, 0, int32(Decoder->GetNumFrames()) - 1);
+
+	// 解码器从最近的关键帧（或快照、当前位置）开始解码，下一次 NextFrame 输出目标帧
+	if (DecodeAhead)
+		DecodeAhead->Seek(Target);
+	else
+		Decoder->SeekFrame(Target, DefaultFrameDelay * 1000);
+	bFirstFrameDecoded = false;
+
+	// 目标帧作为下一帧立即到期，整张上传
+	CurrentFrame = Target - 1;
+	FrameDelay = 0;
+	FrameTime = OffsetSeconds;
+	PendingDirtyRect = FIntRect();
+	bForceFullUpload = true;
+	bFinished = false;
+
+	UpdateFrameNow();
+	UpdateTickRegistration();
 }
@@ -0,0 +1,281 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Cook-time block-compressed frame arrays for UAnimatedTexture2D
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureBakedFrames.h"
+#include "AnimatedTextureCompat.h"
+
+#include "RenderingThread.h"	// RenderCore
+#include "TextureResource.h"	// Engine
+
+#if WITH_EDITOR
+#include "AnimatedTextureDecoder.h"
+#include "AnimatedTextureSharedSource.h"
+#include "AnimatedTextureModule.h"
+#include "DerivedDataCacheInterface.h"
+#include "ImageCore.h"
+#include "TextureCompressorModule.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Interfaces/ITargetPlatformManagerModule.h"
+#include "Interfaces/ITextureFormat.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// 烘焙算法或数据布局改变时更新，旧的 DDC 数据随之失效
+#define ANIMTEXTURE_BAKED_FRAMES_DERIVEDDATA_VER TEXT("9E4A2C61D7B34F0E8A15C3B97D20F6A4")
+#endif // WITH_EDITOR
+
+int64 FAnimatedTextureBakedFrames::GetFrameSize() const
+{
+	if (Format == PF_Unknown || Format >= PF_MAX)
+		return 0;
+
+	const FPixelFormatInfo& Info = GPixelFormats[Format];
+	const int64 NumBlocksX = FMath::DivideAndRoundUp(Layout.Width, Info.BlockSizeX);
+	const int64 NumBlocksY = FMath::DivideAndRoundUp(Layout.Height, Info.BlockSizeY);
+	return NumBlocksX * NumBlocksY * Info.BlockBytes;
+}
+
+bool FAnimatedTextureBakedFrames::IsValid() const
+{
+	const int64 FrameSize = GetFrameSize();
+	if (FrameSize <= 0 || Layout.NumSlices <= 0 || SliceFrames.Num() != Layout.NumSlices
+		|| Frames.Num() % FrameSize != 0)
+		return false;
+
+	const int32 NumFrames = int32(Frames.Num() / FrameSize);
+	for (int32 Frame : SliceFrames)
+	{
+		if (Frame < 0 || Frame >= NumFrames)
+			return false;
+	}
+	return true;
+}
+
+FArchive& operator<<(FArchive& Ar, FAnimatedTextureBakedFrames& Baked)
+{
+	FAnimatedTextureFrameArrayLayout& Layout = Baked.Layout;
+	Ar << Layout.Width << Layout.Height << Layout.NumSlices << Layout.SliceDuration << Layout.Duration;
+
+	// DDC 里的数据可能被别的引擎版本读到，EPixelFormat 的枚举值不稳定，按名字保存；不认识的名字读成 PF_Unknown，IsValid 失败后重新烘焙
+	FString FormatName;
+	if (Ar.IsSaving())
+		FormatName = GPixelFormats[Baked.Format].Name;
+	Ar << FormatName;
+	if (Ar.IsLoading())
+	{
+		Baked.Format = PF_Unknown;
+		for (int32 Format = PF_Unknown + 1; Format < PF_MAX; Format++)
+		{
+			if (FormatName == GPixelFormats[Format].Name)
+			{
+				Baked.Format = EPixelFormat(Format);
+				break;
+			}
+		}
+	}
+
+	Ar << Baked.SliceFrames;
+	Ar << Baked.Frames;
+	return Ar;
+}
+
+void EnqueueAnimatedTextureBakedFramesUpload(FTextureResource* Resource, TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Baked)
+{
+	check(IsInGameThread());
+	if (!Resource || !Baked)
+		return;
+
+	ENQUEUE_RENDER_COMMAND(AnimTexture2D_UploadBakedFrames)(
+		[Resource, Baked](FRHICommandListImmediate& RHICmdList)
+		{
+			if (!Resource->TextureRHI || Resource->TextureRHI->GetFormat() != Baked->Format)
+				return;
+
+			// 压缩格式按块行拷贝：一行是一排块
+			const FPixelFormatInfo& Info = GPixelFormats[Baked->Format];
+			const uint32 Pitch = FMath::DivideAndRoundUp(Baked->Layout.Width, Info.BlockSizeX) * Info.BlockBytes;
+			const uint32 NumBlockRows = FMath::DivideAndRoundUp(Baked->Layout.Height, Info.BlockSizeY);
+			const int64 FrameSize = Baked->GetFrameSize();
+			for (int32 Slice = 0; Slice < Baked->Layout.NumSlices; Slice++)
+			{
+				const uint8* SrcData = Baked->Frames.GetData() + Baked->SliceFrames[Slice] * FrameSize;
+				AnimatedTextureCompat::AT_UpdateTexture2DArraySlice(RHICmdList, Resource->TextureRHI, Slice, Pitch, NumBlockRows, SrcData);
+			}
+		});
+}
+
+#if WITH_EDITOR
+
+/** 按偏好顺序取目标平台支持的第一个格式：桌面平台 BC，移动平台 ASTC，其次 ETC2 */
+static FName ChooseBakedFormat(const ITargetPlatform* TargetPlatform, bool bHasAlpha)
+{
+	static const FName AlphaFormats[] = { FName(TEXT("BC7")), FName(TEXT("DXT5")), FName(TEXT("ASTC_RGBA")), FName(TEXT("ETC2_RGBA")) };
+	static const FName OpaqueFormats[] = { FName(TEXT("DXT1")), FName(TEXT("ASTC_RGB")), FName(TEXT("ETC2_RGB")) };
+
+	TArray<FName> PlatformFormats;
+	TargetPlatform->GetAllTextureFormats(PlatformFormats);
+
+	const TArrayView<const FName> Preferred = bHasAlpha ? MakeArrayView(AlphaFormats) : MakeArrayView(OpaqueFormats);
+	for (const FName& Format : Preferred)
+	{
+		if (PlatformFormats.Contains(Format))
+			return Format;
+	}
+	return NAME_None;
+}
+
+static bool CompressSlice(const ITextureFormat& TextureFormat, const FTextureBuildSettings& BuildSettings,
+	const FColor* Pixels, int32 Width, int32 Height, bool bHasAlpha, FStringView DebugName, FCompressedImage2D& OutCompressed)
+{
+	FImage Image(Width, Height, ERawImageFormat::BGRA8, BuildSettings.bSRGB ? EGammaSpace::sRGB : EGammaSpace::Linear);
+	FMemory::Memcpy(Image.RawData.GetData(), Pixels, int64(Width) * Height * sizeof(FColor));
+
+	// UE 5.4 起 CompressImage 增加了 Mip 索引与 Mip 数量参数
+#if AT_UE_VERSION_GE(5, 4)
+	return TextureFormat.CompressImage(Image, BuildSettings, FIntVector3(Width, Height, 1), 1, 0, 1, DebugName, bHasAlpha, OutCompressed);
+#else
+	return TextureFormat.CompressImage(Image, BuildSettings, FIntVector3(Width, Height, 1), 1, DebugName, bHasAlpha, OutCompressed);
+#endif
+}
+
+static TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> BuildBakedFrames(EAnimatedTextureType FileType,
+	const TArray<uint8>& FileBytes, const FAnimatedTextureBakedFrames::FSettings& Settings, FName FormatName, FStringView DebugName)
+{
+	const ITextureFormat* TextureFormat = GetTargetPlatformManagerRef().FindTextureFormat(FormatName);
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Decoder = CreateAnimatedTextureDecoder(FileType);
+	if (!TextureFormat || !Decoder || !Decoder->LoadFromMemory(FileBytes.GetData(), FileBytes.Num()))
+		return nullptr;
+
+	// 与运行时的 FrameArray 模式使用同样的布局与合成
+	FAnimatedTextureFrameArray FrameArray;
+	FrameArray.Layout = FAnimatedTextureFrameArrayLayout::Plan(*Decoder, Settings.DefaultFrameDelay, Settings.MaxSlices);
+	if (FrameArray.Layout.NumSlices <= 0)
+		return nullptr;
+	FrameArray.Build(*Decoder, Settings.DefaultFrameDelay);
+	Decoder.Reset();
+
+	const FAnimatedTextureFrameArrayLayout& Layout = FrameArray.Layout;
+	const int32 SliceSize = Layout.Width * Layout.Height;
+
+	FTextureBuildSettings BuildSettings;
+	BuildSettings.TextureFormatName = FormatName;
+	BuildSettings.BaseTextureFormatName = FormatName;
+	BuildSettings.bSRGB = Settings.bSRGB;
+
+	TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Baked = MakeShared<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe>();
+	Baked->Layout = Layout;
+	Baked->SliceFrames.SetNumUninitialized(Layout.NumSlices);
+
+	// 帧延迟较长时一帧占用多个切片，这些切片只压缩、只保存一次
+	TMultiMap<uint32, int32> SlicesByCrc;	// 切片内容的 CRC -> 第一个这样的切片
+	int32 NumUniqueFrames = 0;
+	for (int32 Slice = 0; Slice < Layout.NumSlices; Slice++)
+	{
+		const FColor* Pixels = FrameArray.Pixels.GetData() + Slice * SliceSize;
+		const uint32 Crc = FCrc::MemCrc32(Pixels, SliceSize * sizeof(FColor));
+
+		int32 Frame = INDEX_NONE;
+		TArray<int32, TInlineAllocator<4>> Candidates;
+		SlicesByCrc.MultiFind(Crc, Candidates);
+		for (int32 Candidate : Candidates)
+		{
+			if (FMemory::Memcmp(Pixels, FrameArray.Pixels.GetData() + Candidate * SliceSize, SliceSize * sizeof(FColor)) == 0)
+			{
+				Frame = Baked->SliceFrames[Candidate];
+				break;
+			}
+		}
+
+		if (Frame == INDEX_NONE)
+		{
+			FCompressedImage2D Compressed;
+			if (!CompressSlice(*TextureFormat, BuildSettings, Pixels, Layout.Width, Layout.Height, Settings.bHasAlpha, DebugName, Compressed))
+				return nullptr;
+
+			// 压缩器按配置选择块大小（例如 ASTC），以第一帧的结果为准；
+			// 块压缩纹理的尺寸必须是块大小的整数倍
+			if (Baked->Format == PF_Unknown)
+			{
+				Baked->Format = EPixelFormat(Compressed.PixelFormat);
+				const FPixelFormatInfo& Info = GPixelFormats[Baked->Format];
+				if (Layout.Width % Info.BlockSizeX != 0 || Layout.Height % Info.BlockSizeY != 0)
+					return nullptr;
+			}
+			if (EPixelFormat(Compressed.PixelFormat) != Baked->Format || Compressed.RawData.Num() != Baked->GetFrameSize())
+				return nullptr;
+
+			Frame = NumUniqueFrames++;
+			Baked->Frames.Append(Compressed.RawData.GetData(), int32(Compressed.RawData.Num()));
+			SlicesByCrc.Add(Crc, Slice);
+		}
+		Baked->SliceFrames[Slice] = Frame;
+	}
+
+	return Baked->IsValid() ? Baked : nullptr;
+}
+
+TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> FAnimatedTextureBakedFrames::Bake(EAnimatedTextureType FileType,
+	const TArray<uint8>& FileBytes, const FSettings& Settings, const ITargetPlatform* TargetPlatform, FStringView DebugName)
+{
+	if (!TargetPlatform || FileBytes.Num() <= 0)
+		return nullptr;
+
+	const FName FormatName = ChooseBakedFormat(TargetPlatform, Settings.bHasAlpha);
+	if (FormatName.IsNone())
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("%.*s: %s supports none of the baked frame formats, the file data is cooked instead."),
+			DebugName.Len(), DebugName.GetData(), *TargetPlatform->PlatformName());
+		return nullptr;
+	}
+
+	const ITextureFormat* TextureFormat = GetTargetPlatformManagerRef().FindTextureFormat(FormatName);
+	if (!TextureFormat)
+		return nullptr;
+
+	// 键：文件内容的哈希 + 影响结果的设置；切片数还受 AnimatedTexture.FrameArrayMaxMB 限制，压缩器升级后结果也会变化
+	FSHAHash FileHash;
+	FSHA1::HashBuffer(FileBytes.GetData(), FileBytes.Num(), FileHash.Hash);
+	const FString KeySuffix = FString::Printf(TEXT("%s_%d_%s_%u_%u_%d_%lld_%d_%d"),
+		*FileHash.ToString(), int32(FileType), *FormatName.ToString(), uint32(TextureFormat->GetVersion(FormatName)),
+		Settings.DefaultFrameDelay, Settings.MaxSlices, FAnimatedTextureFrameArrayLayout::GetMaxBytes(),
+		Settings.bSRGB ? 1 : 0, Settings.bHasAlpha ? 1 : 0);
+	const FString CacheKey = FDerivedDataCacheInterface::BuildCacheKey(TEXT("ANIMTEXBAKED"), ANIMTEXTURE_BAKED_FRAMES_DERIVEDDATA_VER, *KeySuffix);
+
+	TArray<uint8> CachedBytes;
+	if (GetDerivedDataCacheRef().GetSynchronous(*CacheKey, CachedBytes, DebugName))
+	{
+		TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Cached = MakeShared<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe>();
+		FMemoryReader Reader(CachedBytes);
+		Reader << *Cached;
+		if (!Reader.IsError() && Cached->IsValid())
+			return Cached;
+	}
+
+	TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Baked = BuildBakedFrames(FileType, FileBytes, Settings, FormatName, DebugName);
+	if (!Baked)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("%.*s: failed to bake the frames as %s (the canvas must be a multiple of the block size), the file data is cooked instead."),
+			DebugName.Len(), DebugName.GetData(), *FormatName.ToString());
+		return nullptr;
+	}
+
+	TArray<uint8> BakedBytes;
+	FMemoryWriter Writer(BakedBytes);
+	Writer << *Baked;
+	GetDerivedDataCacheRef().Put(*CacheKey, BakedBytes, DebugName);
+
+	UE_LOG(LogAnimTexture, Log, TEXT("%.*s: baked %d slices (%d unique) as %s, %d KB."),
+		DebugName.Len(), DebugName.GetData(), Baked->Layout.NumSlices, int32(Baked->Frames.Num() / Baked->GetFrameSize()),
+		GPixelFormats[Baked->Format].Name, BakedBytes.Num() / 1024);
+	return Baked;
+}
+
+#endif // WITH_EDITOR
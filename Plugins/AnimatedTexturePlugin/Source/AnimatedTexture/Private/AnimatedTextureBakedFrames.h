@@ -0,0 +1,63 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Cook-time block-compressed frame arrays for UAnimatedTexture2D
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "AnimatedTextureFrameArray.h"
+
+class FTextureResource;
+class ITargetPlatform;
+enum class EAnimatedTextureType : uint8;
+
+/**
+ * Cook 时烘焙好的帧数组：切片按目标平台的块压缩格式（BC、ASTC、ETC2）编码，相同的切片只保存一份。
+ * 运行时不需要 giflib / libwebp，也不解码，读入之后按切片直接上传到压缩格式的 Texture2DArray。
+ */
+struct FAnimatedTextureBakedFrames
+{
+	FAnimatedTextureFrameArrayLayout Layout;
+	EPixelFormat Format = PF_Unknown;
+
+	/** 切片 -> Frames 中的帧索引 */
+	TArray<int32> SliceFrames;
+
+	/** 不重复的压缩帧，每帧 GetFrameSize() 字节，连续存放 */
+	TArray<uint8> Frames;
+
+	/** 一帧的压缩数据大小（整张画布的所有块） */
+	int64 GetFrameSize() const;
+
+	/** 格式、布局与数据大小是否一致 */
+	bool IsValid() const;
+
+	friend FArchive& operator<<(FArchive& Ar, FAnimatedTextureBakedFrames& Baked);
+
+#if WITH_EDITOR
+	struct FSettings
+	{
+		uint32 DefaultFrameDelay = 100;	// milliseconds
+		int32 MaxSlices = 256;
+		bool bSRGB = true;
+		bool bHasAlpha = true;
+	};
+
+	/**
+	 * Cook：按 FrameArray 的布局合成全部切片，去重后压缩成 TargetPlatform 支持的格式；
+	 * 结果按文件内容的哈希与设置缓存在 DDC。平台没有可用的压缩格式、或画布尺寸不是块大小的整数倍时返回 nullptr
+	 */
+	static TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Bake(EAnimatedTextureType FileType,
+		const TArray<uint8>& FileBytes, const FSettings& Settings, const ITargetPlatform* TargetPlatform, FStringView DebugName);
+#endif // WITH_EDITOR
+};
+
+/** GameThread：把压缩切片上传到 Resource 的 Texture2DArray，上传完成后释放数据 */
+void EnqueueAnimatedTextureBakedFramesUpload(FTextureResource* Resource, TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> Baked);
@@ -90,6 +90,99 @@ inline FTextureRHIRef AT_CreateTexture2D(
 	);
 }
 
+/**
+ * 创建带初始内容的 2D 纹理（单个 mip），内容随创建描述一起提交，不需要 Immediate 命令列表
+ * @param InitialData - 紧密排列的像素数据，RHI 读取后调用 Discard()
+ */
+inline FTextureRHIRef AT_CreateTexture2D(
+	FRHICommandListBase& RHICmdList,
+	const TCHAR* Name,
+	uint32 SizeX,
+	uint32 SizeY,
+	EPixelFormat Format,
+	ETextureCreateFlags Flags,
+	FResourceBulkDataInterface* InitialData)
+{
+	return RHICreateTexture(
+		FRHITextureCreateDesc::Create2D(Name, SizeX, SizeY, Format)
+			.SetFlags(Flags)
+			.SetBulkData(InitialData)
+	);
+}
+
+/**
+ * 创建 2D 纹理数组的兼容性封装
+ * @param RHICmdList - RHI 命令列表
+ * @param Name - 纹理名称
+ * @param SizeX - 纹理宽度
+ * @param SizeY - 纹理高度
+ * @param ArraySize - 切片数量
+ * @param Format - 像素格式
+ * @param Flags - 纹理创建标志
+ * @return 创建的纹理 RHI 引用
+ */
+inline FTextureRHIRef AT_CreateTexture2DArray(
+	FRHICommandListBase& RHICmdList,
+	const TCHAR* Name,
+	uint32 SizeX,
+	uint32 SizeY,
+	uint32 ArraySize,
+	EPixelFormat Format,
+	ETextureCreateFlags Flags)
+{
+	return RHICreateTexture(
+		FRHITextureCreateDesc::Create2DArray(Name, SizeX, SizeY, ArraySize, Format)
+			.SetNumMips(1)
+			.SetFlags(Flags)
+	);
+}
+
+/**
+ * 更新 2D 纹理数组中一个切片（Mip 0）的兼容性封装
+ *   - UE 5.6+：RHICmdList.LockTexture(FRHILockTextureArgs::Lock2DArray(...))
+ *   - UE 5.3~5.5：RHICmdList.LockTexture2DArray / UnlockTexture2DArray
+ *
+ * @param RHICmdList - RHI 命令列表（Immediate）
+ * @param TextureRHI - 目标纹理数组
+ * @param SliceIndex - 切片索引
+ * @param SrcPitch - 源数据行字节数
+ * @param NumRows - 行数（纹理高度）
+ * @param SrcData - 源数据指针
+ */
+inline void AT_UpdateTexture2DArraySlice(
+	FRHICommandListImmediate& RHICmdList,
+	FRHITexture* TextureRHI,
+	uint32 SliceIndex,
+	uint32 SrcPitch,
+	uint32 NumRows,
+	const uint8* SrcData)
+{
+#if AT_UE_VERSION_GE(5, 6)
+	const FRHILockTextureArgs LockArgs = FRHILockTextureArgs::Lock2DArray(TextureRHI, SliceIndex, 0, RLM_WriteOnly, false);
+	const FRHILockTextureResult Locked = RHICmdList.LockTexture(LockArgs);
+	uint8* DestData = static_cast<uint8*>(Locked.Data);
+	const uint32 DestStride = Locked.Stride;
+#else
+	uint32 DestStride = 0;
+	uint8* DestData = static_cast<uint8*>(RHICmdList.LockTexture2DArray(TextureRHI, SliceIndex, 0, RLM_WriteOnly, DestStride, false));
+#endif
+
+	if (DestData)
+	{
+		const uint32 RowBytes = FMath::Min(SrcPitch, DestStride);
+		for (uint32 Row = 0; Row < NumRows; Row++)
+		{
+			FMemory::Memcpy(DestData + Row * DestStride, SrcData + Row * SrcPitch, RowBytes);
+		}
+	}
+
+#if AT_UE_VERSION_GE(5, 6)
+	RHICmdList.UnlockTexture(LockArgs);
+#else
+	RHICmdList.UnlockTexture2DArray(TextureRHI, SliceIndex, 0, false);
+#endif
+}
+
 /**
  * 更新 2D 纹理数据的兼容性封装
  * @param RHICmdList - RHI 命令列表（Immediate）
@@ -124,46 +217,99 @@ inline void AT_UpdateTextureReference(
 }
 
 /**
- * 将帧像素数据上传到 GPU 纹理的高层兼容性封装
- *
- * 该函数封装了从 FRHITexture 获取纹理尺寸、构建更新区域、上传像素数据的完整流程，
- * 内部通过条件编译处理不同引擎版本的 RHI API 差异：
+ * 获取 2D 纹理尺寸的兼容性封装
  *   - UE 5.7+：FRHITexture2D 子类型已移除，直接使用 FRHITexture* 操作
  *   - UE 5.3~5.6：通过 GetTexture2D() 获取 FTexture2DRHIRef 后操作
  *
- * @param RHICmdList - RHI 命令列表（Immediate）
  * @param TextureRHI - 目标纹理 RHI 指针（调用方需确保非空）
- * @param SrcData - 帧像素数据指针（BGRA 格式，大小应匹配纹理尺寸）
- * @return 操作是否成功（纹理无效时返回 false）
+ * @param OutWidth - 纹理宽度
+ * @param OutHeight - 纹理高度
+ * @return 纹理是否为有效的 2D 纹理
  */
-inline bool AT_UpdateFrameToTexture(
-	FRHICommandListImmediate& RHICmdList,
+inline bool AT_GetTexture2DSize(
 	FRHITexture* TextureRHI,
-	const uint8* SrcData)
+	uint32& OutWidth,
+	uint32& OutHeight)
 {
 #if AT_UE_VERSION_GE(5, 7)
 	// UE 5.7+ : FRHITexture2D 子类型已移除，直接使用统一的 FRHITexture*
-	uint32 TexWidth = TextureRHI->GetSizeX();
-	uint32 TexHeight = TextureRHI->GetSizeY();
+	OutWidth = TextureRHI->GetSizeX();
+	OutHeight = TextureRHI->GetSizeY();
 #else
 	// UE 5.3~5.6 : 通过 GetTexture2D() 获取特化类型并验证
 	FTexture2DRHIRef Texture2DRHI = TextureRHI->GetTexture2D();
 	if (!Texture2DRHI)
 		return false;
 
-	uint32 TexWidth = Texture2DRHI->GetSizeX();
-	uint32 TexHeight = Texture2DRHI->GetSizeY();
+	OutWidth = Texture2DRHI->GetSizeX();
+	OutHeight = Texture2DRHI->GetSizeY();
 #endif
+	return true;
+}
+
+/**
+ * 将帧的一个子区域上传到 GPU 纹理的高层兼容性封装
+ *
+ * 区域会被裁剪到纹理尺寸之内；裁剪后为空时不做任何上传。
+ *
+ * @param RHICmdList - RHI 命令列表（Immediate）
+ * @param TextureRHI - 目标纹理 RHI 指针（调用方需确保非空）
+ * @param DestRect - 目标区域（纹理坐标，Max 不包含）
+ * @param SrcPitch - 源数据行字节数
+ * @param SrcData - 区域像素数据指针（BGRA 格式，首个像素对应 DestRect.Min）
+ * @return 操作是否成功（纹理无效时返回 false）
+ */
+inline bool AT_UpdateFrameRegionToTexture(
+	FRHICommandListImmediate& RHICmdList,
+	FRHITexture* TextureRHI,
+	const FIntRect& DestRect,
+	uint32 SrcPitch,
+	const uint8* SrcData)
+{
+	uint32 TexWidth = 0;
+	uint32 TexHeight = 0;
+	if (!AT_GetTexture2DSize(TextureRHI, TexWidth, TexHeight))
+		return false;
 
-	uint32 SrcPitch = TexWidth * sizeof(FColor);
+	const int32 Right = FMath::Min<int32>(DestRect.Max.X, TexWidth);
+	const int32 Bottom = FMath::Min<int32>(DestRect.Max.Y, TexHeight);
+	if (DestRect.Min.X < 0 || DestRect.Min.Y < 0 || Right <= DestRect.Min.X || Bottom <= DestRect.Min.Y)
+		return true;
 
 	FUpdateTextureRegion2D Region;
-	Region.SrcX = Region.SrcY = Region.DestX = Region.DestY = 0;
-	Region.Width = TexWidth;
-	Region.Height = TexHeight;
+	Region.SrcX = Region.SrcY = 0;
+	Region.DestX = DestRect.Min.X;
+	Region.DestY = DestRect.Min.Y;
+	Region.Width = Right - DestRect.Min.X;
+	Region.Height = Bottom - DestRect.Min.Y;
 
 	AT_UpdateTexture2D(RHICmdList, TextureRHI, 0, Region, SrcPitch, SrcData);
 	return true;
 }
 
+/**
+ * 将帧像素数据上传到 GPU 纹理的高层兼容性封装
+ *
+ * 该函数封装了从 FRHITexture 获取纹理尺寸、构建更新区域、上传像素数据的完整流程，
+ * 纹理尺寸的版本差异见 AT_GetTexture2DSize。
+ *
+ * @param RHICmdList - RHI 命令列表（Immediate）
+ * @param TextureRHI - 目标纹理 RHI 指针（调用方需确保非空）
+ * @param SrcData - 帧像素数据指针（BGRA 格式，大小应匹配纹理尺寸）
+ * @return 操作是否成功（纹理无效时返回 false）
+ */
+inline bool AT_UpdateFrameToTexture(
+	FRHICommandListImmediate& RHICmdList,
+	FRHITexture* TextureRHI,
+	const uint8* SrcData)
+{
+	uint32 TexWidth = 0;
+	uint32 TexHeight = 0;
+	if (!AT_GetTexture2DSize(TextureRHI, TexWidth, TexHeight))
+		return false;
+
+	const uint32 SrcPitch = TexWidth * sizeof(FColor);
+	return AT_UpdateFrameRegionToTexture(RHICmdList, TextureRHI, FIntRect(0, 0, TexWidth, TexHeight), SrcPitch, SrcData);
+}
+
 } // namespace AnimatedTextureCompat
@@ -0,0 +1,218 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Decode-ahead worker for UAnimatedTexture2D
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureDecodeAhead.h"
+#include "AnimatedTextureDecoder.h"
+#include "AnimatedTexturePixelPacker.h"
+
+#include "Async/Async.h"
+
+FAnimatedTextureDecodeAhead::FAnimatedTextureDecodeAhead(TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> InDecoder, int32 InNumFrames,
+	TSharedPtr<const FAnimatedTexturePixelPacker, ESPMode::ThreadSafe> InPacker)
+	: Decoder(InDecoder)
+	, Packer(InPacker)
+{
+	check(Decoder);
+	check(!Packer || !Decoder->IsIndexedOutput());
+
+	// 帧缓冲在构造时一次性分配，worker 运行期间不再分配内存
+	const int32 BytesPerPixel = Packer ? sizeof(uint16) : Decoder->GetBytesPerPixel();
+	const int32 NumBytes = Decoder->GetWidth() * Decoder->GetHeight() * BytesPerPixel;
+	Ring.SetNum(FMath::Max(InNumFrames, 2));
+	for (FFrame& Frame : Ring)
+	{
+		Frame.Pixels.SetNumUninitialized(NumBytes);
+	}
+}
+
+FAnimatedTextureDecodeAhead::~FAnimatedTextureDecodeAhead()
+{
+	// worker 持有 this 的强引用，走到析构时不可能还有任务在运行
+	check(!InFlight.IsValid() || InFlight.IsReady());
+}
+
+SIZE_T FAnimatedTextureDecodeAhead::GetAllocatedSize() const
+{
+	// 像素缓冲只在构造时分配，这里读取是线程安全的
+	SIZE_T Size = Ring.GetAllocatedSize();
+	for (const FFrame& Frame : Ring)
+		Size += Frame.Pixels.GetAllocatedSize();
+	return Size;
+}
+
+void FAnimatedTextureDecodeAhead::SetPlaybackParams(uint32 InDefaultFrameDelay, bool bInLooping)
+{
+	DefaultFrameDelay.store(InDefaultFrameDelay, std::memory_order_relaxed);
+	bLooping.store(bInLooping, std::memory_order_relaxed);
+}
+
+const FAnimatedTextureDecodeAhead::FFrame* FAnimatedTextureDecodeAhead::PeekFrame() const
+{
+	const uint32 Read = ReadCount.load(std::memory_order_relaxed);
+	const uint32 Write = WriteCount.load(std::memory_order_acquire);
+	if (Write == Read)
+		return nullptr;
+
+	return &Ring[Read % Ring.Num()];
+}
+
+void FAnimatedTextureDecodeAhead::PopFrame()
+{
+	const uint32 Read = ReadCount.load(std::memory_order_relaxed);
+	if (WriteCount.load(std::memory_order_acquire) == Read)
+		return;
+
+	ReadCount.store(Read + 1, std::memory_order_release);
+	Kick();
+}
+
+void FAnimatedTextureDecodeAhead::Skip(uint32 NumFrames, FIntRect& InOutDirtyRect)
+{
+	while (NumFrames > 0)
+	{
+		if (const FFrame* Frame = PeekFrame())
+		{
+			InOutDirtyRect = FAnimatedTextureDecoder::UnionRect(InOutDirtyRect, Frame->DirtyRect);
+			ReadCount.store(ReadCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			NumFrames--;
+			continue;
+		}
+
+		// 队列已空：worker 停下之后可能又写入了新帧，先消费它们，保证帧的顺序
+		WaitForWorker();
+		if (PeekFrame())
+			continue;
+
+		// 剩下的帧交给解码器，可以直接跳到关键帧
+		Decoder->SkipFrames(NumFrames, DefaultFrameDelay.load(std::memory_order_relaxed), bLooping.load(std::memory_order_relaxed), InOutDirtyRect);
+		break;
+	}
+}
+
+void FAnimatedTextureDecodeAhead::Kick()
+{
+	check(IsInGameThread());
+
+	if (bShutdown)
+		return;
+	if (InFlight.IsValid() && !InFlight.IsReady())
+		return;
+
+	const uint32 Pending = WriteCount.load(std::memory_order_relaxed) - ReadCount.load(std::memory_order_relaxed);
+	if (Pending >= static_cast<uint32>(Ring.Num()))
+		return;
+
+	TSharedRef<FAnimatedTextureDecodeAhead, ESPMode::ThreadSafe> Self = AsShared();
+	InFlight = Async(EAsyncExecution::ThreadPool, [Self]()
+		{
+			Self->DecodeWorker();
+		});
+}
+
+void FAnimatedTextureDecodeAhead::Reset()
+{
+	check(IsInGameThread());
+
+	WaitForWorker();
+
+	Decoder->Reset();
+	ReadCount.store(0, std::memory_order_relaxed);
+	WriteCount.store(0, std::memory_order_relaxed);
+
+	Kick();
+}
+
+void FAnimatedTextureDecodeAhead::Seek(int32 FrameIndex)
+{
+	check(IsInGameThread());
+
+	WaitForWorker();
+
+	Decoder->SeekFrame(FrameIndex, DefaultFrameDelay.load(std::memory_order_relaxed));
+	DecodeInto(Ring[0]);
+	ReadCount.store(0, std::memory_order_relaxed);
+	WriteCount.store(1, std::memory_order_relaxed);
+
+	Kick();
+}
+
+void FAnimatedTextureDecodeAhead::AdoptCurrentFrame()
+{
+	check(IsInGameThread() && !InFlight.IsValid());
+
+	const int32 FrameIndex = Decoder->GetCurrentFrame();
+	if (FrameIndex == INDEX_NONE || WriteCount.load(std::memory_order_relaxed) != 0)
+		return;
+
+	// 队首帧是播放的第一帧，整张画布都需要上传
+	const uint32 Delay = Decoder->GetFrameDelay(FrameIndex, DefaultFrameDelay.load(std::memory_order_relaxed));
+	CopyCurrentFrame(Ring[0], Delay, FIntRect(0, 0, Decoder->GetWidth(), Decoder->GetHeight()));
+	WriteCount.store(1, std::memory_order_release);
+}
+
+void FAnimatedTextureDecodeAhead::Shutdown()
+{
+	WaitForWorker();
+	bShutdown = true;
+}
+
+void FAnimatedTextureDecodeAhead::WaitForWorker()
+{
+	if (InFlight.IsValid())
+	{
+		bStopRequested.store(true, std::memory_order_relaxed);
+		InFlight.Wait();
+		InFlight.Reset();
+		bStopRequested.store(false, std::memory_order_relaxed);
+	}
+}
+
+void FAnimatedTextureDecodeAhead::DecodeWorker()
+{
+	const uint32 NumFrames = static_cast<uint32>(Ring.Num());
+
+	while (!bStopRequested.load(std::memory_order_relaxed))
+	{
+		const uint32 Write = WriteCount.load(std::memory_order_relaxed);
+		if (Write - ReadCount.load(std::memory_order_acquire) >= NumFrames)
+			break;
+
+		DecodeInto(Ring[Write % NumFrames]);
+		WriteCount.store(Write + 1, std::memory_order_release);
+	}
+}
+
+void FAnimatedTextureDecodeAhead::DecodeInto(FFrame& Slot)
+{
+	const uint32 FrameDelay = Decoder->NextFrame(DefaultFrameDelay.load(std::memory_order_relaxed), bLooping.load(std::memory_order_relaxed));
+	CopyCurrentFrame(Slot, FrameDelay, Decoder->GetDirtyRect());
+}
+
+void FAnimatedTextureDecodeAhead::CopyCurrentFrame(FFrame& Slot, uint32 FrameDelay, const FIntRect& DirtyRect)
+{
+	Slot.FrameDelay = FrameDelay;
+	Slot.DirtyRect = DirtyRect;
+	Slot.FrameIndex = Decoder->GetCurrentFrame();
+
+	// 槽位保存整张画布（Skip 合并的脏矩形会读到之前帧的区域），16 位格式的转换也在 worker 上完成
+	const uint8* SrcCanvas = Decoder->GetCanvasData();
+	if (!SrcCanvas)
+		return;
+
+	if (Packer)
+	{
+		const int32 Width = Decoder->GetWidth();
+		Packer->PackRect(Slot.Pixels.GetData(), reinterpret_cast<const FColor*>(SrcCanvas), Width, FIntRect(0, 0, Width, Decoder->GetHeight()));
+	}
+	else
+	{
+		FMemory::Memcpy(Slot.Pixels.GetData(), SrcCanvas, Slot.Pixels.Num());
+	}
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Decode-ahead worker for UAnimatedTexture2D
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include <atomic>
+
+class FAnimatedTextureDecoder;
+class FAnimatedTexturePixelPacker;
+
+/**
+ * 预解码环形队列（Decode-ahead ring）
+ *
+ * - 解码器在线程池上运行，提前把 N 帧解码到环形队列中；
+ * - 游戏线程只做 PeekFrame / PopFrame，取出已经解码好的帧提交给渲染线程；
+ * - 单生产者（同一时刻最多一个 worker 任务）/ 单消费者（游戏线程），读写计数使用原子变量，无需加锁。
+ *
+ * 注意：启用后 Decoder 只允许被 worker 访问（GetWidth/GetHeight 等只读元数据除外）。
+ */
+class FAnimatedTextureDecodeAhead : public TSharedFromThis<FAnimatedTextureDecodeAhead, ESPMode::ThreadSafe>
+{
+public:
+	struct FFrame
+	{
+		TArray<uint8> Pixels;	// 整张画布，按上传格式（BGRA、调色板索引或 Packer 转换后的 16 位格式）
+		uint32 FrameDelay = 0;	// milliseconds
+		FIntRect DirtyRect;
+		int32 FrameIndex = INDEX_NONE;
+	};
+
+	/** InPacker 不为空时 worker 把解码出的 BGRA 画布转换为 16 位格式再放入队列 */
+	FAnimatedTextureDecodeAhead(TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> InDecoder, int32 InNumFrames,
+		TSharedPtr<const FAnimatedTexturePixelPacker, ESPMode::ThreadSafe> InPacker = nullptr);
+	~FAnimatedTextureDecodeAhead();
+
+	/** 游戏线程：更新 worker 解码时使用的播放参数 */
+	void SetPlaybackParams(uint32 InDefaultFrameDelay, bool bInLooping);
+
+	/** 游戏线程：返回队首已解码的帧；队列为空（解码跟不上）时返回 nullptr */
+	const FFrame* PeekFrame() const;
+
+	/** 游戏线程：释放队首帧，并唤醒 worker 继续填充 */
+	void PopFrame();
+
+	/**
+	 * 消费者线程（与 PeekFrame 相同）：丢弃接下来的 NumFrames 帧，队列里不够时等 worker 停下后直接推进解码器；
+	 * 不会启动新的 worker，由之后的 PopFrame / Kick 继续填充
+	 * @param InOutDirtyRect	合并被跳过的帧的脏矩形
+	 */
+	void Skip(uint32 NumFrames, FIntRect& InOutDirtyRect);
+
+	/** 游戏线程：若队列未满且没有 worker 在运行，则启动一个 worker 任务 */
+	void Kick();
+
+	/** 游戏线程：等待 worker 结束、重置解码器并清空队列，然后重新开始预解码 */
+	void Reset();
+
+	/** 游戏线程：等待 worker 结束、清空队列并定位解码器，目标帧同步解码到队首（可以立即 PeekFrame），然后继续预解码 */
+	void Seek(int32 FrameIndex);
+
+	/** 游戏线程，Kick 之前：解码器已经输出但还没有人取走的当前帧（加载管线预解码的第 0 帧）放到队首 */
+	void AdoptCurrentFrame();
+
+	/** 等待 in-flight 的 worker 结束；之后不会再启动新的任务 */
+	void Shutdown();
+
+	int32 GetNumFrames() const { return Ring.Num(); }
+
+	/** 环形队列中像素缓冲占用的内存 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void DecodeWorker();
+	void DecodeInto(FFrame& Slot);
+	void CopyCurrentFrame(FFrame& Slot, uint32 FrameDelay, const FIntRect& DirtyRect);
+	void WaitForWorker();
+
+private:
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Decoder;
+	TSharedPtr<const FAnimatedTexturePixelPacker, ESPMode::ThreadSafe> Packer;
+	TArray<FFrame> Ring;
+
+	std::atomic<uint32> ReadCount{ 0 };
+	std::atomic<uint32> WriteCount{ 0 };
+
+	std::atomic<uint32> DefaultFrameDelay{ 100 };
+	std::atomic<bool> bLooping{ true };
+	std::atomic<bool> bStopRequested{ false };
+	bool bShutdown = false;
+
+	TFuture<void> InFlight;
+};
@@ -12,6 +12,61 @@
 
 #include "CoreMinimal.h"
 
+/**
+ * 随机访问用的画布快照：每 Interval 帧保存一次解码之后的状态，播放或 Seek 经过时按需填充，
+ * Seek 最多只需从快照往后解码 Interval 帧。PixelType 是画布的像素类型（BGRA 或 8 位调色板索引）
+ */
+template<typename PixelType>
+struct TAnimatedTextureSnapshots
+{
+	int32 Interval = 0;
+	TArray<TArray<PixelType>> Canvases;	// [i] 是第 (i + 1) * Interval - 1 帧解码之后的状态，空数组表示还没有经过
+
+	void Init(int32 InInterval, int32 NumFrames)
+	{
+		Interval = FMath::Max(InInterval, 0);
+		Canvases.Empty();
+		if (Interval > 0)
+			Canvases.SetNum(NumFrames / Interval);
+	}
+
+	void Capture(int32 FrameIndex, const TArray<PixelType>& Canvas)
+	{
+		if (Interval <= 0 || (FrameIndex + 1) % Interval != 0)
+			return;
+
+		TArray<PixelType>& Snapshot = Canvases[(FrameIndex + 1) / Interval - 1];
+		if (Snapshot.Num() == 0)
+			Snapshot = Canvas;
+	}
+
+	/** FrameIndex 之前最近的已保存快照对应的帧，没有时返回 INDEX_NONE */
+	int32 FindBefore(int32 FrameIndex) const
+	{
+		if (Interval <= 0)
+			return INDEX_NONE;
+
+		for (int32 i = FMath::Min(FrameIndex / Interval, Canvases.Num()) - 1; i >= 0; i--)
+		{
+			if (Canvases[i].Num() > 0)
+				return (i + 1) * Interval - 1;
+		}
+		return INDEX_NONE;
+	}
+
+	const TArray<PixelType>& Get(int32 FrameIndex) const { return Canvases[(FrameIndex + 1) / Interval - 1]; }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = Canvases.GetAllocatedSize();
+		for (const TArray<PixelType>& Canvas : Canvases)
+			Size += Canvas.GetAllocatedSize();
+		return Size;
+	}
+};
+
+typedef TAnimatedTextureSnapshots<FColor> FAnimatedTextureSnapshots;
+
 class FAnimatedTextureDecoder
 {
 public:
@@ -27,13 +82,154 @@ public:
 	virtual uint32 NextFrame(uint32 DefaultFrameDelay, bool bLooping) = 0;
 	virtual void Reset() = 0;
 
+	/**
+	 * Advance past NumFrames frames without outputting them, the next NextFrame() call decodes the frame after them.
+	 * Decoders with a keyframe index override this to skip frames that a later keyframe fully overwrites.
+	 * @param InOutDirtyRect	unioned with the canvas area modified by the skipped frames
+	 */
+	virtual void SkipFrames(uint32 NumFrames, uint32 DefaultFrameDelay, bool bLooping, FIntRect& InOutDirtyRect)
+	{
+		for (uint32 i = 0; i < NumFrames; i++)
+		{
+			NextFrame(DefaultFrameDelay, bLooping);
+			InOutDirtyRect = UnionRect(InOutDirtyRect, GetDirtyRect());
+		}
+	}
+
+	/**
+	 * Position the decoder so that the next NextFrame() call outputs FrameIndex.
+	 * The default resets when seeking backwards and skips forward; decoders with a keyframe index
+	 * start from the nearest keyframe, snapshot or the current position.
+	 */
+	virtual void SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay)
+	{
+		const int32 NumFrames = GetNumFrames();
+		if (NumFrames == 0)
+			return;
+
+		const int32 Target = FMath::Clamp(FrameIndex, 0, NumFrames - 1);
+		int32 Next = GetCurrentFrame() + 1;
+		if (Target < Next)
+		{
+			Reset();
+			Next = 0;
+		}
+
+		FIntRect DirtyRect;
+		SkipFrames(Target - Next, DefaultFrameDelay, false, DirtyRect);
+	}
+
+	/** Cache a snapshot every Interval frames so that SeekFrame() decodes at most Interval frames, 0 disables */
+	virtual void SetSnapshotInterval(int32 Interval) {}
+
+	/**
+	 * @return index of the frame decoded by the last NextFrame() call, INDEX_NONE after Reset()
+	 */
+	virtual int32 GetCurrentFrame() const = 0;
+
+	/**
+	 * Decoders that reorder the frames of a file (reverse / ping-pong playback) map their frame indices to the file's
+	 * @return index of the file frame shown at the given frame index
+	 */
+	virtual int32 ToSourceFrame(int32 Index) const { return Index; }
+
+	/**
+	 * @return first frame index that shows the given file frame
+	 */
+	virtual int32 FromSourceFrame(int32 SourceFrame) const { return SourceFrame; }
+
 	virtual uint32 GetWidth() const = 0;
 	virtual uint32 GetHeight() const = 0;
 	virtual const FColor* GetFrameBuffer() const = 0;
 
+	/**
+	 * @return true if every frame fits one shared palette of at most 256 colors (see SetIndexedOutput)
+	 */
+	virtual bool SupportsIndexedOutput() const { return false; }
+
+	/**
+	 * Switch the canvas between BGRA (GetFrameBuffer) and 8-bit indices into GetPalette() (GetIndexBuffer).
+	 * Resets the decoder, the next NextFrame() call outputs the first frame.
+	 * @return false if the requested output is not supported, the decoder keeps its current output
+	 */
+	virtual bool SetIndexedOutput(bool bEnable) { return !bEnable; }
+	virtual bool IsIndexedOutput() const { return false; }
+
+	/**
+	 * @return 256 BGRA entries shared by all frames, nullptr if SupportsIndexedOutput() is false
+	 */
+	virtual const FColor* GetPalette() const { return nullptr; }
+
+	/**
+	 * @return canvas of palette indices, nullptr unless the indexed output is enabled
+	 */
+	virtual const uint8* GetIndexBuffer() const { return nullptr; }
+
+	/** Canvas in the current output format, GetBytesPerPixel() bytes per pixel */
+	const uint8* GetCanvasData() const
+	{
+		return IsIndexedOutput() ? GetIndexBuffer() : reinterpret_cast<const uint8*>(GetFrameBuffer());
+	}
+	uint32 GetBytesPerPixel() const { return IsIndexedOutput() ? 1 : sizeof(FColor); }
+
+	virtual uint32 GetNumFrames() const = 0;
+
+	/**
+	 * @return delay of the given frame in milliseconds, DefaultFrameDelay if the file does not specify one
+	 */
+	virtual uint32 GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const = 0;
 	virtual uint32 GetDuration(uint32 defaultFrameDelay) const = 0;
+
+	/**
+	 * @return start time of the given frame in milliseconds
+	 */
+	virtual uint32 GetFrameStartTime(uint32 FrameIndex, uint32 DefaultFrameDelay) const
+	{
+		uint32 StartTime = 0;
+		for (uint32 i = 0; i < FrameIndex; i++)
+			StartTime += GetFrameDelay(i, DefaultFrameDelay);
+		return StartTime;
+	}
+
+	/**
+	 * @return the frame shown at TimeMs (0 ~ GetDuration), the last frame beyond the duration
+	 */
+	virtual int32 FindFrameAtTime(uint32 TimeMs, uint32 DefaultFrameDelay) const
+	{
+		const uint32 NumFrames = GetNumFrames();
+		uint32 EndTime = 0;
+		for (uint32 i = 0; i < NumFrames; i++)
+		{
+			EndTime += GetFrameDelay(i, DefaultFrameDelay);
+			if (TimeMs < EndTime)
+				return i;
+		}
+		return NumFrames > 0 ? NumFrames - 1 : INDEX_NONE;
+	}
 	virtual bool SupportsTransparency() const = 0;
 
+	/**
+	 * @return canvas area modified by the last NextFrame() call (Max is exclusive), empty if nothing changed
+	 */
+	virtual FIntRect GetDirtyRect() const = 0;
+
+	/**
+	 * @return CPU memory held by the decoder (canvas, frame index, scratch buffers), excluding the file data
+	 */
+	virtual SIZE_T GetAllocatedSize() const = 0;
+
+	/** 合并两个脏矩形，空矩形不参与合并 */
+	static FIntRect UnionRect(const FIntRect& A, const FIntRect& B)
+	{
+		if (A.Width() <= 0 || A.Height() <= 0)
+			return B;
+		if (B.Width() <= 0 || B.Height() <= 0)
+			return A;
+		return FIntRect(
+			FMath::Min(A.Min.X, B.Min.X), FMath::Min(A.Min.Y, B.Min.Y),
+			FMath::Max(A.Max.X, B.Max.X), FMath::Max(A.Max.Y, B.Max.Y));
+	}
+
 public:
 	FAnimatedTextureDecoder(const FAnimatedTextureDecoder&) = delete;
 	FAnimatedTextureDecoder& operator=(const FAnimatedTextureDecoder&) = delete;
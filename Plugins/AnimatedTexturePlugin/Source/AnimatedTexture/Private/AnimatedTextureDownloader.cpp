@@ -12,6 +12,40 @@
 
 #include "HttpModule.h"
 #include "Async/Async.h"
+#include "Serialization/Archive.h"
+
+/**
+ * 接收响应体的流：HTTP 线程把数据直接追加进 Body，完成后 GameThread 整块取走。
+ * 超过 MaxBytes 之后不再追加，完成时按 SizeLimitExceeded 处理。
+ */
+class FAnimatedTextureBodyArchive : public FArchive
+{
+public:
+	explicit FAnimatedTextureBodyArchive(int32 InMaxBytes)
+		: MaxBytes(InMaxBytes)
+	{
+		SetIsSaving(true);
+	}
+
+	virtual void Serialize(void* Data, int64 Num) override
+	{
+		if (bOverflow || Num <= 0)
+			return;
+		if (MaxBytes > 0 && Body.Num() + Num > MaxBytes)
+		{
+			bOverflow = true;
+			Body.Empty();
+			return;
+		}
+		Body.Append(static_cast<const uint8*>(Data), int32(Num));
+	}
+
+	virtual FString GetArchiveName() const override { return TEXT("FAnimatedTextureBodyArchive"); }
+
+	TArray<uint8> Body;
+	int32 MaxBytes = 0;
+	bool bOverflow = false;
+};
 
 FAnimatedTextureDownloader::FAnimatedTextureDownloader()
 {
@@ -63,6 +97,13 @@ bool FAnimatedTextureDownloader::BeginDownload(const FString& InUrl, float InTim
 	Request->SetURL(Url);
 	Request->SetTimeout(ResolvedTimeout);
 
+	// 响应体直接写进自己的数组，完成后整块移交，省掉一次拷贝
+	BodyArchive = MakeShared<FAnimatedTextureBodyArchive>(MaxBytes);
+	if (!Request->SetResponseBodyReceiveStream(BodyArchive.ToSharedRef()))
+	{
+		BodyArchive.Reset();
+	}
+
 	// 以弱引用持有 self，避免在请求生命周期中阻止对象释放。
 	TWeakPtr<FAnimatedTextureDownloader, ESPMode::ThreadSafe> WeakSelf = AsShared();
 	Request->OnProcessRequestComplete().BindLambda(
@@ -113,6 +154,9 @@ void FAnimatedTextureDownloader::OnHttpRequestComplete(
 	TSharedPtr<IHttpResponse, ESPMode::ThreadSafe> HttpResponse,
 	bool bSucceeded)
 {
+	// 请求已经结束，HTTP 线程不会再写入接收流
+	TSharedPtr<FAnimatedTextureBodyArchive> Archive = MoveTemp(BodyArchive);
+
 	// 请求已被取消：不再派发任何回调。
 	if (bCanceled)
 	{
@@ -141,21 +185,32 @@ void FAnimatedTextureDownloader::OnHttpRequestComplete(
 		return;
 	}
 
-	const TArray<uint8>& Content = HttpResponse->GetContent();
-	if (Content.Num() <= 0)
+	// HTTP 实现不支持接收流时退回到拷贝 IHttpResponse 的内容
+	TArray<uint8> Content;
+	bool bOverflow = false;
+	if (Archive.IsValid())
+	{
+		Content = MoveTemp(Archive->Body);
+		bOverflow = Archive->bOverflow;
+	}
+	else
+	{
+		Content = HttpResponse->GetContent();
+	}
+
+	if (bOverflow || (MaxBytes > 0 && Content.Num() > MaxBytes))
 	{
 		UE_LOG(LogAnimTexture, Warning,
-			TEXT("FAnimatedTextureDownloader: empty body for %s"), *Url);
-		OnError.ExecuteIfBound(EAnimatedTextureLoadError::EmptyBody);
+			TEXT("FAnimatedTextureDownloader: body size exceeds limit %d for %s"), MaxBytes, *Url);
+		OnError.ExecuteIfBound(EAnimatedTextureLoadError::SizeLimitExceeded);
 		return;
 	}
 
-	if (MaxBytes > 0 && Content.Num() > MaxBytes)
+	if (Content.Num() <= 0)
 	{
 		UE_LOG(LogAnimTexture, Warning,
-			TEXT("FAnimatedTextureDownloader: body size %d exceeds limit %d for %s"),
-			Content.Num(), MaxBytes, *Url);
-		OnError.ExecuteIfBound(EAnimatedTextureLoadError::SizeLimitExceeded);
+			TEXT("FAnimatedTextureDownloader: empty body for %s"), *Url);
+		OnError.ExecuteIfBound(EAnimatedTextureLoadError::EmptyBody);
 		return;
 	}
 
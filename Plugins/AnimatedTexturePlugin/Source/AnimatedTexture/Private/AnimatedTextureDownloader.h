@@ -25,18 +25,21 @@
  * - BeginDownload 发起 GET 请求；完成时调用 OnComplete（成功）或 OnError（失败）。
  * - 回调在 GameThread 上触发（HTTP 模块默认 Tick 驱动即在 GameThread）。
  * - Cancel() 会取消底层请求；一旦取消，Complete / Error 回调不会再被触发。
+ * - 响应体直接写进下载器自己的数组（不经过 IHttpResponse 的内容缓冲），完成时整块交给 OnComplete，可以直接 MoveTemp 取走。
  *
  * 用法：
  *   auto D = MakeShared<FAnimatedTextureDownloader, ESPMode::ThreadSafe>();
- *   D->OnComplete.BindLambda([](bool bOk, const TArray<uint8>& Body, const FString& ETag){ ... });
+ *   D->OnComplete.BindLambda([](TArray<uint8>& Body, const FString& ETag){ ... MoveTemp(Body) ... });
  *   D->OnError.BindLambda([](EAnimatedTextureLoadError Err){ ... });
  *   D->BeginDownload(Url, 30.0f, 32 * 1024 * 1024);
  */
+class FAnimatedTextureBodyArchive;
+
 class FAnimatedTextureDownloader : public TSharedFromThis<FAnimatedTextureDownloader, ESPMode::ThreadSafe>
 {
 public:
-	/** 下载成功回调：Body 非空，ETag 可为空串。 */
-	DECLARE_DELEGATE_TwoParams(FOnComplete, const TArray<uint8>& /*Body*/, const FString& /*ETag*/);
+	/** 下载成功回调：Body 非空，回调可以 MoveTemp 取走；ETag 可为空串。 */
+	DECLARE_DELEGATE_TwoParams(FOnComplete, TArray<uint8>& /*Body*/, const FString& /*ETag*/);
 	/** 下载失败回调：带错误码。 */
 	DECLARE_DELEGATE_OneParam(FOnError, EAnimatedTextureLoadError);
 
@@ -75,6 +78,7 @@ private:
 	int32 MaxBytes = 0;
 
 	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> PendingRequest;
+	TSharedPtr<FAnimatedTextureBodyArchive> BodyArchive;	// 为空表示 HTTP 实现不支持接收流，响应体从 IHttpResponse 拷贝
 
 	bool bCanceled = false;
 	bool bFinished = false;
@@ -0,0 +1,142 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * GPU frame-array playback for UAnimatedTexture2D
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureFrameArray.h"
+#include "AnimatedTextureDecoder.h"
+#include "AnimatedTextureCompat.h"
+
+#include "HAL/IConsoleManager.h"
+#include "RenderingThread.h"	// RenderCore
+#include "TextureResource.h"	// Engine
+
+static TAutoConsoleVariable<int32> CVarAnimTextureFrameArrayMaxMB(
+	TEXT("AnimatedTexture.FrameArrayMaxMB"),
+	256,
+	TEXT("Upper bound of the BGRA memory one FrameArray texture composites its slices into, in MB.\n")
+	TEXT("Frames are resampled at a coarser interval when MaxFrameArraySlices slices would not fit; a canvas larger than the budget is not built."));
+
+static uint32 GreatestCommonDivisor(uint32 A, uint32 B)
+{
+	while (B != 0)
+	{
+		const uint32 T = A % B;
+		A = B;
+		B = T;
+	}
+	return A;
+}
+
+int64 FAnimatedTextureFrameArrayLayout::GetMaxBytes()
+{
+	// 像素数组按 int32 索引
+	return FMath::Min<int64>(int64(FMath::Max(CVarAnimTextureFrameArrayMaxMB.GetValueOnAnyThread(), 1)) * 1024 * 1024, MAX_int32);
+}
+
+FAnimatedTextureFrameArrayLayout FAnimatedTextureFrameArrayLayout::Plan(const FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay, int32 MaxSlices)
+{
+	FAnimatedTextureFrameArrayLayout Layout;
+	Layout.Width = Decoder.GetWidth();
+	Layout.Height = Decoder.GetHeight();
+
+	// 所有切片同时驻留在 CPU 内存中（合成、烘焙压缩），按字节预算限制切片数
+	const int64 SliceBytes = int64(Layout.Width) * Layout.Height * sizeof(FColor);
+	const int64 MaxBytes = GetMaxBytes();
+	if (SliceBytes <= 0 || SliceBytes > MaxBytes)
+		return Layout;
+	MaxSlices = static_cast<int32>(FMath::Min<int64>(MaxSlices, MaxBytes / SliceBytes));
+
+	const uint32 NumFrames = Decoder.GetNumFrames();
+	const uint32 Duration = Decoder.GetDuration(DefaultFrameDelay);
+	if (NumFrames == 0 || Duration == 0)
+	{
+		Layout.NumSlices = 1;
+		Layout.SliceDuration = FMath::Max(Duration, 1u);
+		Layout.Duration = Layout.SliceDuration;
+		return Layout;
+	}
+
+	uint32 SliceDuration = 0;
+	for (uint32 i = 0; i < NumFrames; i++)
+	{
+		SliceDuration = GreatestCommonDivisor(SliceDuration, Decoder.GetFrameDelay(i, DefaultFrameDelay));
+	}
+	SliceDuration = FMath::Max(SliceDuration, 1u);
+
+	const uint32 MaxSliceCount = static_cast<uint32>(FMath::Max(MaxSlices, 1));
+	if (FMath::DivideAndRoundUp(Duration, SliceDuration) > MaxSliceCount)
+	{
+		SliceDuration = FMath::DivideAndRoundUp(Duration, MaxSliceCount);
+	}
+
+	Layout.SliceDuration = SliceDuration;
+	Layout.NumSlices = FMath::DivideAndRoundUp(Duration, SliceDuration);
+	Layout.Duration = Layout.NumSlices * SliceDuration;
+	return Layout;
+}
+
+void FAnimatedTextureFrameArray::Build(FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay)
+{
+	const int32 SliceSize = Layout.Width * Layout.Height;
+	if (SliceSize <= 0 || Layout.NumSlices <= 0)
+	{
+		Pixels.Empty();
+		return;
+	}
+	Pixels.SetNumZeroed(SliceSize * Layout.NumSlices);
+
+	Decoder.Reset();
+
+	// 依次解码每一帧，落在 [FrameStart, FrameEnd) 内的切片都拷贝这一帧的画布
+	const uint32 NumFrames = Decoder.GetNumFrames();
+	uint32 FrameStart = 0;
+	int32 Slice = 0;
+	const FColor* Canvas = nullptr;
+	for (uint32 Frame = 0; Frame < NumFrames && Slice < Layout.NumSlices; Frame++)
+	{
+		const uint32 FrameEnd = FrameStart + Decoder.NextFrame(DefaultFrameDelay, false);
+		Canvas = Decoder.GetFrameBuffer();
+
+		for (; Slice < Layout.NumSlices && Slice * Layout.SliceDuration < FrameEnd; Slice++)
+		{
+			if (Canvas)
+				FMemory::Memcpy(Pixels.GetData() + Slice * SliceSize, Canvas, SliceSize * sizeof(FColor));
+		}
+		FrameStart = FrameEnd;
+	}
+
+	// 取整误差留下的切片沿用最后一帧
+	for (; Slice < Layout.NumSlices && Canvas; Slice++)
+	{
+		FMemory::Memcpy(Pixels.GetData() + Slice * SliceSize, Canvas, SliceSize * sizeof(FColor));
+	}
+}
+
+void EnqueueAnimatedTextureFrameArrayUpload(FTextureResource* Resource, TSharedPtr<FAnimatedTextureFrameArray, ESPMode::ThreadSafe> FrameArray)
+{
+	check(IsInGameThread());
+	if (!Resource || !FrameArray)
+		return;
+
+	ENQUEUE_RENDER_COMMAND(AnimTexture2D_UploadFrameArray)(
+		[Resource, FrameArray](FRHICommandListImmediate& RHICmdList)
+		{
+			if (!Resource->TextureRHI)
+				return;
+
+			const FAnimatedTextureFrameArrayLayout& Layout = FrameArray->Layout;
+			const uint32 Pitch = Layout.Width * sizeof(FColor);
+			const int32 SliceSize = Layout.Width * Layout.Height;
+			for (int32 Slice = 0; Slice < Layout.NumSlices; Slice++)
+			{
+				const uint8* SrcData = reinterpret_cast<const uint8*>(FrameArray->Pixels.GetData() + Slice * SliceSize);
+				AnimatedTextureCompat::AT_UpdateTexture2DArraySlice(RHICmdList, Resource->TextureRHI, Slice, Pitch, Layout.Height, SrcData);
+			}
+		});
+}
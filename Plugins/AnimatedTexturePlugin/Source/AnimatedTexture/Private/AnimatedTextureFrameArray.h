@@ -0,0 +1,55 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * GPU frame-array playback for UAnimatedTexture2D
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAnimatedTextureDecoder;
+class FTextureResource;
+
+/**
+ * 帧数组播放模式：所有帧一次性合成到 Texture2DArray 的各个切片中，由材质按时间选择切片
+ *
+ * GIF/WebP 的帧延迟长短不一，而材质里只能做简单的算术，所以按固定的时间间隔（SliceDuration）重采样：
+ * 第 i 个切片保存 i * SliceDuration 时刻正在显示的帧，材质中 Slice = floor(frac(Time / Length) * NumSlices)。
+ * SliceDuration 取所有帧延迟的最大公约数，帧延迟一致的动画切片与帧一一对应；
+ * 切片数超过上限时加大 SliceDuration，过短的帧可能被跳过。
+ */
+struct FAnimatedTextureFrameArrayLayout
+{
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 NumSlices = 0;	// 0：一个切片也放不进 AnimatedTexture.FrameArrayMaxMB
+	uint32 SliceDuration = 0;	// milliseconds
+	uint32 Duration = 0;		// milliseconds, NumSlices * SliceDuration
+
+	/**
+	 * 只读取解码器的帧索引，不解码任何帧；
+	 * 切片数同时受 MaxSlices 与 AnimatedTexture.FrameArrayMaxMB（合成时的 BGRA 内存）限制
+	 */
+	static FAnimatedTextureFrameArrayLayout Plan(const FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay, int32 MaxSlices);
+
+	/** AnimatedTexture.FrameArrayMaxMB 当前生效的合成预算（字节），Plan 按它限制切片数 */
+	static int64 GetMaxBytes();
+};
+
+/** 合成好的全部切片，BGRA，按切片连续存放 */
+struct FAnimatedTextureFrameArray
+{
+	FAnimatedTextureFrameArrayLayout Layout;
+	TArray<FColor> Pixels;
+
+	/** 工作线程：从头解码所有帧并按 Layout 重采样到 Pixels；Layout 没有切片时 Pixels 为空 */
+	void Build(FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay);
+};
+
+/** GameThread：把合成好的切片上传到 Resource 的 Texture2DArray，上传完成后释放像素内存 */
+void EnqueueAnimatedTextureFrameArrayUpload(FTextureResource* Resource, TSharedPtr<FAnimatedTextureFrameArray, ESPMode::ThreadSafe> FrameArray);
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Playback parameters of FrameArray animated textures
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureFrameArrayTiming.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureCompat.h"
+#include "AnimatedTextureResource.h"
+
+/**
+ * 播放参数纹理的资源：内容随创建描述一起提交，之后不再改变（参数改变时重建资源）
+ */
+class FAnimatedTextureFrameArrayTimingResource : public FTextureResource
+{
+public:
+	FAnimatedTextureFrameArrayTimingResource(UAnimatedTextureFrameArrayTiming* InOwner, const FVector4f& InValue)
+		: Owner(InOwner)
+		, Value(InValue)
+		, Name(InOwner->GetFName())
+	{
+	}
+
+	virtual uint32 GetSizeX() const override { return 1; }
+	virtual uint32 GetSizeY() const override { return 1; }
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+	{
+		const FSamplerStateInitializerRHI SamplerStateInitializer(SF_Point, AM_Clamp, AM_Clamp, AM_Clamp);
+		SamplerStateRHI = GetOrCreateSamplerState(SamplerStateInitializer);
+		bIgnoreGammaConversions = true;
+
+		FAnimatedTextureInitialData InitialData;
+		InitialData.Data.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+
+		TextureRHI = AnimatedTextureCompat::AT_CreateTexture2D(RHICmdList, *Name.ToString(), 1, 1, PF_A32B32G32R32F, TexCreate_None, &InitialData);
+		TextureRHI->SetName(Name);
+		AnimatedTextureCompat::AT_UpdateTextureReference(Owner->TextureReference.TextureReferenceRHI, TextureRHI);
+	}
+
+	virtual void ReleaseRHI() override
+	{
+		AnimatedTextureCompat::AT_UpdateTextureReference(Owner->TextureReference.TextureReferenceRHI, nullptr);
+		FTextureResource::ReleaseRHI();
+	}
+
+private:
+	UAnimatedTextureFrameArrayTiming* Owner;
+	FVector4f Value;
+	FName Name;
+};
+
+UAnimatedTextureFrameArrayTiming::UAnimatedTextureFrameArrayTiming(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// 数值纹理：线性、点采样
+	SRGB = false;
+	Filter = TF_Nearest;
+	CompressionSettings = TC_HDR;
+	NeverStream = true;
+}
+
+void UAnimatedTextureFrameArrayTiming::SetTiming(float PlayRate, int32 NumSlices, float Length)
+{
+	const FVector4f NewValue = Length > 0.0f && NumSlices > 0
+		? FVector4f(PlayRate / Length, 1.0f / Length, static_cast<float>(NumSlices), 0.0f)
+		: FVector4f(0, 0, 0, 0);
+
+	if (NewValue == Value && GetResource())
+		return;
+
+	Value = NewValue;
+	UpdateResource();
+}
+
+FTextureResource* UAnimatedTextureFrameArrayTiming::CreateResource()
+{
+	return new FAnimatedTextureFrameArrayTimingResource(this, Value);
+}
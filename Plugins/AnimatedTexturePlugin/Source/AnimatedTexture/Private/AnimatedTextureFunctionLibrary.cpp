@@ -10,15 +10,55 @@
 
 #include "AnimatedTextureFunctionLibrary.h"
 #include "AnimatedTextureModule.h"
+#include "AnimatedTextureFrameArrayTiming.h"
+#include "AnimatedTexturePalette.h"
 
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
 #include "UObject/Package.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+/**
+ * 把整个文件映射到内存：页面由操作系统按需读入，并且随时可以丢弃后从文件重新读入，不占用私有内存。
+ * 平台或文件（例如 Pak 里的文件）不支持映射时返回空的 Buffer。
+ */
+static FSharedBuffer MapAnimatedTextureFile(const FString& Path)
+{
+	IMappedFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path);
+	if (!Handle)
+		return FSharedBuffer();
+
+	IMappedFileRegion* Region = Handle->GetFileSize() > 0 ? Handle->MapRegion(0, Handle->GetFileSize()) : nullptr;
+	if (!Region)
+	{
+		delete Handle;
+		return FSharedBuffer();
+	}
+
+	// Region 必须先于 Handle 释放
+	return FSharedBuffer::TakeOwnership(Region->GetMappedPtr(), Region->GetMappedSize(),
+		[Handle, Region](void*)
+		{
+			delete Region;
+			delete Handle;
+		});
+}
 
 bool UAnimatedTextureFunctionLibrary::InitAnimatedTextureFromMemory(
 	UAnimatedTexture2D* Target, const uint8* Buffer, int32 BufferSize, EAnimatedTextureType Type)
 {
+	return InitAnimatedTextureFromBuffer(Target, FSharedBuffer::MakeView(Buffer, FMath::Max(BufferSize, 0)), Type);
+}
+
+bool UAnimatedTextureFunctionLibrary::InitAnimatedTextureFromBuffer(
+	UAnimatedTexture2D* Target, const FSharedBuffer& InBuffer, EAnimatedTextureType Type)
+{
+	const uint8* Buffer = static_cast<const uint8*>(InBuffer.GetData());
+	const int32 BufferSize = int32(FMath::Min<uint64>(InBuffer.GetSize(), MAX_int32));
+
 	if (!Target)
 	{
 		UE_LOG(LogAnimTexture, Error, TEXT("InitAnimatedTextureFromMemory: Target is null."));
@@ -45,12 +85,25 @@ bool UAnimatedTextureFunctionLibrary::InitAnimatedTextureFromMemory(
 		return false;
 	}
 
-	Target->ImportFile(ResolvedType, Buffer, static_cast<uint32>(BufferSize));
+	Target->ImportFile(ResolvedType, InBuffer);
 	return true;
 }
 
 UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromMemory(
 	const TArray<uint8>& Bytes, EAnimatedTextureType Type, UObject* Outer, FName Name)
+{
+	// 只是视图：内容第一次登记时共享源拷贝一份
+	return LoadAnimatedTextureFromBuffer(FSharedBuffer::MakeView(Bytes.GetData(), Bytes.Num()), Type, Outer, Name);
+}
+
+UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromMemory(
+	TArray<uint8>&& Bytes, EAnimatedTextureType Type, UObject* Outer, FName Name)
+{
+	return LoadAnimatedTextureFromBuffer(MakeSharedBufferFromArray(MoveTemp(Bytes)), Type, Outer, Name);
+}
+
+UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromBuffer(
+	const FSharedBuffer& Buffer, EAnimatedTextureType Type, UObject* Outer, FName Name)
 {
 	if (!IsInGameThread())
 	{
@@ -59,7 +112,7 @@ UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromMemo
 		return nullptr;
 	}
 
-	if (Bytes.Num() <= 0)
+	if (Buffer.GetSize() == 0)
 	{
 		UE_LOG(LogAnimTexture, Warning, TEXT("LoadAnimatedTextureFromMemory: Bytes is empty."));
 		return nullptr;
@@ -74,7 +127,7 @@ UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromMemo
 		return nullptr;
 	}
 
-	const bool bOk = InitAnimatedTextureFromMemory(NewTexture, Bytes.GetData(), Bytes.Num(), Type);
+	const bool bOk = InitAnimatedTextureFromBuffer(NewTexture, Buffer, Type);
 	if (!bOk)
 	{
 		// 让刚创建的对象在本帧末被 GC 回收（没有任何强引用）。
@@ -132,25 +185,36 @@ UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromFile
 		return nullptr;
 	}
 
-	TArray<uint8> Bytes;
-	if (!FFileHelper::LoadFileToArray(Bytes, *ResolvedPath))
+	// 优先内存映射；不支持时整读进一个数组，再把数组交给纹理，不再拷贝
+	FSharedBuffer Bytes = MapAnimatedTextureFile(ResolvedPath);
+	if (Bytes.IsNull())
 	{
-		UE_LOG(LogAnimTexture, Warning,
-			TEXT("LoadAnimatedTextureFromFile: LoadFileToArray failed for %s"), *ResolvedPath);
-		OutError = EAnimatedTextureLoadError::FileNotFound;
-		return nullptr;
+		TArray<uint8> FileBytes;
+		if (!FFileHelper::LoadFileToArray(FileBytes, *ResolvedPath))
+		{
+			UE_LOG(LogAnimTexture, Warning,
+				TEXT("LoadAnimatedTextureFromFile: LoadFileToArray failed for %s"), *ResolvedPath);
+			OutError = EAnimatedTextureLoadError::FileNotFound;
+			return nullptr;
+		}
+		Bytes = MakeSharedBufferFromArray(MoveTemp(FileBytes));
 	}
 
-	if (Bytes.Num() <= 0)
+	if (Bytes.GetSize() == 0)
 	{
 		OutError = EAnimatedTextureLoadError::EmptyBody;
 		return nullptr;
 	}
+	if (Bytes.GetSize() > MAX_int32)
+	{
+		OutError = EAnimatedTextureLoadError::SizeLimitExceeded;
+		return nullptr;
+	}
 
 	// 优先用扩展名推断类型；若扩展名无法识别，交给 LoadAnimatedTextureFromMemory 内部按 magic bytes 嗅探。
 	const EAnimatedTextureType TypeByExt = UAnimatedTexture2D::DetectTypeFromExtension(ResolvedPath);
 
-	UAnimatedTexture2D* Texture = LoadAnimatedTextureFromMemory(Bytes, TypeByExt, /*Outer=*/ nullptr, NAME_None);
+	UAnimatedTexture2D* Texture = LoadAnimatedTextureFromBuffer(Bytes, TypeByExt, /*Outer=*/ nullptr, NAME_None);
 	if (!Texture)
 	{
 		OutError = EAnimatedTextureLoadError::DecodeFailed;
@@ -159,3 +223,39 @@ UAnimatedTexture2D* UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromFile
 
 	return Texture;
 }
+
+void UAnimatedTextureFunctionLibrary::SetAnimatedTextureParameterValue(
+	UMaterialInstanceDynamic* Material, FName ParameterName, UAnimatedTexture2D* Texture)
+{
+	if (!Material)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("SetAnimatedTextureParameterValue: Material is null."));
+		return;
+	}
+
+	Material->SetTextureParameterValue(ParameterName, Texture);
+
+	TArray<TPair<FName, UTexture*>> Companions;
+	GetCompanionTextureParameters(Texture, ParameterName, Companions);
+	for (const TPair<FName, UTexture*>& Companion : Companions)
+	{
+		Material->SetTextureParameterValue(Companion.Key, Companion.Value);
+	}
+}
+
+void UAnimatedTextureFunctionLibrary::GetCompanionTextureParameters(
+	const UAnimatedTexture2D* Texture, FName ParameterName, TArray<TPair<FName, UTexture*>>& OutParameters)
+{
+	if (!Texture || ParameterName.IsNone())
+		return;
+
+	// 名字与 MtlExpTextureSampleParameterAnimArray / MtlExpTextureSampleParameterAnimIndexed 的 Compile 里声明的参数一致
+	if (Texture->IsFrameArrayMode() && Texture->GetFrameArrayTiming())
+	{
+		OutParameters.Emplace(FName(*(ParameterName.ToString() + TEXT("Timing"))), Texture->GetFrameArrayTiming());
+	}
+	if (Texture->IsPaletteIndexed() && Texture->GetPaletteTexture())
+	{
+		OutParameters.Emplace(FName(*(ParameterName.ToString() + TEXT("Palette"))), Texture->GetPaletteTexture());
+	}
+}
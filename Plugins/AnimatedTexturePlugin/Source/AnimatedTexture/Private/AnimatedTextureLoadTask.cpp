@@ -0,0 +1,255 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Staged, cancellable runtime-load pipeline used by the async load nodes
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureLoadTask.h"
+#include "AnimatedTextureSharedSource.h"
+#include "AnimatedTextureDecoder.h"
+#include "AnimatedTextureModule.h"
+
+#include "RHI.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+// 文件按块读取，块之间检查取消
+static constexpr int64 AnimTextureLoadChunkSize = 1024 * 1024;
+
+static ENamedThreads::Type GetLoadStageThread(EAnimatedTextureLoadPriority Priority)
+{
+	switch (Priority)
+	{
+	case EAnimatedTextureLoadPriority::Low:
+		return ENamedThreads::AnyBackgroundThreadNormalTask;
+	case EAnimatedTextureLoadPriority::High:
+		return ENamedThreads::AnyHiPriThreadNormalTask;
+	default:
+		return ENamedThreads::AnyBackgroundHiPriTask;
+	}
+}
+
+FAnimatedTextureLoadTask::FAnimatedTextureLoadTask(EAnimatedTextureLoadPriority InPriority)
+	: StageThread(GetLoadStageThread(InPriority))
+{
+}
+
+TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> FAnimatedTextureLoadTask::LoadFile(
+	const FString& InFilePath, EAnimatedTextureLoadPriority Priority, FOnFinished InOnFinished)
+{
+	TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> Task = MakeShareable(new FAnimatedTextureLoadTask(Priority));
+	Task->OnFinished = MoveTemp(InOnFinished);
+	Task->FilePath = InFilePath;
+	Task->RunStage(&FAnimatedTextureLoadTask::ReadFileStage);
+	return Task;
+}
+
+TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> FAnimatedTextureLoadTask::LoadMemory(
+	FSharedBuffer InBytes, EAnimatedTextureType InTypeHint, EAnimatedTextureLoadPriority Priority, FOnFinished InOnFinished)
+{
+	TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> Task = MakeShareable(new FAnimatedTextureLoadTask(Priority));
+	Task->OnFinished = MoveTemp(InOnFinished);
+	Task->Bytes = MoveTemp(InBytes);
+	Task->TypeHint = InTypeHint;
+	Task->RunStage(&FAnimatedTextureLoadTask::ParseStage);
+	return Task;
+}
+
+TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> FAnimatedTextureLoadTask::Prepare(
+	FSharedBuffer InBytes, EAnimatedTextureType InType, EAnimatedTextureLoadPriority Priority, FOnPrepared InOnPrepared)
+{
+	TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> Task = MakeShareable(new FAnimatedTextureLoadTask(Priority));
+	Task->OnPrepared = MoveTemp(InOnPrepared);
+	Task->Bytes = MoveTemp(InBytes);
+	Task->TypeHint = InType;
+	Task->RunStage(&FAnimatedTextureLoadTask::ParseStage);
+	return Task;
+}
+
+void FAnimatedTextureLoadTask::RunStage(void (FAnimatedTextureLoadTask::*Stage)())
+{
+	// 任务持有自身的引用，调用方释放 TSharedRef 不影响执行中的阶段
+	AsyncTask(StageThread, [Task = AsShared(), Stage]()
+		{
+			if (!Task->IsCanceled())
+				((*Task).*Stage)();
+		});
+}
+
+void FAnimatedTextureLoadTask::ReadFileStage()
+{
+	FString ResolvedPath = FilePath;
+	if (FPaths::IsRelative(ResolvedPath))
+	{
+		ResolvedPath = FPaths::Combine(FPaths::ProjectDir(), ResolvedPath);
+	}
+	FPaths::NormalizeFilename(ResolvedPath);
+
+	TUniquePtr<FArchive> Reader;
+	if (!ResolvedPath.IsEmpty())
+		Reader.Reset(IFileManager::Get().CreateFileReader(*ResolvedPath));
+
+	const int64 FileSize = Reader ? Reader->TotalSize() : 0;
+	if (FileSize <= 0)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("FAnimatedTextureLoadTask: file not found or empty: %s"), *ResolvedPath);
+		Finish(EAnimatedTextureLoadError::FileNotFound);
+		return;
+	}
+	if (FileSize > MAX_int32)
+	{
+		Finish(EAnimatedTextureLoadError::SizeLimitExceeded);
+		return;
+	}
+
+	TArray<uint8> FileBytes;
+	FileBytes.SetNumUninitialized(int32(FileSize));
+	for (int64 Offset = 0; Offset < FileSize; Offset += AnimTextureLoadChunkSize)
+	{
+		if (IsCanceled())
+			return;
+		Reader->Serialize(FileBytes.GetData() + Offset, FMath::Min(AnimTextureLoadChunkSize, FileSize - Offset));
+	}
+
+	if (!Reader->Close() || Reader->IsError())
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("FAnimatedTextureLoadTask: failed to read %s"), *ResolvedPath);
+		Finish(EAnimatedTextureLoadError::FileNotFound);
+		return;
+	}
+
+	// 数组整体交给共享源，之后不再拷贝
+	Bytes = MakeSharedBufferFromArray(MoveTemp(FileBytes));
+
+	// 优先用扩展名推断类型；无法识别时由解析阶段按 magic bytes 嗅探
+	TypeHint = UAnimatedTexture2D::DetectTypeFromExtension(ResolvedPath);
+	RunStage(&FAnimatedTextureLoadTask::ParseStage);
+}
+
+void FAnimatedTextureLoadTask::ParseStage()
+{
+	const uint8* Data = static_cast<const uint8*>(Bytes.GetData());
+	const int32 Size = int32(FMath::Min<uint64>(Bytes.GetSize(), MAX_int32));
+	if (Size <= 0)
+	{
+		Finish(EAnimatedTextureLoadError::EmptyBody);
+		return;
+	}
+
+	Prepared.Type = TypeHint != EAnimatedTextureType::None
+		? TypeHint : UAnimatedTexture2D::DetectTypeFromMagic(Data, Size);
+	if (Prepared.Type == EAnimatedTextureType::None)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("FAnimatedTextureLoadTask: cannot detect animated texture type from bytes (size=%d)."), Size);
+		Finish(EAnimatedTextureLoadError::InvalidFormat);
+		return;
+	}
+
+	// 解析容器并登记共享源（接管 Bytes）；同样内容已经登记过时直接复用，不再解析
+	Prepared.Source = FAnimatedTextureSharedSource::FindOrCreate(Prepared.Type, Bytes);
+	if (!Prepared.Source)
+	{
+		Finish(EAnimatedTextureLoadError::DecodeFailed);
+		return;
+	}
+
+	// 编辑器进程保存资源需要 FileBlob，游戏进程里数据只在共享源中保留一份
+	if (GIsEditor)
+		Prepared.FileBlob = TArray<uint8>(Data, Size);
+	Bytes.Reset();
+
+	// 元数据校验：画布必须能创建成 RHI 纹理
+	const uint32 MaxDimension = GetMax2DTextureDimension();
+	const FAnimatedTextureSharedSource& Source = *Prepared.Source;
+	if (Source.GetWidth() == 0 || Source.GetHeight() == 0 || Source.GetNumFrames() == 0)
+	{
+		Finish(EAnimatedTextureLoadError::DecodeFailed);
+		return;
+	}
+	if (Source.GetWidth() > MaxDimension || Source.GetHeight() > MaxDimension)
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("FAnimatedTextureLoadTask: canvas %ux%u exceeds the maximum texture size %u."),
+			Source.GetWidth(), Source.GetHeight(), MaxDimension);
+		Finish(EAnimatedTextureLoadError::SizeLimitExceeded);
+		return;
+	}
+
+	RunStage(&FAnimatedTextureLoadTask::DecodeFirstFrameStage);
+}
+
+void FAnimatedTextureLoadTask::DecodeFirstFrameStage()
+{
+	// 纹理创建后第一帧立即到期：提前解码好，GameThread 上的第一次 Tick 只需要拷贝和上传
+	Prepared.Decoder = Prepared.Source->CreateDecoder();
+	if (!Prepared.Decoder)
+	{
+		Finish(EAnimatedTextureLoadError::DecodeFailed);
+		return;
+	}
+
+	Prepared.Decoder->NextFrame(100, true);
+	if (!Prepared.Decoder->GetFrameBuffer())
+	{
+		Finish(EAnimatedTextureLoadError::DecodeFailed);
+		return;
+	}
+
+	Finish(EAnimatedTextureLoadError::None);
+}
+
+void FAnimatedTextureLoadTask::Finish(EAnimatedTextureLoadError Error)
+{
+	AsyncTask(ENamedThreads::GameThread, [Task = AsShared(), Error]()
+		{
+			if (Task->IsCanceled())
+				return;
+
+			if (Task->OnPrepared.IsBound())
+			{
+				Task->OnPrepared.Execute(Task->Prepared, Error);
+				Task->Prepared = FAnimatedTexturePreparedLoad();
+				return;
+			}
+
+			UAnimatedTexture2D* Texture = nullptr;
+			EAnimatedTextureLoadError Result = Error;
+			if (Result == EAnimatedTextureLoadError::None)
+			{
+				Texture = CreateTexture(Task->Prepared);
+				if (!Texture)
+					Result = EAnimatedTextureLoadError::DecodeFailed;
+			}
+			Task->Prepared = FAnimatedTexturePreparedLoad();
+
+			Task->OnFinished.ExecuteIfBound(Texture, Result);
+		});
+}
+
+UAnimatedTexture2D* FAnimatedTextureLoadTask::CreateTexture(FAnimatedTexturePreparedLoad& InPrepared)
+{
+	check(IsInGameThread());
+
+	UAnimatedTexture2D* NewTexture = NewObject<UAnimatedTexture2D>(GetTransientPackage(), NAME_None);
+	if (!NewTexture)
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("FAnimatedTextureLoadTask: NewObject failed."));
+		return nullptr;
+	}
+
+	// CreateResource 直接使用交接过来的解码器，不再解析或解码
+	NewTexture->ImportPrepared(InPrepared);
+	NewTexture->UpdateResource();
+
+	if (NewTexture->GetResource() == nullptr)
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("FAnimatedTextureLoadTask: UpdateResource produced no FTextureResource."));
+		return nullptr;
+	}
+	return NewTexture;
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Staged, cancellable runtime-load pipeline used by the async load nodes
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Memory/SharedBuffer.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureLoadTypes.h"
+#include <atomic>
+
+class FAnimatedTextureDecoder;
+class FAnimatedTextureSharedSource;
+
+/** 在后台线程上准备好、交给 GameThread 创建纹理的加载结果 */
+struct FAnimatedTexturePreparedLoad
+{
+	EAnimatedTextureType Type = EAnimatedTextureType::None;
+
+	/** 已解析、已登记的共享源 */
+	TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> Source;
+
+	/** 已经解码出第 0 帧的解码器，纹理直接用它开始播放 */
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Decoder;
+
+	/** 只有编辑器进程保留（保存资源需要），游戏进程里文件数据只在共享源中保留一份 */
+	TArray<uint8> FileBlob;
+};
+
+/**
+ * 运行时异步加载管线，每个阶段是一个独立的后台任务，按 Priority 调度：
+ *
+ *   文件 IO（按块读取） -> 类型识别与容器解析 -> 元数据校验 -> 第一帧解码   （后台线程）
+ *   -> NewObject、交接解码器、UpdateResource                                （GameThread）
+ *
+ * - GameThread 上不再拷贝文件数据、解析容器或解码，只创建对象与 RHI 资源；
+ * - Cancel() 之后不再启动新的阶段，文件读取在块之间检查取消，正在执行的阶段结束后直接丢弃结果；
+ * - 完成回调只在 GameThread 上触发，取消之后不会再触发。
+ */
+class FAnimatedTextureLoadTask : public TSharedFromThis<FAnimatedTextureLoadTask, ESPMode::ThreadSafe>
+{
+public:
+	/** GameThread：成功时 Texture 非空且 Error 为 None */
+	DECLARE_DELEGATE_TwoParams(FOnFinished, UAnimatedTexture2D* /*Texture*/, EAnimatedTextureLoadError /*Error*/);
+
+	/** GameThread：只准备、不创建纹理；成功时由回调取走 Prepared 中的共享源与解码器 */
+	DECLARE_DELEGATE_TwoParams(FOnPrepared, FAnimatedTexturePreparedLoad& /*Prepared*/, EAnimatedTextureLoadError /*Error*/);
+
+	/** 从本地文件加载；相对路径相对于 FPaths::ProjectDir()，类型优先按扩展名判断 */
+	static TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> LoadFile(
+		const FString& FilePath, EAnimatedTextureLoadPriority Priority, FOnFinished OnFinished);
+
+	/**
+	 * 从内存加载（例如 HTTP 响应体）；TypeHint 为 None 时按 magic bytes 识别。
+	 * Buffer 自己持有内存时（MakeSharedBufferFromArray）由共享源直接接管，不拷贝
+	 */
+	static TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> LoadMemory(
+		FSharedBuffer Buffer, EAnimatedTextureType TypeHint, EAnimatedTextureLoadPriority Priority, FOnFinished OnFinished);
+
+	/**
+	 * 为已有的纹理准备解码器（例如资源的 bulk data 异步读入之后），跳过 NewObject 与 UpdateResource，
+	 * 由调用方把结果交给自己的纹理
+	 */
+	static TSharedRef<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> Prepare(
+		FSharedBuffer Buffer, EAnimatedTextureType Type, EAnimatedTextureLoadPriority Priority, FOnPrepared OnPrepared);
+
+	/** 任意线程：中止加载，之后不会再触发 OnFinished */
+	void Cancel() { bCanceled.store(true, std::memory_order_relaxed); }
+
+	bool IsCanceled() const { return bCanceled.load(std::memory_order_relaxed); }
+
+	/** GameThread：用准备好的结果创建瞬态纹理并创建资源，失败时返回 nullptr */
+	static UAnimatedTexture2D* CreateTexture(FAnimatedTexturePreparedLoad& Prepared);
+
+private:
+	explicit FAnimatedTextureLoadTask(EAnimatedTextureLoadPriority InPriority);
+
+	/** 在 Priority 对应的后台线程上执行下一个阶段；已取消时不再执行 */
+	void RunStage(void (FAnimatedTextureLoadTask::*Stage)());
+
+	void ReadFileStage();
+	void ParseStage();
+	void DecodeFirstFrameStage();
+
+	/** 回到 GameThread 创建纹理（Error 为 None 且没有绑定 OnPrepared 时）并触发回调 */
+	void Finish(EAnimatedTextureLoadError Error);
+
+private:
+	ENamedThreads::Type StageThread;
+	FOnFinished OnFinished;
+	FOnPrepared OnPrepared;
+	std::atomic<bool> bCanceled{ false };
+
+	FString FilePath;
+	FSharedBuffer Bytes;
+	EAnimatedTextureType TypeHint = EAnimatedTextureType::None;
+
+	FAnimatedTexturePreparedLoad Prepared;
+};
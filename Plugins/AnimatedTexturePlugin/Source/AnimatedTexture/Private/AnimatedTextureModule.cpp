@@ -9,21 +9,33 @@
 */
 
 #include "AnimatedTextureModule.h"
+#include "AnimatedTextureResource.h"
+#include "AnimatedTextureStats.h"
+#include "WebpWorker.h"
 
 #define LOCTEXT_NAMESPACE "FAnimatedTextureModule"
 
 void FAnimatedTextureModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	InstallWebpWorkerInterface();
 }
 
 void FAnimatedTextureModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FlushAnimatedTextureFrameUpdatePool();
 }
 
 #undef LOCTEXT_NAMESPACE
 	
 DEFINE_LOG_CATEGORY(LogAnimTexture);
+
+DEFINE_STAT(STAT_AnimTexture_StagingMemory);
+DEFINE_STAT(STAT_AnimTexture_StagingBuffers);
+DEFINE_STAT(STAT_AnimTexture_StagingStalls);
+DEFINE_STAT(STAT_AnimTexture_SharedFrameMemory);
+DEFINE_STAT(STAT_AnimTexture_DecodeStateMemory);
+DEFINE_STAT(STAT_AnimTexture_EvictedTextures);
 IMPLEMENT_MODULE(FAnimatedTextureModule, AnimatedTexture)
\ No newline at end of file
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Palette texture for palette-indexed animated textures
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTexturePalette.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureCompat.h"
+#include "AnimatedTextureResource.h"
+
+#include "TextureResource.h"	// Engine
+
+/**
+ * 调色板纹理的资源：颜色随创建描述一起提交，之后不再改变（颜色改变时重建资源）
+ */
+class FAnimatedTexturePaletteResource : public FTextureResource
+{
+public:
+	FAnimatedTexturePaletteResource(UAnimatedTexturePalette* InOwner, const TArray<FColor>& InColors)
+		: Owner(InOwner)
+		, Colors(InColors)
+		, bSRGB(InOwner->SRGB)
+		, Name(InOwner->GetFName())
+	{
+	}
+
+	virtual uint32 GetSizeX() const override { return UAnimatedTexturePalette::NumColors; }
+	virtual uint32 GetSizeY() const override { return 1; }
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+	{
+		// 索引已经是点采样得到的，相邻的调色板项之间不能插值
+		const FSamplerStateInitializerRHI SamplerStateInitializer(SF_Point, AM_Clamp, AM_Clamp, AM_Clamp);
+		SamplerStateRHI = GetOrCreateSamplerState(SamplerStateInitializer);
+
+		ETextureCreateFlags Flags = TexCreate_None;
+		if (bSRGB)
+			Flags |= TexCreate_SRGB;
+		else
+			bIgnoreGammaConversions = true;
+
+		FAnimatedTextureInitialData InitialData;
+		InitialData.Data.Append(reinterpret_cast<const uint8*>(Colors.GetData()), Colors.Num() * sizeof(FColor));
+		Colors.Empty();
+
+		TextureRHI = AnimatedTextureCompat::AT_CreateTexture2D(RHICmdList, *Name.ToString(), GetSizeX(), GetSizeY(), PF_B8G8R8A8, Flags, &InitialData);
+		TextureRHI->SetName(Name);
+		AnimatedTextureCompat::AT_UpdateTextureReference(Owner->TextureReference.TextureReferenceRHI, TextureRHI);
+	}
+
+	virtual void ReleaseRHI() override
+	{
+		AnimatedTextureCompat::AT_UpdateTextureReference(Owner->TextureReference.TextureReferenceRHI, nullptr);
+		FTextureResource::ReleaseRHI();
+	}
+
+private:
+	UAnimatedTexturePalette* Owner;
+	TArray<FColor> Colors;
+	bool bSRGB;
+	FName Name;
+};
+
+UAnimatedTexturePalette::UAnimatedTexturePalette(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Filter = TF_Nearest;
+	NeverStream = true;
+}
+
+void UAnimatedTexturePalette::SetColors(const FColor* InColors)
+{
+	check(InColors);
+
+	// 与所属纹理的 sRGB 设置一致，BGRA 上传时颜色也按它解释
+	const bool bOwnerSRGB = GetOuterUAnimatedTexture2D()->SRGB;
+	if (Colors.Num() == NumColors && SRGB == bOwnerSRGB
+		&& FMemory::Memcmp(Colors.GetData(), InColors, NumColors * sizeof(FColor)) == 0)
+	{
+		if (!GetResource())
+			UpdateResource();
+		return;
+	}
+
+	SRGB = bOwnerSRGB;
+	Colors = TArray<FColor>(InColors, NumColors);
+	UpdateResource();
+}
+
+FTextureResource* UAnimatedTexturePalette::CreateResource()
+{
+	if (Colors.Num() != NumColors)
+		return nullptr;
+	return new FAnimatedTexturePaletteResource(this, Colors);
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * BGRA8 to 16-bit upload format conversion
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTexturePixelPacker.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#include <arm_neon.h>
+	#define AT_PACK_KERNEL_NEON 1
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+	#include <emmintrin.h>
+	#define AT_PACK_KERNEL_SSE2 1
+#endif
+
+#ifndef AT_PACK_KERNEL_NEON
+	#define AT_PACK_KERNEL_NEON 0
+#endif
+#ifndef AT_PACK_KERNEL_SSE2
+	#define AT_PACK_KERNEL_SSE2 0
+#endif
+
+// 4x4 Bayer 矩阵
+static const uint8 GBayer4x4[4][4] =
+{
+	{  0,  8,  2, 10 },
+	{ 12,  4, 14,  6 },
+	{  3, 11,  1,  9 },
+	{ 15,  7, 13,  5 }
+};
+
+// 量化：q = (v * Levels + Threshold) / 255，v 为 8 位分量，Threshold 在 [0, 255) 之间。
+// Levels 最大 63，被除数最大 255 * 63 + 254 < 65535，除以 255 可以换成 (x + 1 + (x >> 8)) >> 8，16 位无符号整数即可完成
+static constexpr uint16 NoDitherThreshold = 127;	// 四舍五入
+
+static FORCEINLINE uint16 QuantizeScalar(uint8 v, uint16 Levels, uint16 Threshold)
+{
+	const uint32 x = v * Levels + Threshold;
+	return static_cast<uint16>((x + 1 + (x >> 8)) >> 8);
+}
+
+FAnimatedTexturePixelPacker::FAnimatedTexturePixelPacker(EPixelFormat InFormat, bool bInDither)
+	: Format(InFormat)
+	, bDither(bInDither)
+{
+	check(IsPackedFormat(Format));
+}
+
+void FAnimatedTexturePixelPacker::PackRow(uint16* Dest, const FColor* Src, int32 Num, int32 X, int32 Y) const
+{
+	const bool b565 = Format == PF_R5G6B5_UNORM;
+	const uint16 LevelsR = 31;
+	const uint16 LevelsG = b565 ? 63 : 31;
+	const uint16 LevelsB = 31;
+	const int32 ShiftR = b565 ? 11 : 10;
+	const int32 ShiftG = 5;
+
+	// 每个像素的抖动阈值只取决于 x & 3，8 个一组时各组相同
+	alignas(16) uint16 threshold[8];
+	for (int32 k = 0; k < 8; k++)
+		threshold[k] = bDither ? GBayer4x4[Y & 3][(X + k) & 3] * 16 + 8 : NoDitherThreshold;
+
+	int32 i = 0;
+
+#if AT_PACK_KERNEL_SSE2
+	// FColor 在内存中是 B, G, R, A：每个 32 位通道移位、取低 8 位后两两打包成 16 位
+	const __m128i t = _mm_load_si128((const __m128i*)threshold);
+	const __m128i lr = _mm_set1_epi16((short)LevelsR);
+	const __m128i lg = _mm_set1_epi16((short)LevelsG);
+	const __m128i lb = _mm_set1_epi16((short)LevelsB);
+	const __m128i sr = _mm_cvtsi32_si128(ShiftR);
+	const __m128i sg = _mm_cvtsi32_si128(ShiftG);
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i byteMask = _mm_set1_epi32(0xFF);
+	const __m128i alphaMask = _mm_set1_epi16(b565 ? 0 : (short)0x8000);
+
+	auto Quantize = [&](__m128i v, __m128i levels)
+	{
+		const __m128i x = _mm_add_epi16(_mm_mullo_epi16(v, levels), t);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+	};
+
+	for (; i + 8 <= Num; i += 8)
+	{
+		const __m128i p0 = _mm_loadu_si128((const __m128i*)(Src + i));
+		const __m128i p1 = _mm_loadu_si128((const __m128i*)(Src + i + 4));
+
+		const __m128i b = _mm_packs_epi32(_mm_and_si128(p0, byteMask), _mm_and_si128(p1, byteMask));
+		const __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), byteMask), _mm_and_si128(_mm_srli_epi32(p1, 8), byteMask));
+		const __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), byteMask), _mm_and_si128(_mm_srli_epi32(p1, 16), byteMask));
+		// alpha >= 128 即最高位为 1：算术右移 31 位得到全 1 / 全 0，打包后仍是 0xFFFF / 0
+		const __m128i a = _mm_and_si128(_mm_packs_epi32(_mm_srai_epi32(p0, 31), _mm_srai_epi32(p1, 31)), alphaMask);
+
+		const __m128i v = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(Quantize(r, lr), sr), _mm_sll_epi16(Quantize(g, lg), sg)),
+			_mm_or_si128(Quantize(b, lb), a));
+		_mm_storeu_si128((__m128i*)(Dest + i), v);
+	}
+#elif AT_PACK_KERNEL_NEON
+	// vld4 按分量拆开 8 个像素：val[0..3] 依次是 B, G, R, A
+	const uint16x8_t t = vld1q_u16(threshold);
+	const int16x8_t sr = vdupq_n_s16((int16)ShiftR);
+	const int16x8_t sg = vdupq_n_s16((int16)ShiftG);
+	const uint16x8_t one = vdupq_n_u16(1);
+	const uint16x8_t alphaMask = vdupq_n_u16(b565 ? 0 : 0x8000);
+
+	auto Quantize = [&](uint8x8_t v, uint16 levels)
+	{
+		const uint16x8_t x = vmlaq_n_u16(t, vmovl_u8(v), levels);
+		return vshrq_n_u16(vaddq_u16(vaddq_u16(x, one), vshrq_n_u16(x, 8)), 8);
+	};
+
+	for (; i + 8 <= Num; i += 8)
+	{
+		const uint8x8x4_t p = vld4_u8(reinterpret_cast<const uint8*>(Src + i));
+
+		// alpha 左移 8 位后第 15 位就是 alpha >= 128
+		const uint16x8_t a = vandq_u16(vshll_n_u8(p.val[3], 8), alphaMask);
+		const uint16x8_t v = vorrq_u16(vorrq_u16(vshlq_u16(Quantize(p.val[2], LevelsR), sr), vshlq_u16(Quantize(p.val[1], LevelsG), sg)),
+			vorrq_u16(Quantize(p.val[0], LevelsB), a));
+		vst1q_u16(Dest + i, v);
+	}
+#endif
+
+	for (; i < Num; i++)
+	{
+		const FColor c = Src[i];
+		const uint16 th = threshold[i & 7];
+		const uint16 qr = QuantizeScalar(c.R, LevelsR, th);
+		const uint16 qg = QuantizeScalar(c.G, LevelsG, th);
+		const uint16 qb = QuantizeScalar(c.B, LevelsB, th);
+		const uint16 a = (!b565 && c.A >= 128) ? 0x8000 : 0;
+		Dest[i] = static_cast<uint16>((qr << ShiftR) | (qg << ShiftG) | qb | a);
+	}
+}
+
+void FAnimatedTexturePixelPacker::PackRect(uint8* Dest, const FColor* Canvas, int32 CanvasWidth, const FIntRect& Rect) const
+{
+	const int32 Width = Rect.Width();
+	for (int32 y = Rect.Min.Y; y < Rect.Max.Y; y++)
+	{
+		PackRow(reinterpret_cast<uint16*>(Dest), Canvas + y * CanvasWidth + Rect.Min.X, Width, Rect.Min.X, y);
+		Dest += Width * sizeof(uint16);
+	}
+}
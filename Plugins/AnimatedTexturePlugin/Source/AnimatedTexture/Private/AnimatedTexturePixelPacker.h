@@ -0,0 +1,41 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * BGRA8 to 16-bit upload format conversion
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+
+/**
+ * 把 BGRA8 画布转换为 16 位上传格式：PF_R5G6B5_UNORM（不透明）或 PF_B5G5R5A1_UNORM（1 位 alpha）
+ *
+ * - 两种格式都没有 sRGB 版本，只用于非 sRGB 纹理（见 UAnimatedTexture2D::ResolveStreamingFormat），分量按原值量化；
+ * - 可选 4x4 有序抖动，阈值只取决于画布坐标：没有变化的像素每次转换的结果相同，按脏矩形上传不会闪烁；
+ * - SSE2 / NEON 每次处理 8 个像素，分量拆分、量化与打包都在向量寄存器里完成，输出与逐像素的标量实现完全一致。
+ */
+class FAnimatedTexturePixelPacker
+{
+public:
+	FAnimatedTexturePixelPacker(EPixelFormat InFormat, bool bInDither);
+
+	static bool IsPackedFormat(EPixelFormat Format) { return Format == PF_R5G6B5_UNORM || Format == PF_B5G5R5A1_UNORM; }
+
+	EPixelFormat GetFormat() const { return Format; }
+
+	/** 转换一行：Src 是画布上从 (X, Y) 开始的 Num 个像素 */
+	void PackRow(uint16* Dest, const FColor* Src, int32 Num, int32 X, int32 Y) const;
+
+	/** 转换画布上的矩形区域，Dest 中各行紧密排列（行间距 Rect.Width() * 2） */
+	void PackRect(uint8* Dest, const FColor* Canvas, int32 CanvasWidth, const FIntRect& Rect) const;
+
+private:
+	EPixelFormat Format;
+	bool bDither;
+};
@@ -11,11 +11,19 @@
 #include "AnimatedTextureResource.h"
 #include "AnimatedTexture2D.h"
 #include "AnimatedTextureCompat.h"
+#include "AnimatedTextureStagingPool.h"
+#include "AnimatedTextureSharedSource.h"
 
+#include "Containers/LockFreeList.h"
+
+#include "RenderingThread.h"	// RenderCore
 #include "DeviceProfiles/DeviceProfile.h"	// Engine
 #include "DeviceProfiles/DeviceProfileManager.h"	// Engine
 
-FAnimatedTextureResource::FAnimatedTextureResource(UAnimatedTexture2D* InOwner) :Owner(InOwner)
+FAnimatedTextureResource::FAnimatedTextureResource(UAnimatedTexture2D* InOwner,
+	TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> InSharedTextureSource)
+	: Owner(InOwner)
+	, SharedTextureSource(MoveTemp(InSharedTextureSource))
 {
 }
 
@@ -59,9 +67,14 @@ void FAnimatedTextureResource::InitRHI(FRHICommandListBase& RHICmdList)
 	const ESamplerAddressMode AddressV = ConvertAddressMode(Owner->AddressY);
 	constexpr ESamplerAddressMode AddressW = AM_Wrap;
 
+	// FrameArray 与共用的 RHI 纹理格式固定；调色板索引与 16 位格式只用于独立的 Streaming 纹理
+	const EPixelFormat StreamingFormat = (Owner->IsFrameArrayMode() || SharedTextureSource) ? PF_B8G8R8A8 : Owner->GetStreamingFormat();
+
+	// 调色板索引不能插值：索引纹理始终点采样，过滤在查表之后由材质决定
+	const bool bIndexed = StreamingFormat == PF_R8;
 	const FSamplerStateInitializerRHI SamplerStateInitializer
 	(
-		static_cast<ESamplerFilter>(UDeviceProfileManager::Get().GetActiveProfile()->GetTextureLODSettings()->
+		bIndexed ? SF_Point : static_cast<ESamplerFilter>(UDeviceProfileManager::Get().GetActiveProfile()->GetTextureLODSettings()->
 		                                                         GetSamplerFilter(Owner)),
 		AddressU,
 		AddressV,
@@ -70,17 +83,35 @@ void FAnimatedTextureResource::InitRHI(FRHICommandListBase& RHICmdList)
 	SamplerStateRHI = GetOrCreateSamplerState(SamplerStateInitializer);
 
 	ETextureCreateFlags  Flags = TexCreate_None;
-	if (!Owner->SRGB)
+	if (!Owner->SRGB || bIndexed)
 		bIgnoreGammaConversions = true;
 
-	if (Owner->SRGB)
+	// 16 位格式没有 sRGB 版本，只用于非 sRGB 纹理（见 ResolveStreamingFormat）
+	if (Owner->SRGB && StreamingFormat == PF_B8G8R8A8)
 		Flags |= TexCreate_SRGB;
 	if (Owner->bNoTiling)
 		Flags |= TexCreate_NoTiling;
 
 	constexpr uint32 NumMips = 1;
 	const FString Name = Owner->GetName();
-	TextureRHI = AnimatedTextureCompat::AT_CreateTexture2D(RHICmdList, *Name, GetSizeX(), GetSizeY(), PF_B8G8R8A8, NumMips, 1, Flags);
+	if (Owner->IsFrameArrayMode() && Owner->GetFrameArraySize() > 0)
+	{
+		// GPU 播放：每个时间片一层，切片内容由 worker 合成（或从烘焙数据读入）后整体上传
+		TextureRHI = AnimatedTextureCompat::AT_CreateTexture2DArray(RHICmdList, *Name, GetSizeX(), GetSizeY(),
+			Owner->GetFrameArraySize(), Owner->GetFrameArrayFormat(), Flags);
+	}
+	else if (SharedTextureSource)
+	{
+		// 分组里第一个初始化的资源创建 RHI 纹理（内容相同，尺寸也相同），其余资源直接引用它
+		FTextureRHIRef& SharedTexture = SharedTextureSource->SharedTextureRHI;
+		if (!SharedTexture)
+			SharedTexture = AnimatedTextureCompat::AT_CreateTexture2D(RHICmdList, *Name, GetSizeX(), GetSizeY(), PF_B8G8R8A8, NumMips, 1, Flags);
+		TextureRHI = SharedTexture;
+	}
+	else
+	{
+		TextureRHI = AnimatedTextureCompat::AT_CreateTexture2D(RHICmdList, *Name, GetSizeX(), GetSizeY(), StreamingFormat, NumMips, 1, Flags);
+	}
 	TextureRHI->SetName(Owner->GetFName());
 	AnimatedTextureCompat::AT_UpdateTextureReference(Owner->TextureReference.TextureReferenceRHI, TextureRHI);
 }
@@ -92,4 +123,48 @@ void FAnimatedTextureResource::ReleaseRHI()
 		AnimatedTextureCompat::AT_UpdateTextureReference(Owner->TextureReference.TextureReferenceRHI, nullptr);
 	}
 	FTextureResource::ReleaseRHI();
-}
\ No newline at end of file
+}
+
+static TLockFreePointerListUnordered<FAnimatedTextureFrameUpdateList, PLATFORM_CACHE_LINE_SIZE> GFrameUpdateListPool;
+
+FAnimatedTextureFrameUpdateList* AllocAnimatedTextureFrameUpdates()
+{
+	FAnimatedTextureFrameUpdateList* Updates = GFrameUpdateListPool.Pop();
+	return Updates ? Updates : new FAnimatedTextureFrameUpdateList();
+}
+
+void FlushAnimatedTextureFrameUpdatePool()
+{
+	while (FAnimatedTextureFrameUpdateList* Updates = GFrameUpdateListPool.Pop())
+	{
+		delete Updates;
+	}
+}
+
+void EnqueueAnimatedTextureFrameUpdates(FAnimatedTextureFrameUpdateList* Updates)
+{
+	check(Updates);
+
+	ENQUEUE_RENDER_COMMAND(AnimTexture2D_RenderFrames)(
+		[Updates](FRHICommandListImmediate& RHICmdList)
+		{
+			for (FAnimatedTextureFrameUpdate& Update : *Updates)
+			{
+				if (!Update.StagingPool || Update.StagingIndex == INDEX_NONE)
+					continue;
+
+				if (Update.Resource && Update.Resource->TextureRHI)
+				{
+					const uint32 SrcPitch = Update.Rect.Width() * Update.BytesPerPixel;
+					AnimatedTextureCompat::AT_UpdateFrameRegionToTexture(RHICmdList, Update.Resource->TextureRHI, Update.Rect,
+						SrcPitch, Update.StagingPool->GetBuffer(Update.StagingIndex));
+				}
+
+				// UpdateTexture2D 已把数据拷贝进命令列表，staging buffer 可以立即交还
+				Update.StagingPool->Release(Update.StagingIndex);
+			}
+
+			Updates->Reset();
+			GFrameUpdateListPool.Push(Updates);
+		});
+}
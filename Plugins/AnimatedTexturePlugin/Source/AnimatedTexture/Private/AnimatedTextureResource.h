@@ -14,6 +14,20 @@
 #include "TextureResource.h"	// Engine
 
 class UAnimatedTexture2D;
+class FAnimatedTextureStagingPool;
+class FAnimatedTextureSharedSource;
+
+/**
+ * 创建 RHI 纹理时提交的初始内容（见 AnimatedTextureCompat::AT_CreateTexture2D），RHI 读取之后释放
+ */
+struct FAnimatedTextureInitialData : public FResourceBulkDataInterface
+{
+	TArray<uint8> Data;
+
+	virtual const void* GetResourceBulkData() const override { return Data.GetData(); }
+	virtual uint32 GetResourceBulkDataSize() const override { return Data.Num(); }
+	virtual void Discard() override { Data.Empty(); }
+};
 
 /**
  * FTextureResource implementation for animated 2D textures
@@ -22,7 +36,11 @@ class UAnimatedTexture2D;
 class FAnimatedTextureResource : public FTextureResource
 {
 public:
-	explicit FAnimatedTextureResource(UAnimatedTexture2D* InOwner);
+	/**
+	 * @param InSharedTextureSource	非空时与同一分组的纹理共用一张 RHI 纹理，见 UAnimatedTexture2D::bShareTexture
+	 */
+	explicit FAnimatedTextureResource(UAnimatedTexture2D* InOwner,
+		TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> InSharedTextureSource = nullptr);
 
 	//~ Begin FTextureResource Interface.
 	virtual uint32 GetSizeX() const override;
@@ -33,5 +51,37 @@ public:
 
 private:
 	UAnimatedTexture2D* Owner;
+	TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> SharedTextureSource;
+
+};
+
+/**
+ * 一帧待上传的像素数据（游戏线程 / 解码线程 -> 渲染线程）
+ */
+struct FAnimatedTextureFrameUpdate
+{
+	FTextureResource* Resource = nullptr;
+	FIntRect Rect;			// 需要更新的画布区域（脏矩形）
 
+	// 像素数据所在的 staging buffer：BGRA 或调色板索引，只包含 Rect 区域，行间距为 Rect.Width() * BytesPerPixel
+	TSharedPtr<FAnimatedTextureStagingPool, ESPMode::ThreadSafe> StagingPool;
+	int32 StagingIndex = INDEX_NONE;
+	uint32 BytesPerPixel = sizeof(FColor);
 };
+
+typedef TArray<FAnimatedTextureFrameUpdate> FAnimatedTextureFrameUpdateList;
+
+/**
+ * 从回收池中取一个空的帧更新数组（保留上次的容量），避免每帧分配；
+ * 交给 EnqueueAnimatedTextureFrameUpdates 之后由渲染线程归还。
+ */
+FAnimatedTextureFrameUpdateList* AllocAnimatedTextureFrameUpdates();
+
+/**
+ * 把一批帧更新合并为一条渲染命令提交，并接管 Updates 的所有权；
+ * Resource 为空或没有 staging buffer 的条目会被忽略。
+ */
+void EnqueueAnimatedTextureFrameUpdates(FAnimatedTextureFrameUpdateList* Updates);
+
+/** 模块卸载时释放回收池中的数组 */
+void FlushAnimatedTextureFrameUpdatePool();
@@ -0,0 +1,275 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Reverse and ping-pong playback on top of the forward-only decoders
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureSequenceDecoder.h"
+#include "AnimatedTextureModule.h"
+#include "AnimatedTextureSharedSource.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+
+static TAutoConsoleVariable<int32> CVarAnimTextureReverseFullCacheMB(
+	TEXT("AnimatedTexture.ReverseFullCacheMB"),
+	16,
+	TEXT("Reverse / ping-pong textures whose frames fit in this many MB cache every composited frame once.\n")
+	TEXT("Larger textures cache a window of about sqrt(frame count) frames plus snapshots of the same interval."));
+
+FAnimatedTextureSequenceDecoder::FAnimatedTextureSequenceDecoder(TSharedRef<FAnimatedTextureDecoder, ESPMode::ThreadSafe> InSource, EAnimatedTexturePlayDirection InDirection)
+	: Source(InSource)
+	, Direction(InDirection)
+{
+	NumSourceFrames = Source->GetNumFrames();
+	NumPositions = NumSourceFrames;
+	if (Direction == EAnimatedTexturePlayDirection::PingPong && NumSourceFrames > 2)
+		NumPositions = NumSourceFrames * 2 - 2;
+
+	const SIZE_T FrameBytes = SIZE_T(Source->GetWidth()) * Source->GetHeight() * Source->GetBytesPerPixel();
+	const SIZE_T FullCacheBytes = SIZE_T(FMath::Max(0, CVarAnimTextureReverseFullCacheMB.GetValueOnAnyThread())) * 1024 * 1024;
+	bFullCache = FrameBytes * NumSourceFrames <= FullCacheBytes;
+	WindowSize = bFullCache ? NumSourceFrames : FMath::Max(2, FMath::CeilToInt(FMath::Sqrt(float(NumSourceFrames))));
+
+	StepDirty.Init(FIntRect(0, 0, GetWidth(), GetHeight()), NumSourceFrames);
+	SetSnapshotInterval(0);
+}
+
+void FAnimatedTextureSequenceDecoder::Close()
+{
+	Source->Close();
+	Window.Empty();
+	WindowCount = 0;
+	Canvas = nullptr;
+}
+
+void FAnimatedTextureSequenceDecoder::SetSnapshotInterval(int32 Interval)
+{
+	// 窗口的重新填充依赖源解码器每 WindowSize 帧一个快照；窗口覆盖所有帧时不需要
+	const int32 RequiredInterval = bFullCache ? 0 : WindowSize;
+	if (Interval > 0 && RequiredInterval > 0)
+		Source->SetSnapshotInterval(FMath::Min(Interval, RequiredInterval));
+	else
+		Source->SetSnapshotInterval(FMath::Max(Interval, RequiredInterval));
+}
+
+int32 FAnimatedTextureSequenceDecoder::ToSourceFrame(int32 Index) const
+{
+	if (Direction == EAnimatedTexturePlayDirection::Reverse)
+		return NumSourceFrames - 1 - Index;
+	if (Direction == EAnimatedTexturePlayDirection::PingPong && Index >= NumSourceFrames)
+		return NumSourceFrames * 2 - 2 - Index;
+	return Index;
+}
+
+int32 FAnimatedTextureSequenceDecoder::FromSourceFrame(int32 SourceFrame) const
+{
+	if (Direction == EAnimatedTexturePlayDirection::Reverse)
+		return NumSourceFrames - 1 - SourceFrame;
+	return SourceFrame;
+}
+
+bool FAnimatedTextureSequenceDecoder::IsBackward(int32 Position) const
+{
+	if (Direction == EAnimatedTexturePlayDirection::Reverse)
+		return true;
+	return Direction == EAnimatedTexturePlayDirection::PingPong && Position >= NumSourceFrames;
+}
+
+uint32 FAnimatedTextureSequenceDecoder::GetDuration(uint32 DefaultFrameDelay) const
+{
+	const uint32 SourceDuration = Source->GetDuration(DefaultFrameDelay);
+	if (NumPositions == NumSourceFrames)
+		return SourceDuration;
+
+	// 往返：首尾两帧各只出现一次
+	return SourceDuration * 2
+		- Source->GetFrameDelay(0, DefaultFrameDelay)
+		- Source->GetFrameDelay(NumSourceFrames - 1, DefaultFrameDelay);
+}
+
+SIZE_T FAnimatedTextureSequenceDecoder::GetAllocatedSize() const
+{
+	SIZE_T Size = Source->GetAllocatedSize() + Window.GetAllocatedSize() + StepDirty.GetAllocatedSize();
+	for (const TArray<uint8>& Frame : Window)
+		Size += Frame.GetAllocatedSize();
+	return Size;
+}
+
+void FAnimatedTextureSequenceDecoder::Reset()
+{
+	// 窗口里的帧与播放位置无关，保留
+	NextPosition = 0;
+	LastPosition = INDEX_NONE;
+	LastSourceFrame = INDEX_NONE;
+	DirtyRect = FIntRect();
+}
+
+void FAnimatedTextureSequenceDecoder::SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay)
+{
+	if (NumPositions == 0)
+		return;
+
+	// 真正的解码推迟到 NextFrame：向前的一段由源解码器定位，向后的一段填充窗口
+	NextPosition = FMath::Clamp(FrameIndex, 0, NumPositions - 1);
+	LastSourceFrame = INDEX_NONE;
+}
+
+void FAnimatedTextureSequenceDecoder::FillWindow(int32 SourceFrame, uint32 DefaultFrameDelay)
+{
+	const int32 FrameBytes = GetWidth() * GetHeight() * GetBytesPerPixel();
+	if (Window.Num() != WindowSize)
+	{
+		Window.SetNum(WindowSize);
+		for (TArray<uint8>& Frame : Window)
+			Frame.SetNumUninitialized(FrameBytes);
+	}
+
+	const int32 Start = FMath::Max(0, SourceFrame - WindowSize + 1);
+	const int32 End = FMath::Min(NumSourceFrames - 1, Start + WindowSize - 1);
+
+	// 源解码器不在 Start 时从最近的快照或关键帧定位
+	const bool bSequential = Source->GetCurrentFrame() + 1 == Start;
+	if (!bSequential)
+		Source->SeekFrame(Start, DefaultFrameDelay);
+
+	for (int32 i = Start; i <= End; i++)
+	{
+		Source->NextFrame(DefaultFrameDelay, false);
+		FMemory::Memcpy(Window[i - Start].GetData(), Source->GetCanvasData(), FrameBytes);
+
+		// Seek 之后第一帧的脏矩形不可靠
+		if (i > 0 && (i > Start || bSequential))
+			StepDirty[i] = Source->GetDirtyRect();
+	}
+
+	WindowStart = Start;
+	WindowCount = End - Start + 1;
+}
+
+uint32 FAnimatedTextureSequenceDecoder::NextFrame(uint32 DefaultFrameDelay, bool bLooping)
+{
+	DirtyRect = FIntRect();
+	if (NumPositions == 0)
+		return DefaultFrameDelay;
+
+	const int32 Position = NextPosition;
+	const int32 Frame = ToSourceFrame(Position);
+
+	if (Frame >= WindowStart && Frame < WindowStart + WindowCount)
+	{
+		Canvas = Window[Frame - WindowStart].GetData();
+	}
+	else if (IsBackward(Position))
+	{
+		FillWindow(Frame, DefaultFrameDelay);
+		Canvas = Window[Frame - WindowStart].GetData();
+	}
+	else
+	{
+		// 向前的一段：源解码器不在这一帧时先定位
+		const bool bSequential = Source->GetCurrentFrame() + 1 == Frame;
+		if (!bSequential)
+			Source->SeekFrame(Frame, DefaultFrameDelay);
+
+		Source->NextFrame(DefaultFrameDelay, false);
+		Canvas = Source->GetCanvasData();
+		if (Frame > 0 && bSequential)
+			StepDirty[Frame] = Source->GetDirtyRect();
+	}
+
+	// 与上一次输出的帧相比变化的区域：相邻两帧之间的变化与方向无关
+	if (Frame == LastSourceFrame)
+		DirtyRect = FIntRect();
+	else if (Frame == LastSourceFrame + 1)
+		DirtyRect = StepDirty[Frame];
+	else if (Frame == LastSourceFrame - 1)
+		DirtyRect = StepDirty[LastSourceFrame];
+	else
+		DirtyRect = FIntRect(0, 0, GetWidth(), GetHeight());
+
+	LastSourceFrame = Frame;
+	LastPosition = Position;
+
+	NextPosition = Position + 1;
+	if (NextPosition >= NumPositions)
+		NextPosition = bLooping ? 0 : NumPositions - 1;
+
+	return Source->GetFrameDelay(Frame, DefaultFrameDelay);
+}
+
+/**
+ * AnimatedTexture.BenchmarkPlayDirection <File> [Loops]
+ * 对一个 GIF/WebP 文件分别按三种方向播放若干圈，输出每个显示帧的平均解码耗时
+ */
+static void BenchmarkPlayDirection(const TArray<FString>& Args)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogAnimTexture, Display, TEXT("Usage: AnimatedTexture.BenchmarkPlayDirection <File> [Loops]"));
+		return;
+	}
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Args[0]))
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("BenchmarkPlayDirection: failed to read '%s'."), *Args[0]);
+		return;
+	}
+
+	const EAnimatedTextureType Type = UAnimatedTexture2D::DetectTypeFromMagic(Data.GetData(), Data.Num());
+	const int32 Loops = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 3;
+	const uint32 DefaultFrameDelay = 100;
+
+	static const EAnimatedTexturePlayDirection Directions[] = {
+		EAnimatedTexturePlayDirection::Forward,
+		EAnimatedTexturePlayDirection::Reverse,
+		EAnimatedTexturePlayDirection::PingPong };
+
+	for (EAnimatedTexturePlayDirection Direction : Directions)
+	{
+		TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Decoder = CreateAnimatedTextureDecoder(Type);
+		if (!Decoder || !Decoder->LoadFromMemory(Data.GetData(), Data.Num()))
+		{
+			UE_LOG(LogAnimTexture, Error, TEXT("BenchmarkPlayDirection: '%s' is not a valid GIF/WebP file."), *Args[0]);
+			return;
+		}
+		if (Direction != EAnimatedTexturePlayDirection::Forward)
+			Decoder = MakeShared<FAnimatedTextureSequenceDecoder, ESPMode::ThreadSafe>(Decoder.ToSharedRef(), Direction);
+
+		// 第一圈包含窗口与快照的建立，单独统计
+		const int32 NumFrames = Decoder->GetNumFrames();
+		double FirstLoop = 0;
+		double Steady = 0;
+		double Worst = 0;
+		for (int32 Loop = 0; Loop < Loops; Loop++)
+		{
+			for (int32 i = 0; i < NumFrames; i++)
+			{
+				const double Start = FPlatformTime::Seconds();
+				Decoder->NextFrame(DefaultFrameDelay, true);
+				const double Elapsed = FPlatformTime::Seconds() - Start;
+
+				(Loop == 0 ? FirstLoop : Steady) += Elapsed;
+				if (Loop > 0)
+					Worst = FMath::Max(Worst, Elapsed);
+			}
+		}
+
+		const double SteadyFrames = double(NumFrames) * FMath::Max(Loops - 1, 1);
+		UE_LOG(LogAnimTexture, Display, TEXT("BenchmarkPlayDirection %-8s: %d frames, first loop %.3f ms/frame, steady %.3f ms/frame (worst %.3f ms), %.1f MB decode state."),
+			*UEnum::GetValueAsString(Direction), NumFrames,
+			FirstLoop * 1000.0 / FMath::Max(NumFrames, 1), Steady * 1000.0 / SteadyFrames, Worst * 1000.0,
+			Decoder->GetAllocatedSize() / (1024.0 * 1024.0));
+	}
+}
+
+static FAutoConsoleCommand GAnimTextureBenchmarkPlayDirectionCmd(
+	TEXT("AnimatedTexture.BenchmarkPlayDirection"),
+	TEXT("Decode a GIF/WebP file forward, in reverse and ping-pong and log the average decode cost per displayed frame. Usage: AnimatedTexture.BenchmarkPlayDirection <File> [Loops]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPlayDirection));
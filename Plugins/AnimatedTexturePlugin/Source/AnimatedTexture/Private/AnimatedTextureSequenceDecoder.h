@@ -0,0 +1,86 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Reverse and ping-pong playback on top of the forward-only decoders
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimatedTextureDecoder.h"
+#include "AnimatedTexture2D.h"
+
+/**
+ * 把源解码器的帧按播放方向排成一条新的序列，对外仍然是只向前播放的解码器，
+ * 追帧、Seek、预解码队列都不需要区分方向：
+ *
+ * - Reverse：N-1, N-2, ..., 0；PingPong：0, 1, ..., N-1, N-2, ..., 1；
+ * - 向前的一段直接调用源解码器的 NextFrame；
+ * - 向后的一段从窗口中取：窗口缓存以目标帧结尾的连续 W 帧（W ≈ sqrt(N)）的合成结果，用完后从更早的位置重新填充。
+ *   源解码器每 W 帧保存一个快照，每次填充最多解码约 2W 帧，平摊到每个显示的帧不超过 2 次解码；
+ * - 整个动画不超过 AnimatedTexture.ReverseFullCacheMB 时窗口覆盖所有帧，只解码一遍。
+ */
+class FAnimatedTextureSequenceDecoder : public FAnimatedTextureDecoder
+{
+public:
+	FAnimatedTextureSequenceDecoder(TSharedRef<FAnimatedTextureDecoder, ESPMode::ThreadSafe> InSource, EAnimatedTexturePlayDirection InDirection);
+
+	virtual bool LoadFromMemory(const uint8* InBuffer, uint32 InBufferSize) override { return false; }
+	virtual void Close() override;
+
+	virtual uint32 NextFrame(uint32 DefaultFrameDelay, bool bLooping) override;
+	virtual void Reset() override;
+	virtual void SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay) override;
+	virtual void SetSnapshotInterval(int32 Interval) override;
+	virtual int32 GetCurrentFrame() const override { return LastPosition; }
+
+	virtual int32 ToSourceFrame(int32 Index) const override;
+	virtual int32 FromSourceFrame(int32 SourceFrame) const override;
+
+	virtual uint32 GetWidth() const override { return Source->GetWidth(); }
+	virtual uint32 GetHeight() const override { return Source->GetHeight(); }
+	virtual const FColor* GetFrameBuffer() const override { return IsIndexedOutput() ? nullptr : reinterpret_cast<const FColor*>(Canvas); }
+
+	// 索引输出需要在包装之前对源解码器开启
+	virtual bool SupportsIndexedOutput() const override { return Source->SupportsIndexedOutput(); }
+	virtual bool IsIndexedOutput() const override { return Source->IsIndexedOutput(); }
+	virtual const FColor* GetPalette() const override { return Source->GetPalette(); }
+	virtual const uint8* GetIndexBuffer() const override { return IsIndexedOutput() ? Canvas : nullptr; }
+
+	virtual uint32 GetNumFrames() const override { return NumPositions; }
+	virtual uint32 GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const override { return Source->GetFrameDelay(ToSourceFrame(FrameIndex), DefaultFrameDelay); }
+	virtual uint32 GetDuration(uint32 DefaultFrameDelay) const override;
+	virtual bool SupportsTransparency() const override { return Source->SupportsTransparency(); }
+	virtual FIntRect GetDirtyRect() const override { return DirtyRect; }
+	virtual SIZE_T GetAllocatedSize() const override;
+
+private:
+	bool IsBackward(int32 Position) const;
+
+	/** 向前解码填充以 SourceFrame 结尾的窗口 */
+	void FillWindow(int32 SourceFrame, uint32 DefaultFrameDelay);
+
+private:
+	TSharedRef<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Source;
+	EAnimatedTexturePlayDirection Direction;
+	int32 NumSourceFrames = 0;
+	int32 NumPositions = 0;
+
+	int32 WindowSize = 0;
+	bool bFullCache = false;
+	TArray<TArray<uint8>> Window;	// 源帧 [WindowStart, WindowStart + WindowCount) 的合成结果，按源解码器的输出格式
+	int32 WindowStart = 0;
+	int32 WindowCount = 0;
+
+	TArray<FIntRect> StepDirty;		// 源帧 i 相对于 i - 1 变化的区域，还没有顺序解码过时为整张画布
+
+	const uint8* Canvas = nullptr;
+	FIntRect DirtyRect;
+	int32 NextPosition = 0;
+	int32 LastPosition = INDEX_NONE;
+	int32 LastSourceFrame = INDEX_NONE;
+};
@@ -0,0 +1,327 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Decoded animation source shared by all textures with identical content
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureSharedSource.h"
+#include "AnimatedTextureStats.h"
+#include "GIFDecoder.h"
+#include "WebpDecoder.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Hash/xxhash.h"
+
+static TAutoConsoleVariable<int32> CVarAnimTextureSharedFrameCacheMB(
+	TEXT("AnimatedTexture.SharedFrameCacheMB"),
+	32,
+	TEXT("Largest animation (all frames, in MB) whose composited frames are cached once its content is used by more than one texture.\n")
+	TEXT(" 0: never cache, every texture runs its own decoder over the shared file data"));
+
+TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> CreateAnimatedTextureDecoder(EAnimatedTextureType FileType)
+{
+	switch (FileType)
+	{
+	case EAnimatedTextureType::Gif:
+		return MakeShared<FGIFDecoder, ESPMode::ThreadSafe>();
+	case EAnimatedTextureType::Webp:
+		return MakeShared<FWebpDecoder, ESPMode::ThreadSafe>();
+	}
+	return nullptr;
+}
+
+// 内容哈希 -> 源；同一哈希下可能有多个源（哈希冲突时逐字节比较）
+static FCriticalSection GSharedSourceLock;
+static TMultiMap<uint64, TWeakPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe>> GSharedSources;
+
+TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> FAnimatedTextureSharedSource::FindOrCreate(EAnimatedTextureType InType, const FSharedBuffer& InBuffer)
+{
+	const uint8* InData = static_cast<const uint8*>(InBuffer.GetData());
+	const uint64 InSize = InBuffer.GetSize();
+	if (InType == EAnimatedTextureType::None || !InData || InSize == 0 || InSize > MAX_int32)
+		return nullptr;
+
+	const uint64 ContentHash = FXxHash64::HashBuffer(InData, InSize).Hash;
+	{
+		FScopeLock Lock(&GSharedSourceLock);
+		for (auto It = GSharedSources.CreateKeyIterator(ContentHash); It; ++It)
+		{
+			TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> Existing = It.Value().Pin();
+			if (Existing
+				&& Existing->Type == InType
+				&& Existing->Data.GetSize() == InSize
+				&& FMemory::Memcmp(Existing->Data.GetData(), InData, InSize) == 0)
+			{
+				return Existing;
+			}
+		}
+	}
+
+	// 解析放在锁外：同一内容并发创建时可能各自解析一次，登记时以先到者为准
+	TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> NewSource(new FAnimatedTextureSharedSource());
+	NewSource->Type = InType;
+	NewSource->Hash = ContentHash;
+	NewSource->Data = InBuffer.MakeOwned();
+	if (!NewSource->Parse())
+		return nullptr;
+
+	FScopeLock Lock(&GSharedSourceLock);
+	for (auto It = GSharedSources.CreateKeyIterator(ContentHash); It; ++It)
+	{
+		TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> Existing = It.Value().Pin();
+		if (Existing
+			&& Existing->Type == InType
+			&& Existing->Data.GetSize() == InSize
+			&& FMemory::Memcmp(Existing->Data.GetData(), InData, InSize) == 0)
+		{
+			return Existing;
+		}
+	}
+	GSharedSources.Add(ContentHash, NewSource);
+	return NewSource;
+}
+
+FAnimatedTextureSharedSource::~FAnimatedTextureSharedSource()
+{
+	DEC_MEMORY_STAT_BY(STAT_AnimTexture_SharedFrameMemory, NumCachedFrames.load() * Width * Height * sizeof(FColor));
+
+	// 自己的弱引用此时已经失效，顺便清理同一哈希下失效的条目
+	FScopeLock Lock(&GSharedSourceLock);
+	for (auto It = GSharedSources.CreateKeyIterator(Hash); It; ++It)
+	{
+		if (!It.Value().IsValid())
+			It.RemoveCurrent();
+	}
+}
+
+bool FAnimatedTextureSharedSource::Parse()
+{
+	ParseDecoder = CreateAnimatedTextureDecoder(Type);
+	if (!ParseDecoder || !ParseDecoder->LoadFromMemory(GetData(), GetDataSize()))
+	{
+		ParseDecoder.Reset();
+		return false;
+	}
+
+	Width = ParseDecoder->GetWidth();
+	Height = ParseDecoder->GetHeight();
+	bTransparency = ParseDecoder->SupportsTransparency();
+	bIndexable = ParseDecoder->SupportsIndexedOutput();
+	if (bIndexable)
+		Palette = TArray<FColor>(ParseDecoder->GetPalette(), 256);
+
+	const uint32 NumFrames = ParseDecoder->GetNumFrames();
+	FrameDelays.SetNumUninitialized(NumFrames);
+	for (uint32 i = 0; i < NumFrames; i++)
+		FrameDelays[i] = ParseDecoder->GetFrameDelay(i, 0);
+
+	const uint64 CacheBytes = uint64(Width) * Height * sizeof(FColor) * NumFrames;
+	const uint64 CacheLimit = uint64(FMath::Max(0, CVarAnimTextureSharedFrameCacheMB.GetValueOnAnyThread())) * 1024 * 1024;
+	bCacheable = NumFrames > 0 && CacheBytes <= CacheLimit;
+	if (bCacheable)
+	{
+		Frames.SetNum(NumFrames);
+		FrameDirtyRects.SetNum(NumFrames);
+	}
+	return true;
+}
+
+uint32 FAnimatedTextureSharedSource::GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const
+{
+	if (!FrameDelays.IsValidIndex(FrameIndex))
+		return DefaultFrameDelay;
+	return FrameDelays[FrameIndex] == 0 ? DefaultFrameDelay : FrameDelays[FrameIndex];
+}
+
+uint32 FAnimatedTextureSharedSource::GetDuration(uint32 DefaultFrameDelay) const
+{
+	uint32 Duration = 0;
+	for (uint32 Delay : FrameDelays)
+		Duration += Delay == 0 ? DefaultFrameDelay : Delay;
+	return Duration;
+}
+
+TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> FAnimatedTextureSharedSource::CreateDecoder()
+{
+	FScopeLock Lock(&DecoderLock);
+
+	if (ParseDecoder)
+		return MoveTemp(ParseDecoder);
+
+	if (bCacheable)
+		return MakeShared<FAnimatedTextureSharedDecoder, ESPMode::ThreadSafe>(AsShared());
+
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> NewDecoder = CreateAnimatedTextureDecoder(Type);
+	if (NewDecoder && NewDecoder->LoadFromMemory(GetData(), GetDataSize()))
+		return NewDecoder;
+	return nullptr;
+}
+
+const FColor* FAnimatedTextureSharedSource::GetFrame(int32 FrameIndex, FIntRect& OutDirtyRect)
+{
+	check(bCacheable && Frames.IsValidIndex(FrameIndex));
+
+	if (FrameIndex >= NumCachedFrames.load(std::memory_order_acquire))
+	{
+		FScopeLock Lock(&FillLock);
+
+		int32 NumCached = NumCachedFrames.load(std::memory_order_relaxed);
+		if (NumCached == 0 && !FillDecoder)
+		{
+			FillDecoder = CreateAnimatedTextureDecoder(Type);
+			if (!FillDecoder || !FillDecoder->LoadFromMemory(GetData(), GetDataSize()))
+			{
+				// 第一次解析成功过，这里只可能是内存不足
+				FillDecoder.Reset();
+				OutDirtyRect = FIntRect();
+				return nullptr;
+			}
+		}
+
+		// 帧之间有依赖（处置方式、混合），只能从已缓存的最后一帧顺序往后解
+		for (; NumCached <= FrameIndex; NumCached++)
+		{
+			FillDecoder->NextFrame(0, false);
+			Frames[NumCached] = TArray<FColor>(FillDecoder->GetFrameBuffer(), Width * Height);
+			FrameDirtyRects[NumCached] = NumCached == 0 ? FIntRect(0, 0, Width, Height) : FillDecoder->GetDirtyRect();
+			NumCachedFrames.store(NumCached + 1, std::memory_order_release);
+			INC_MEMORY_STAT_BY(STAT_AnimTexture_SharedFrameMemory, Width * Height * sizeof(FColor));
+		}
+
+		// 全部帧都已缓存，解码器不再需要
+		if (NumCached == Frames.Num())
+			FillDecoder.Reset();
+		FillDecoderSize.store(FillDecoder ? FillDecoder->GetAllocatedSize() : 0, std::memory_order_relaxed);
+	}
+
+	OutDirtyRect = FrameDirtyRects[FrameIndex];
+	return Frames[FrameIndex].GetData();
+}
+
+SIZE_T FAnimatedTextureSharedSource::GetAllocatedSize() const
+{
+	SIZE_T Size = Data.GetSize() + FrameDelays.GetAllocatedSize() + Palette.GetAllocatedSize();
+	Size += SIZE_T(NumCachedFrames.load(std::memory_order_relaxed)) * Width * Height * sizeof(FColor);
+	Size += FillDecoderSize.load(std::memory_order_relaxed);
+	if (ParseDecoder)
+		Size += ParseDecoder->GetAllocatedSize();
+	return Size;
+}
+
+SIZE_T FAnimatedTextureSharedSource::TrimFrameCache()
+{
+	check(IsInGameThread());
+
+	// 播放头可能在工作线程上创建（异步加载解码第一帧、预备 Payload），无锁的检查只用来提前返回；
+	// 播放头在 FillLock 内登记，持锁后再检查一次，释放期间不会有新的读者出现
+	if (!bCacheable || NumSharedDecoders.load(std::memory_order_acquire) > 0)
+		return 0;
+
+	FScopeLock Lock(&FillLock);
+	if (NumSharedDecoders.load(std::memory_order_acquire) > 0)
+		return 0;
+
+	const int32 NumCached = NumCachedFrames.load(std::memory_order_relaxed);
+	if (NumCached == 0 && !FillDecoder)
+		return 0;
+
+	SIZE_T Freed = SIZE_T(NumCached) * Width * Height * sizeof(FColor);
+	if (FillDecoder)
+		Freed += FillDecoder->GetAllocatedSize();
+
+	for (TArray<FColor>& Frame : Frames)
+		Frame.Empty();
+	NumCachedFrames.store(0, std::memory_order_release);
+	FillDecoder.Reset();
+	FillDecoderSize.store(0, std::memory_order_relaxed);
+
+	DEC_MEMORY_STAT_BY(STAT_AnimTexture_SharedFrameMemory, NumCached * Width * Height * sizeof(FColor));
+	return Freed;
+}
+
+bool FAnimatedTextureSharedSource::JoinTextureGroup(UAnimatedTexture2D* Texture, bool& bOutLeader)
+{
+	check(IsInGameThread());
+
+	TextureGroup.RemoveAll([](const TWeakObjectPtr<UAnimatedTexture2D>& Member) { return !Member.IsValid(); });
+
+	// 同一张 RHI 纹理只能有一种 sRGB 设置，与 leader 不一致的纹理不加入分组
+	if (TextureGroup.Num() > 0 && TextureGroup[0].Get() != Texture && TextureGroup[0]->SRGB != Texture->SRGB)
+	{
+		LeaveTextureGroup(Texture);
+		bOutLeader = false;
+		return false;
+	}
+
+	TextureGroup.AddUnique(Texture);
+	bOutLeader = TextureGroup[0].Get() == Texture;
+	return true;
+}
+
+void FAnimatedTextureSharedSource::LeaveTextureGroup(UAnimatedTexture2D* Texture)
+{
+	check(IsInGameThread());
+
+	const int32 Index = TextureGroup.IndexOfByKey(Texture);
+	if (Index == INDEX_NONE)
+		return;
+
+	TextureGroup.RemoveAt(Index);
+	TextureGroup.RemoveAll([](const TWeakObjectPtr<UAnimatedTexture2D>& Member) { return !Member.IsValid(); });
+	if (Index != 0 || TextureGroup.Num() == 0)
+		return;
+
+	// leader 可能正在 GC 中销毁，下一帧再让新的 leader 重建资源（创建解码器并开始 Tick）
+	TWeakObjectPtr<UAnimatedTexture2D> NewLeader = TextureGroup[0];
+	AsyncTask(ENamedThreads::GameThread, [NewLeader]()
+		{
+			if (UAnimatedTexture2D* Leader = NewLeader.Get())
+				Leader->UpdateResource();
+		});
+}
+
+FAnimatedTextureSharedDecoder::FAnimatedTextureSharedDecoder(TSharedRef<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> InSource)
+	: Source(InSource)
+{
+	// 与 TrimFrameCache 互斥：要么登记发生在清空缓存之前（TrimFrameCache 看到计数后放弃），要么在它之后（从空缓存重新填充）
+	FScopeLock Lock(&Source->FillLock);
+	Source->NumSharedDecoders.fetch_add(1, std::memory_order_relaxed);
+}
+
+FAnimatedTextureSharedDecoder::~FAnimatedTextureSharedDecoder()
+{
+	Source->NumSharedDecoders.fetch_sub(1, std::memory_order_release);
+}
+
+uint32 FAnimatedTextureSharedDecoder::NextFrame(uint32 DefaultFrameDelay, bool bLooping)
+{
+	const int32 NumFrames = Source->GetNumFrames();
+	if (NumFrames == 0)
+	{
+		DirtyRect = FIntRect();
+		return DefaultFrameDelay;
+	}
+
+	const int32 FrameIndex = FMath::Clamp(CurrentFrame, 0, NumFrames - 1);
+	FIntRect CachedRect;
+	FrameBuffer = Source->GetFrame(FrameIndex, CachedRect);
+
+	// 缓存的脏矩形只对"上一帧 -> 下一帧"有效；回绕或 Reset 之后整张更新
+	if (FrameIndex == LastFrame)
+		DirtyRect = FIntRect();
+	else if (FrameIndex == LastFrame + 1)
+		DirtyRect = CachedRect;
+	else
+		DirtyRect = FIntRect(0, 0, GetWidth(), GetHeight());
+	LastFrame = FrameIndex;
+
+	CurrentFrame = FrameIndex + 1;
+	if (CurrentFrame >= NumFrames)
+		CurrentFrame = bLooping ? 0 : NumFrames - 1;
+
+	return Source->GetFrameDelay(FrameIndex, DefaultFrameDelay);
+}
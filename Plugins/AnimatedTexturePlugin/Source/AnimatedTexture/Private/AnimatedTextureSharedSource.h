@@ -0,0 +1,174 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Decoded animation source shared by all textures with identical content
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "Memory/SharedBuffer.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureDecoder.h"
+#include <atomic>
+
+/** 按文件类型创建一个空的解码器 */
+TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> CreateAnimatedTextureDecoder(EAnimatedTextureType FileType);
+
+/**
+ * 一份 GIF/WebP 内容在进程内只保留一份，按内容哈希登记：
+ *
+ * - 文件数据只有一份（可以是接管过来的数组或内存映射的文件），所有纹理的解码器都直接读它；
+ * - 容器只解析一次，得到尺寸、帧数、每帧延迟；
+ * - 第二个使用者出现后（且不超过 AnimatedTexture.SharedFrameCacheMB），合成好的帧按播放顺序缓存下来，
+ *   之后的纹理只持有自己的播放头（FAnimatedTextureSharedDecoder），不再各自解码；
+ * - 打开 bShareTexture 的纹理还可以共用一张 RHI 纹理，由分组里第一个纹理负责解码和上传。
+ */
+class FAnimatedTextureSharedSource : public TSharedFromThis<FAnimatedTextureSharedSource, ESPMode::ThreadSafe>
+{
+public:
+	/**
+	 * 按内容查找已登记的源；没有则持有这份数据并解析，数据无法解析时返回 nullptr。
+	 * InData 自己持有内存（MakeSharedBufferFromArray、内存映射等）时直接接管，不拷贝；只是一个视图时拷贝一份
+	 */
+	static TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> FindOrCreate(EAnimatedTextureType InType, const FSharedBuffer& InData);
+
+	static TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> FindOrCreate(EAnimatedTextureType InType, const uint8* InData, int32 InSize)
+	{
+		return FindOrCreate(InType, FSharedBuffer::MakeView(InData, InSize));
+	}
+
+	~FAnimatedTextureSharedSource();
+
+	EAnimatedTextureType GetType() const { return Type; }
+	const uint8* GetData() const { return static_cast<const uint8*>(Data.GetData()); }
+	int32 GetDataSize() const { return int32(Data.GetSize()); }
+
+	uint32 GetWidth() const { return Width; }
+	uint32 GetHeight() const { return Height; }
+	uint32 GetNumFrames() const { return FrameDelays.Num(); }
+	uint32 GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const;
+	uint32 GetDuration(uint32 DefaultFrameDelay) const;
+	bool SupportsTransparency() const { return bTransparency; }
+
+	/** 所有帧能否共用一个 256 色调色板（索引上传）；帧缓存里总是 BGRA，索引输出需要独立的解码器 */
+	bool SupportsIndexedOutput() const { return bIndexable; }
+	const FColor* GetPalette() const { return Palette.Num() > 0 ? Palette.GetData() : nullptr; }
+
+	/**
+	 * 为一个纹理创建解码器：第一个使用者拿到解析容器时用过的解码器，
+	 * 之后的使用者在允许缓存时得到只读共享帧的播放头，否则得到直接读共享数据的独立解码器
+	 */
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> CreateDecoder();
+
+	/**
+	 * 任意线程：返回合成好的第 FrameIndex 帧（整张画布），必要时按顺序补齐缓存
+	 * @param OutDirtyRect	与上一帧相比变化的区域，第 0 帧为整张画布
+	 */
+	const FColor* GetFrame(int32 FrameIndex, FIntRect& OutDirtyRect);
+
+	/** 文件数据、帧缓存与填充用解码器占用的 CPU 内存 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * GameThread：没有任何播放头在使用帧缓存时释放它（之后按需重新填充），返回释放的字节数。
+	 * 播放头可以在任意线程创建，计数检查与清空都在 FillLock 内完成
+	 */
+	SIZE_T TrimFrameCache();
+
+public:	// Shared RHI texture, see UAnimatedTexture2D::bShareTexture
+	/**
+	 * GameThread：加入共用 RHI 纹理的分组
+	 * @param bOutLeader	该纹理是否是负责解码与上传的 leader
+	 * @return 与 leader 的 sRGB 设置不一致时不能加入，返回 false
+	 */
+	bool JoinTextureGroup(UAnimatedTexture2D* Texture, bool& bOutLeader);
+
+	/** GameThread：离开分组；leader 离开时下一个纹理在下一帧接管播放 */
+	void LeaveTextureGroup(UAnimatedTexture2D* Texture);
+
+	/** RenderThread：分组共用的 RHI 纹理，第一个初始化的资源负责创建 */
+	FTextureRHIRef SharedTextureRHI;
+
+private:
+	FAnimatedTextureSharedSource() = default;
+
+	bool Parse();
+
+private:
+	EAnimatedTextureType Type = EAnimatedTextureType::None;
+	uint64 Hash = 0;
+	FSharedBuffer Data;
+
+	uint32 Width = 0;
+	uint32 Height = 0;
+	bool bTransparency = false;
+	bool bIndexable = false;
+	TArray<FColor> Palette;			// bIndexable 时所有帧共用的 256 色调色板
+	TArray<uint32> FrameDelays;		// 文件里的原始延迟（毫秒），0 表示未指定
+
+	FCriticalSection DecoderLock;
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> ParseDecoder;	// 解析容器时创建，交给第一个使用者
+	bool bCacheable = false;
+
+	// 帧缓存：外层数组在创建时定长，只追加不移动，已缓存的帧可以无锁读取
+	FCriticalSection FillLock;
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> FillDecoder;
+	std::atomic<SIZE_T> FillDecoderSize{ 0 };	// FillDecoder 的内存占用，在 FillLock 内更新，供 GetAllocatedSize 无锁读取
+	TArray<TArray<FColor>> Frames;
+	TArray<FIntRect> FrameDirtyRects;
+	std::atomic<int32> NumCachedFrames{ 0 };
+	std::atomic<int32> NumSharedDecoders{ 0 };	// 存活的 FAnimatedTextureSharedDecoder 数量，在 FillLock 内增加
+
+	friend class FAnimatedTextureSharedDecoder;
+
+	TArray<TWeakObjectPtr<UAnimatedTexture2D>> TextureGroup;	// [0] 是 leader
+};
+
+/**
+ * 只持有播放头的解码器：像素来自 FAnimatedTextureSharedSource 的帧缓存
+ */
+class FAnimatedTextureSharedDecoder : public FAnimatedTextureDecoder
+{
+public:
+	explicit FAnimatedTextureSharedDecoder(TSharedRef<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> InSource);
+	virtual ~FAnimatedTextureSharedDecoder();
+
+	virtual bool LoadFromMemory(const uint8* InBuffer, uint32 InBufferSize) override { return false; }
+	virtual void Close() override {}
+
+	virtual uint32 NextFrame(uint32 DefaultFrameDelay, bool bLooping) override;
+	virtual void Reset() override { CurrentFrame = 0; LastFrame = INDEX_NONE; }
+	virtual void SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay) override
+	{
+		// 帧缓存可以直接随机访问，下一帧整张更新
+		CurrentFrame = FMath::Clamp(FrameIndex, 0, FMath::Max<int32>(Source->GetNumFrames() - 1, 0));
+		LastFrame = INDEX_NONE;
+	}
+	virtual int32 GetCurrentFrame() const override { return LastFrame; }
+
+	virtual uint32 GetWidth() const override { return Source->GetWidth(); }
+	virtual uint32 GetHeight() const override { return Source->GetHeight(); }
+	virtual const FColor* GetFrameBuffer() const override { return FrameBuffer; }
+
+	virtual uint32 GetNumFrames() const override { return Source->GetNumFrames(); }
+	virtual uint32 GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const override { return Source->GetFrameDelay(FrameIndex, DefaultFrameDelay); }
+	virtual uint32 GetDuration(uint32 DefaultFrameDelay) const override { return Source->GetDuration(DefaultFrameDelay); }
+	virtual bool SupportsTransparency() const override { return Source->SupportsTransparency(); }
+	virtual bool SupportsIndexedOutput() const override { return Source->SupportsIndexedOutput(); }
+	virtual const FColor* GetPalette() const override { return Source->GetPalette(); }
+	virtual FIntRect GetDirtyRect() const override { return DirtyRect; }
+	virtual SIZE_T GetAllocatedSize() const override { return 0; }	// 帧缓存计在共享源上
+
+private:
+	TSharedRef<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> Source;
+	const FColor* FrameBuffer = nullptr;
+	int32 CurrentFrame = 0;
+	int32 LastFrame = INDEX_NONE;	// 上一次输出的帧，用来判断能否沿用缓存的脏矩形
+	FIntRect DirtyRect;
+};
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Recycled staging buffers for game thread -> render thread frame handoff
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureStagingPool.h"
+#include "AnimatedTextureStats.h"
+
+FAnimatedTextureStagingPool::FAnimatedTextureStagingPool(uint32 InBufferSize, int32 InNumBuffers)
+	: BufferSize(InBufferSize)
+{
+	const int32 NumBuffers = FMath::Clamp(InNumBuffers, 1, 32);
+	Buffers.SetNum(NumBuffers);
+	for (TArray<uint8>& Buffer : Buffers)
+	{
+		Buffer.SetNumUninitialized(BufferSize);
+	}
+	FreeMask.store(NumBuffers == 32 ? 0xFFFFFFFFu : ((1u << NumBuffers) - 1));
+
+	INC_MEMORY_STAT_BY(STAT_AnimTexture_StagingMemory, BufferSize * NumBuffers);
+	INC_DWORD_STAT_BY(STAT_AnimTexture_StagingBuffers, NumBuffers);
+}
+
+FAnimatedTextureStagingPool::~FAnimatedTextureStagingPool()
+{
+	DEC_MEMORY_STAT_BY(STAT_AnimTexture_StagingMemory, BufferSize * Buffers.Num());
+	DEC_DWORD_STAT_BY(STAT_AnimTexture_StagingBuffers, Buffers.Num());
+}
+
+int32 FAnimatedTextureStagingPool::Acquire()
+{
+	uint32 Mask = FreeMask.load(std::memory_order_acquire);
+	while (Mask != 0)
+	{
+		const uint32 Index = FMath::CountTrailingZeros(Mask);
+		const uint32 NewMask = Mask & ~(1u << Index);
+		if (FreeMask.compare_exchange_weak(Mask, NewMask, std::memory_order_acq_rel))
+			return static_cast<int32>(Index);
+	}
+
+	INC_DWORD_STAT(STAT_AnimTexture_StagingStalls);
+	return INDEX_NONE;
+}
+
+void FAnimatedTextureStagingPool::Release(int32 Index)
+{
+	check(Buffers.IsValidIndex(Index));
+	FreeMask.fetch_or(1u << Index, std::memory_order_release);
+}
@@ -0,0 +1,46 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Recycled staging buffers for game thread -> render thread frame handoff
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * 每个纹理一组固定数量（默认 3 个）的 staging buffer
+ *
+ * - 解码线程 Acquire 一个空闲 buffer，把脏矩形像素写进去，随渲染命令交给渲染线程；
+ * - 渲染线程上传完毕后 Release，所有权通过一个原子位图交还，无锁；
+ * - buffer 在创建时一次性分配，播放期间不再分配内存。
+ * Pool 通过 TSharedPtr 被渲染命令持有，纹理先于渲染命令销毁也是安全的。
+ */
+class FAnimatedTextureStagingPool
+{
+public:
+	static constexpr int32 DefaultNumBuffers = 3;
+
+	FAnimatedTextureStagingPool(uint32 InBufferSize, int32 InNumBuffers = DefaultNumBuffers);
+	~FAnimatedTextureStagingPool();
+
+	/** 任意线程：取一个空闲 buffer，全部被占用时返回 INDEX_NONE */
+	int32 Acquire();
+
+	/** 任意线程（通常是渲染线程）：归还 buffer */
+	void Release(int32 Index);
+
+	uint8* GetBuffer(int32 Index) { return Buffers[Index].GetData(); }
+	uint32 GetBufferSize() const { return BufferSize; }
+	SIZE_T GetAllocatedSize() const { return SIZE_T(BufferSize) * Buffers.Num(); }
+
+private:
+	uint32 BufferSize = 0;
+	TArray<TArray<uint8>> Buffers;
+	std::atomic<uint32> FreeMask{ 0 };
+};
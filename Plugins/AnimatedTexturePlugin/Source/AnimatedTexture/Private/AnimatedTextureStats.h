@@ -0,0 +1,23 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Stats for AnimatedTexture plugin, use "stat AnimatedTexture" to display
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("AnimatedTexture"), STATGROUP_AnimTexture, STATCAT_Advanced);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Staging Buffer Memory"), STAT_AnimTexture_StagingMemory, STATGROUP_AnimTexture, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Staging Buffers"), STAT_AnimTexture_StagingBuffers, STATGROUP_AnimTexture, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Staging Pool Stalls"), STAT_AnimTexture_StagingStalls, STATGROUP_AnimTexture, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Shared Frame Cache Memory"), STAT_AnimTexture_SharedFrameMemory, STATGROUP_AnimTexture, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Decode State Memory"), STAT_AnimTexture_DecodeStateMemory, STATGROUP_AnimTexture, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Evicted Textures"), STAT_AnimTexture_EvictedTextures, STATGROUP_AnimTexture, );
@@ -0,0 +1,355 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Central tick manager for all live UAnimatedTexture2D objects
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "AnimatedTextureSubsystem.h"
+#include "AnimatedTextureModule.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureResource.h"
+#include "AnimatedTextureCompat.h"
+#include "AnimatedTextureSharedSource.h"
+#include "AnimatedTextureStats.h"
+
+#include "Engine/Engine.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/UObjectIterator.h"
+
+static TAutoConsoleVariable<int32> CVarAnimTextureParallelDecode(
+	TEXT("AnimatedTexture.ParallelDecode"),
+	1,
+	TEXT("Decode the frames of all animated textures that are due in the same tick in parallel.\n")
+	TEXT(" 0: decode serially on the game thread\n")
+	TEXT(" 1: decode with ParallelFor (default)"));
+
+static TAutoConsoleVariable<int32> CVarAnimTextureMemoryBudgetMB(
+	TEXT("AnimatedTexture.MemoryBudgetMB"),
+	0,
+	TEXT("CPU memory budget (MB) for the decode state of all animated textures: decoders, decode-ahead rings, staging buffers and shared frame caches.\n")
+	TEXT("Over budget, the decode state of textures not rendered recently is released in LRU order and rebuilt when they are rendered again.\n")
+	TEXT(" 0: no budget (default)"));
+
+static TAutoConsoleVariable<float> CVarAnimTextureEvictIdleSeconds(
+	TEXT("AnimatedTexture.EvictIdleSeconds"),
+	2.0f,
+	TEXT("A texture is only evicted after it has not been rendered (or played) for this many seconds."));
+
+static uint32 GAnimTextureScheduleSerial = 0;
+
+UAnimatedTextureSubsystem* UAnimatedTextureSubsystem::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UAnimatedTextureSubsystem>() : nullptr;
+}
+
+bool UAnimatedTextureSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Headless 进程（Dedicated Server / -nullrhi）不需要 Tick 任何动画纹理
+	return Super::ShouldCreateSubsystem(Outer) && !UAnimatedTexture2D::IsHeadless();
+}
+
+void UAnimatedTextureSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// 在子系统创建之前就已经创建了 Resource 的纹理（例如引擎初始化阶段加载的资源），在这里补注册
+	for (TObjectIterator<UAnimatedTexture2D> It; It; ++It)
+	{
+		UAnimatedTexture2D* Texture = *It;
+		if (Texture->IsTemplate())
+			continue;
+
+		if (Texture->Decoder)
+			RegisterDecodeState(Texture);
+		if (Texture->ShouldTick())
+			Register(Texture);
+	}
+
+	MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddUObject(this, &UAnimatedTextureSubsystem::OnMemoryTrim);
+}
+
+void UAnimatedTextureSubsystem::Deinitialize()
+{
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+	DecodeStateOwners.Empty();
+	EvictedTextures.Empty();
+	EvictCandidates.Empty();
+
+	for (FSlot& Slot : Slots)
+	{
+		Slot.Texture->TickSlot = INDEX_NONE;
+	}
+	Slots.Empty();
+	Schedule.Empty();
+	DueTextures.Empty();
+
+	Super::Deinitialize();
+}
+
+void UAnimatedTextureSubsystem::Register(UAnimatedTexture2D* Texture)
+{
+	check(IsInGameThread());
+	check(Texture);
+
+	if (Texture->TickSlot == INDEX_NONE)
+	{
+		FSlot Slot;
+		Slot.Texture = Texture;
+		Texture->TickSlot = Slots.Add(Slot);
+		Texture->LastSyncClock = Clock;
+	}
+
+	Reschedule(Texture);
+}
+
+void UAnimatedTextureSubsystem::Unregister(UAnimatedTexture2D* Texture)
+{
+	check(IsInGameThread());
+	check(Texture);
+
+	if (Texture->TickSlot == INDEX_NONE)
+		return;
+
+	// 堆中残留的条目会因为 Slot 失效（或 Serial 不匹配）在弹出时被丢弃
+	if (Slots[Texture->TickSlot].bHidden)
+		NumHidden--;
+	Slots.RemoveAt(Texture->TickSlot);
+	Texture->TickSlot = INDEX_NONE;
+}
+
+void UAnimatedTextureSubsystem::RegisterDecodeState(UAnimatedTexture2D* Texture)
+{
+	check(IsInGameThread());
+	check(Texture);
+
+	DecodeStateOwners.Add(Texture);
+}
+
+void UAnimatedTextureSubsystem::UnregisterDecodeState(UAnimatedTexture2D* Texture)
+{
+	check(IsInGameThread());
+
+	DecodeStateOwners.Remove(Texture);
+}
+
+void UAnimatedTextureSubsystem::Reschedule(UAnimatedTexture2D* Texture)
+{
+	check(IsInGameThread());
+
+	if (Texture->TickSlot == INDEX_NONE)
+		return;
+
+	// 更新 Serial 使旧的堆条目失效
+	FSlot& Slot = Slots[Texture->TickSlot];
+	Slot.Serial = ++GAnimTextureScheduleSerial;
+	if (Slot.bHidden)
+	{
+		Slot.bHidden = false;
+		NumHidden--;
+	}
+
+	const double DueTime = Texture->GetNextFrameClock();
+	if (DueTime == TNumericLimits<double>::Max())
+		return;	// 暂停中，等 Play / SetPlayRate 再次调度
+
+	FScheduleEntry Entry;
+	Entry.DueTime = DueTime;
+	Entry.SlotIndex = Texture->TickSlot;
+	Entry.Serial = Slot.Serial;
+	Schedule.HeapPush(Entry);
+
+	CompactSchedule();
+}
+
+bool UAnimatedTextureSubsystem::IsEntryValid(const FScheduleEntry& Entry) const
+{
+	return Slots.IsValidIndex(Entry.SlotIndex)
+		&& Slots[Entry.SlotIndex].Serial == Entry.Serial;
+}
+
+void UAnimatedTextureSubsystem::CompactSchedule()
+{
+	// 频繁 Reschedule 会在堆中留下失效条目，数量过多时整体清理一次
+	if (Schedule.Num() <= Slots.Num() * 2 + 64)
+		return;
+
+	Schedule.RemoveAllSwap([this](const FScheduleEntry& Entry) { return !IsEntryValid(Entry); });
+	Schedule.Heapify();
+}
+
+void UAnimatedTextureSubsystem::Tick(float DeltaTime)
+{
+	Clock += DeltaTime;
+
+	UpdateMemoryBudget();
+	UpdateHiddenTextures();
+
+	// 1. 弹出所有到期的纹理；没有被渲染的纹理不解码，移出调度直到再次被渲染
+	const double Now = FApp::GetCurrentTime();
+	DueTextures.Reset();
+	while (Schedule.Num() > 0 && Schedule.HeapTop().DueTime <= Clock)
+	{
+		// 不收缩容量，稳态播放时不产生内存分配
+		FScheduleEntry Entry;
+#if AT_UE_VERSION_GE(5, 4)
+		Schedule.HeapPop(Entry, EAllowShrinking::No);
+#else
+		Schedule.HeapPop(Entry, false);
+#endif
+		if (IsEntryValid(Entry))
+		{
+			FSlot& Slot = Slots[Entry.SlotIndex];
+			Slot.Serial = ++GAnimTextureScheduleSerial;
+			if (!Slot.Texture->IsRenderedRecently(Now))
+			{
+				Slot.bHidden = true;
+				NumHidden++;
+				continue;
+			}
+			DueTextures.Add(Slot.Texture);
+		}
+	}
+
+	if (DueTextures.Num() <= 0)
+		return;
+
+	// 结算到当前时钟，DecodeFrame 据此计算需要追赶几帧
+	for (UAnimatedTexture2D* Texture : DueTextures)
+	{
+		Texture->SyncFrameTime();
+	}
+
+	// 2. 解码：每个纹理只访问自己的解码器，可以安全地并行
+	FAnimatedTextureFrameUpdateList* Updates = AllocAnimatedTextureFrameUpdates();
+	Updates->SetNum(DueTextures.Num());
+
+	const bool bParallel = CVarAnimTextureParallelDecode.GetValueOnGameThread() != 0;
+	ParallelFor(DueTextures.Num(), [this, Updates](int32 Index)
+		{
+			DueTextures[Index]->DecodeFrame((*Updates)[Index]);
+		},
+		bParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+
+	// 3. 游戏线程收尾，并计算下一帧的到期时间；播完的纹理在这里退出调度
+	for (UAnimatedTexture2D* Texture : DueTextures)
+	{
+		Texture->FinishFrame();
+		Texture->UpdateTickRegistration();
+	}
+
+	// 4. 所有上传合并为一条渲染命令
+	EnqueueAnimatedTextureFrameUpdates(Updates);
+}
+
+void UAnimatedTextureSubsystem::UpdateHiddenTextures()
+{
+	const double Now = FApp::GetCurrentTime();
+	if (NumHidden <= 0 || Now < NextVisibilityUpdateTime)
+		return;
+	NextVisibilityUpdateTime = Now + 0.25;
+
+	for (FSlot& Slot : Slots)
+	{
+		if (Slot.bHidden && Slot.Texture->IsRenderedRecently(Now))
+			Reschedule(Slot.Texture);	// 已经到期，下一次 Tick 按流逝的时间追帧
+	}
+}
+
+void UAnimatedTextureSubsystem::OnMemoryTrim()
+{
+	bMemoryTrimRequested.store(true, std::memory_order_relaxed);
+}
+
+void UAnimatedTextureSubsystem::UpdateMemoryBudget()
+{
+	const bool bTrim = bMemoryTrimRequested.exchange(false, std::memory_order_relaxed);
+	const double Now = FApp::GetCurrentTime();
+	if (!bTrim && Now < NextBudgetUpdateTime)
+		return;
+	NextBudgetUpdateTime = Now + 0.25;
+
+	const double IdleSeconds = FMath::Max(0.0f, CVarAnimTextureEvictIdleSeconds.GetValueOnGameThread());
+
+	// 1. 被淘汰的纹理重新被渲染：重建解码状态（会重新注册 Tick）
+	// 持有引用：淘汰时纹理可能释放共享源，第 4 步仍要访问它
+	TSet<TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe>> Sources;
+	for (int32 i = EvictedTextures.Num() - 1; i >= 0; i--)
+	{
+		UAnimatedTexture2D* Texture = EvictedTextures[i].Get();
+		if (Texture && Texture->bDecodeStateEvicted && Now - Texture->GetLastUsedTime() < IdleSeconds)
+			Texture->RestoreDecodeState();
+
+		if (!Texture || !Texture->bDecodeStateEvicted)
+		{
+			EvictedTextures.RemoveAtSwap(i);
+			continue;
+		}
+
+		if (Texture->SharedSource)
+			Sources.Add(Texture->SharedSource);
+	}
+
+	// 2. 统计所有持有解码状态的纹理（包括停止、播完、没有被渲染而不在 Tick 的纹理），共享源只计一次
+	SIZE_T TotalSize = 0;
+	EvictCandidates.Reset();
+	for (UAnimatedTexture2D* Texture : DecodeStateOwners)
+	{
+		TotalSize += Texture->GetDecodeStateSize();
+		if (Texture->SharedSource)
+			Sources.Add(Texture->SharedSource);
+
+		if (Texture->CanEvictDecodeState() && Now - Texture->GetLastUsedTime() >= IdleSeconds)
+			EvictCandidates.Add(Texture);
+	}
+	for (const TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe>& Source : Sources)
+		TotalSize += Source->GetAllocatedSize();
+
+	SET_MEMORY_STAT(STAT_AnimTexture_DecodeStateMemory, TotalSize);
+	SET_DWORD_STAT(STAT_AnimTexture_EvictedTextures, EvictedTextures.Num());
+
+	const SIZE_T Budget = SIZE_T(FMath::Max(0, CVarAnimTextureMemoryBudgetMB.GetValueOnGameThread())) * 1024 * 1024;
+	if (!bTrim && (Budget == 0 || TotalSize <= Budget))
+		return;
+
+	// 3. 最久没有使用的纹理先淘汰；MemoryTrim 时淘汰所有闲置纹理
+	EvictCandidates.Sort([](const UAnimatedTexture2D& A, const UAnimatedTexture2D& B)
+		{
+			return A.GetLastUsedTime() < B.GetLastUsedTime();
+		});
+
+	const SIZE_T SizeBefore = TotalSize;
+	int32 NumEvicted = 0;
+	for (UAnimatedTexture2D* Texture : EvictCandidates)
+	{
+		if (!bTrim && TotalSize <= Budget)
+			break;
+
+		TotalSize -= FMath::Min(TotalSize, Texture->GetDecodeStateSize());
+		Texture->EvictDecodeState();
+		EvictedTextures.Add(Texture);
+		NumEvicted++;
+	}
+
+	// 4. 没有播放头再使用的共享帧缓存；已经没有纹理引用的共享源随 Sources 一起释放
+	for (const TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe>& Source : Sources)
+	{
+		if (Source.IsUnique())
+			TotalSize -= FMath::Min(TotalSize, Source->GetAllocatedSize());
+		else
+			TotalSize -= FMath::Min(TotalSize, Source->TrimFrameCache());
+	}
+
+	SET_MEMORY_STAT(STAT_AnimTexture_DecodeStateMemory, TotalSize);
+	SET_DWORD_STAT(STAT_AnimTexture_EvictedTextures, EvictedTextures.Num());
+
+	UE_LOG(LogAnimTexture, Verbose, TEXT("AnimatedTexture memory %s: evicted %d textures, %.1f MB -> %.1f MB (budget %.1f MB)."),
+		bTrim ? TEXT("trim") : TEXT("over budget"), NumEvicted,
+		SizeBefore / (1024.0 * 1024.0), TotalSize / (1024.0 * 1024.0), Budget / (1024.0 * 1024.0));
+}
@@ -9,7 +9,7 @@
 
 #include "AsyncDownloadAnimatedTexture.h"
 #include "AnimatedTextureDownloader.h"
-#include "AnimatedTextureFunctionLibrary.h"
+#include "AnimatedTextureLoadTask.h"
 #include "AnimatedTexture2D.h"
 #include "AnimatedTextureModule.h"
 
@@ -27,13 +27,14 @@ UAsyncDownloadAnimatedTexture::UAsyncDownloadAnimatedTexture(const FObjectInitia
 }
 
 UAsyncDownloadAnimatedTexture* UAsyncDownloadAnimatedTexture::DownloadAnimatedTexture(
-	UObject* WorldContextObject, const FString& Url, float Timeout, int32 MaxBytes)
+	UObject* WorldContextObject, const FString& Url, float Timeout, int32 MaxBytes, EAnimatedTextureLoadPriority Priority)
 {
 	UAsyncDownloadAnimatedTexture* Action = NewObject<UAsyncDownloadAnimatedTexture>();
 	Action->WorldContextWeak = WorldContextObject;
 	Action->UrlCached = Url;
 	Action->TimeoutCached = Timeout;
 	Action->MaxBytesCached = MaxBytes;
+	Action->PriorityCached = Priority;
 	return Action;
 }
 
@@ -45,14 +46,14 @@ void UAsyncDownloadAnimatedTexture::Activate()
 	TWeakObjectPtr<UAsyncDownloadAnimatedTexture> WeakThis(this);
 
 	Downloader->OnComplete.BindLambda(
-		[WeakThis](const TArray<uint8>& Body, const FString& ETag)
+		[WeakThis](TArray<uint8>& Body, const FString& ETag)
 		{
 			UAsyncDownloadAnimatedTexture* Self = WeakThis.Get();
 			if (!Self)
 			{
 				return;
 			}
-			Self->HandleComplete(Body, ETag);
+			Self->HandleComplete(MoveTemp(Body), ETag);
 		});
 
 	Downloader->OnError.BindLambda(
@@ -88,6 +89,13 @@ void UAsyncDownloadAnimatedTexture::Cancel()
 		Downloader->Cancel();
 	}
 
+	// 下载已完成、正在后台解析：中止加载管线，不会再回调 HandleLoaded。
+	if (LoadTask.IsValid())
+	{
+		LoadTask->Cancel();
+		LoadTask.Reset();
+	}
+
 	// 在 GameThread 上广播 OnCanceled（Cancel 可能被任意线程/帧调用，这里统一到 GameThread）。
 	TWeakObjectPtr<UAsyncDownloadAnimatedTexture> WeakThis(this);
 	if (IsInGameThread())
@@ -110,7 +118,7 @@ void UAsyncDownloadAnimatedTexture::Cancel()
 	}
 }
 
-void UAsyncDownloadAnimatedTexture::HandleComplete(const TArray<uint8>& Body, const FString& ETag)
+void UAsyncDownloadAnimatedTexture::HandleComplete(TArray<uint8>&& Body, const FString& ETag)
 {
 	// HTTP 回调依赖 UE5 默认的 CompleteOnGameThread 策略，保证此处在 GameThread。
 	check(IsInGameThread());
@@ -129,17 +137,37 @@ void UAsyncDownloadAnimatedTexture::HandleComplete(const TArray<uint8>& Body, co
 		return;
 	}
 
-	UAnimatedTexture2D* Texture = UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromMemory(
-		Body, EAnimatedTextureType::None, /*Outer=*/ nullptr, NAME_None);
+	// 解析、校验与第一帧解码交给后台加载管线；在此期间仍可 Cancel。
+	// 响应体整块交给共享源，不再拷贝。
+	ETagCached = ETag;
+	LoadTask = FAnimatedTextureLoadTask::LoadMemory(MakeSharedBufferFromArray(MoveTemp(Body)), EAnimatedTextureType::None, PriorityCached,
+		FAnimatedTextureLoadTask::FOnFinished::CreateUObject(this, &UAsyncDownloadAnimatedTexture::HandleLoaded));
+}
 
+void UAsyncDownloadAnimatedTexture::HandleLoaded(UAnimatedTexture2D* Texture, EAnimatedTextureLoadError Error)
+{
+	check(IsInGameThread());
+
+	if (bFinished)
+	{
+		return;
+	}
 	bFinished = true;
+	LoadTask.Reset();
+
+	if (WorldContextWeak.IsStale())
+	{
+		RemoveFromRoot();
+		return;
+	}
+
 	if (!Texture)
 	{
-		OnFailed.Broadcast(EAnimatedTextureLoadError::DecodeFailed);
+		OnFailed.Broadcast(Error);
 	}
 	else
 	{
-		OnSuccess.Broadcast(Texture, UrlCached, ETag);
+		OnSuccess.Broadcast(Texture, UrlCached, ETagCached);
 	}
 	RemoveFromRoot();
 }
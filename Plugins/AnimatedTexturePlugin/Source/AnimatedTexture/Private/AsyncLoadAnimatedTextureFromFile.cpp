@@ -8,14 +8,11 @@
 */
 
 #include "AsyncLoadAnimatedTextureFromFile.h"
-#include "AnimatedTextureFunctionLibrary.h"
+#include "AnimatedTextureLoadTask.h"
 #include "AnimatedTexture2D.h"
 #include "AnimatedTextureModule.h"
 
 #include "Async/Async.h"
-#include "Misc/FileHelper.h"
-#include "Misc/Paths.h"
-#include "HAL/FileManager.h"
 
 UAsyncLoadAnimatedTextureFromFile::UAsyncLoadAnimatedTextureFromFile(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -29,86 +26,86 @@ UAsyncLoadAnimatedTextureFromFile::UAsyncLoadAnimatedTextureFromFile(const FObje
 }
 
 UAsyncLoadAnimatedTextureFromFile* UAsyncLoadAnimatedTextureFromFile::LoadAnimatedTextureFromFileAsync(
-	UObject* WorldContextObject, const FString& FilePath)
+	UObject* WorldContextObject, const FString& FilePath, EAnimatedTextureLoadPriority Priority)
 {
 	UAsyncLoadAnimatedTextureFromFile* Action = NewObject<UAsyncLoadAnimatedTextureFromFile>();
 	Action->WorldContextWeak = WorldContextObject;
 	Action->FilePathCached = FilePath;
+	Action->PriorityCached = Priority;
 	return Action;
 }
 
 void UAsyncLoadAnimatedTextureFromFile::Activate()
 {
-	// 生命周期说明：AddToRoot 已在构造函数中完成；此处仅负责启动异步任务。
-	TWeakObjectPtr<UAsyncLoadAnimatedTextureFromFile> WeakThis(this);
-	const FString Path = FilePathCached;
+	// 生命周期说明：AddToRoot 已在构造函数中完成；此处仅负责启动加载管线。
+	// IO、解析与第一帧解码都在后台线程，完成后在 GameThread 上回调 HandleLoaded。
+	LoadTask = FAnimatedTextureLoadTask::LoadFile(FilePathCached, PriorityCached,
+		FAnimatedTextureLoadTask::FOnFinished::CreateUObject(this, &UAsyncLoadAnimatedTextureFromFile::HandleLoaded));
+}
 
-	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, Path]()
+void UAsyncLoadAnimatedTextureFromFile::Cancel()
+{
+	// 与 UAsyncDownloadAnimatedTexture::Cancel 相同：允许从任意线程调用，广播统一到 GameThread。
+	// bFinished 只在 GameThread 读写（HandleLoaded 由加载管线派发到 GameThread）。
+	if (bFinished)
 	{
-		// 后台线程：仅做路径解析与文件 IO，读出原始字节。
-		FString ResolvedPath = Path;
-		if (FPaths::IsRelative(ResolvedPath))
-		{
-			ResolvedPath = FPaths::Combine(FPaths::ProjectDir(), ResolvedPath);
-		}
-		FPaths::NormalizeFilename(ResolvedPath);
-
-		EAnimatedTextureLoadError Error = EAnimatedTextureLoadError::None;
-		TArray<uint8> Bytes;
-
-		if (ResolvedPath.IsEmpty() || IFileManager::Get().FileSize(*ResolvedPath) <= 0)
-		{
-			Error = EAnimatedTextureLoadError::FileNotFound;
-		}
-		else if (!FFileHelper::LoadFileToArray(Bytes, *ResolvedPath))
-		{
-			Error = EAnimatedTextureLoadError::FileNotFound;
-		}
-		else if (Bytes.Num() <= 0)
-		{
-			Error = EAnimatedTextureLoadError::EmptyBody;
-		}
+		return;
+	}
+	bFinished = true;
 
-		// 先在后台线程根据扩展名推断类型（纯字符串运算，不涉及 UObject）。
-		const EAnimatedTextureType TypeByExt =
-			UAnimatedTexture2D::DetectTypeFromExtension(ResolvedPath);
+	// 中止后台阶段：正在执行的阶段结束后丢弃结果，不再进入下一阶段，也不会回调 HandleLoaded。
+	if (LoadTask.IsValid())
+	{
+		LoadTask->Cancel();
+		LoadTask.Reset();
+	}
 
-		// 回到 GameThread：构造 UAnimatedTexture2D 并广播结果。
-		AsyncTask(ENamedThreads::GameThread,
-			[WeakThis, Error, Bytes = MoveTemp(Bytes), TypeByExt]() mutable
+	TWeakObjectPtr<UAsyncLoadAnimatedTextureFromFile> WeakThis(this);
+	if (IsInGameThread())
+	{
+		OnCanceled.Broadcast(nullptr, EAnimatedTextureLoadError::Canceled);
+		RemoveFromRoot();
+	}
+	else
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakThis]()
 		{
 			UAsyncLoadAnimatedTextureFromFile* Self = WeakThis.Get();
 			if (!Self)
 			{
-				// 节点对象已被 GC（比如 WorldContext 提前结束）；静默退出。
 				return;
 			}
+			Self->OnCanceled.Broadcast(nullptr, EAnimatedTextureLoadError::Canceled);
+			Self->RemoveFromRoot();
+		});
+	}
+}
 
-			// 保护 WorldContext 生命周期：一旦已失效则静默退出。
-			if (Self->WorldContextWeak.IsStale())
-			{
-				Self->RemoveFromRoot();
-				return;
-			}
+void UAsyncLoadAnimatedTextureFromFile::HandleLoaded(UAnimatedTexture2D* Texture, EAnimatedTextureLoadError Error)
+{
+	check(IsInGameThread());
 
-			if (Error != EAnimatedTextureLoadError::None)
-			{
-				Self->OnFailed.Broadcast(nullptr, Error);
-				Self->RemoveFromRoot();
-				return;
-			}
+	if (bFinished)
+	{
+		return;
+	}
+	bFinished = true;
+	LoadTask.Reset();
 
-			UAnimatedTexture2D* Texture = UAnimatedTextureFunctionLibrary::LoadAnimatedTextureFromMemory(
-				Bytes, TypeByExt, /*Outer=*/ nullptr, NAME_None);
-			if (!Texture)
-			{
-				Self->OnFailed.Broadcast(nullptr, EAnimatedTextureLoadError::DecodeFailed);
-				Self->RemoveFromRoot();
-				return;
-			}
+	// 保护 WorldContext 生命周期：一旦已失效则静默退出。
+	if (WorldContextWeak.IsStale())
+	{
+		RemoveFromRoot();
+		return;
+	}
 
-			Self->OnSuccess.Broadcast(Texture, EAnimatedTextureLoadError::None);
-			Self->RemoveFromRoot();
-		});
-	});
+	if (!Texture)
+	{
+		OnFailed.Broadcast(nullptr, Error);
+		RemoveFromRoot();
+		return;
+	}
+
+	OnSuccess.Broadcast(Texture, EAnimatedTextureLoadError::None);
+	RemoveFromRoot();
 }
@@ -16,18 +16,26 @@ FGIFDecoder::~FGIFDecoder()
 	Close();
 }
 
-static int _GIF_InputFunc(GifFileType* gifFile, GifByteType* buffer, int length)
+int FGIFDecoder::InputFunc(GifFileType* gifFile, GifByteType* buffer, int length)
 {
-	uint8_t* fileData = (uint8_t*)(gifFile->UserData);
-	memcpy(buffer, fileData, length);
-	gifFile->UserData = fileData + length;
-	return length;
+	FInputCursor* cursor = (FInputCursor*)(gifFile->UserData);
+
+	// 边界安全：截断的文件只返回剩余的字节，由 giflib 报告 D_GIF_ERR_READ_FAILED
+	const uint32 remain = cursor->Size - cursor->Pos;
+	const uint32 count = FMath::Min((uint32)FMath::Max(length, 0), remain);
+	memcpy(buffer, cursor->Data + cursor->Pos, count);
+	cursor->Pos += count;
+	return (int)count;
 }
 
 bool FGIFDecoder::LoadFromMemory(const uint8* InBuffer, uint32 InBufferSize)
 {
+	mInput.Data = InBuffer;
+	mInput.Size = InBufferSize;
+	mInput.Pos = 0;
+
 	int gifError = 0;
-	mGIF = DGifOpen((void*)InBuffer, _GIF_InputFunc, &gifError);
+	mGIF = DGifOpen((void*)&mInput, InputFunc, &gifError);
 	if (mGIF == nullptr)
 	{
 		FString Error(GifErrorString(gifError));
@@ -35,19 +43,248 @@ bool FGIFDecoder::LoadFromMemory(const uint8* InBuffer, uint32 InBufferSize)
 		return false;
 	}
 
-	gifError = DGifSlurp(mGIF);
-	if (gifError != GIF_OK)
+	mPalette.Reset();
+	mGlobalRemap = mGIF->SColorMap ? mPalette.AddColorMap(mGIF->SColorMap) : INDEX_NONE;
+
+	if (!BuildFrameIndex())
 	{
-		FString Error(GifErrorString(gifError));
+		FString Error(GifErrorString(mGIF->Error));
 		UE_LOG(LogAnimTexture, Error, TEXT("FGIFDecoder: GIF file load failed, %s."), *Error);
+		Close();
 		return false;
 	}
 
+	mFrames.BuildKeyFrames(mGIF->SWidth, mGIF->SHeight);
+	BuildSharedPalette();
+	mGlobalLUT.Build(mGIF->SColorMap);
 	mFrameBuffer.SetNum(mGIF->SWidth * mGIF->SHeight);
 	ClearFrameBuffer(mGIF->SColorMap, true);
 	return true;
 }
 
+bool FGIFDecoder::BuildFrameIndex()
+{
+	mFrames.Reset();
+
+	GraphicsControlBlock gcb;
+	gcb.DisposalMode = DISPOSAL_UNSPECIFIED;
+	gcb.UserInputFlag = false;
+	gcb.DelayTime = 0;
+	gcb.TransparentColor = NO_TRANSPARENT_COLOR;
+	GraphicsControlBlock pendingGCB = gcb;
+
+	int maxLineWidth = 0;
+	GifRecordType recordType = UNDEFINED_RECORD_TYPE;
+	do
+	{
+		if (DGifGetRecordType(mGIF, &recordType) == GIF_ERROR)
+			break;
+
+		switch (recordType)
+		{
+		case IMAGE_DESC_RECORD_TYPE:
+		{
+			const uint32 offset = mInput.Pos;
+
+			// 只读图像描述符和局部调色板，不追加 SavedImages
+			if (DGifGetImageHeader(mGIF) == GIF_ERROR)
+				break;
+
+			const GifImageDesc& id = mGIF->Image;
+			const FIntRect rect(id.Left, id.Top, id.Left + id.Width, id.Top + id.Height);
+			const GraphicsControlBlock frameGCB = pendingGCB;
+			pendingGCB = gcb;
+
+			// 局部调色板只在读图像描述符时可见，这里合并进共用调色板
+			const int32 remap = id.ColorMap ? mPalette.AddColorMap(id.ColorMap) : mGlobalRemap;
+
+			// 跳过 LZW 数据块，不解压
+			if (!SkipImageData())
+				break;
+
+			// 空白子图像也保留为一帧：不绘制任何像素，但它的延迟和处置方式仍然影响时间轴与之后的帧
+			maxLineWidth = FMath::Max(maxLineWidth, (int)id.Width);
+			mFrames.Add(offset, rect, frameGCB, remap);
+		}
+		break;
+		case EXTENSION_RECORD_TYPE:
+		{
+			int extCode = 0;
+			GifByteType* extData = nullptr;
+			if (DGifGetExtension(mGIF, &extCode, &extData) == GIF_ERROR)
+				break;
+
+			if (extCode == GRAPHICS_EXT_FUNC_CODE && extData)
+				DGifExtensionToGCB(extData[0], &extData[1], &pendingGCB);
+
+			while (extData)
+			{
+				if (DGifGetExtensionNext(mGIF, &extData) == GIF_ERROR)
+					break;
+			}
+		}
+		break;
+		default:
+			break;
+		}
+	} while (recordType != TERMINATE_RECORD_TYPE && mGIF->Error == 0);
+
+	// 截断的文件：保留已经完整索引的帧
+	if (mFrames.Num() == 0)
+		return false;
+	if (mGIF->Error != 0)
+	{
+		FString Error(GifErrorString(mGIF->Error));
+		UE_LOG(LogAnimTexture, Warning, TEXT("FGIFDecoder: GIF file is truncated (%s), playing the first %d frames."), *Error, mFrames.Num());
+		mGIF->Error = 0;
+	}
+
+	mLineBuffer.SetNumUninitialized(maxLineWidth);
+	return true;
+}
+
+void FGIFDecoder::BuildSharedPalette()
+{
+	if (!mPalette.bValid)
+		return;
+
+	// 透明像素占一项；背景色不在调色板里（或没有全局调色板）时清除成黑色，也占一项
+	const int bg = mGIF->SBackGroundColor;
+	bool bNeedBlack = mGlobalRemap == INDEX_NONE || bg < 0 || bg > 255;
+	for (int32 i = 0; i < mPalette.GetNumRemaps() && !bNeedBlack; i++)
+		bNeedBlack = mPalette.GetRemap(i)[bg] < 0;
+
+	const int32 transparentSlot = mFrames.bHasTransparency ? mPalette.FindOrAddColor(FColor(0, 0, 0, 0)) : 0;
+	const int32 blackSlot = bNeedBlack ? mPalette.FindOrAddColor(FColor(0, 0, 0, 255)) : 0;
+	if (transparentSlot == INDEX_NONE || blackSlot == INDEX_NONE)
+	{
+		mPalette.bValid = false;
+		return;
+	}
+
+	mTransparentSlot = static_cast<uint8>(transparentSlot);
+	mBlackSlot = static_cast<uint8>(blackSlot);
+
+	// GetPalette 总是 256 项，未使用的项为黑色透明
+	mPalette.Colors.SetNumZeroed(256);
+}
+
+bool FGIFDecoder::SetIndexedOutput(bool bEnable)
+{
+	if (bEnable && !SupportsIndexedOutput())
+		return false;
+	if (!mGIF)
+		return !bEnable;
+
+	// 两种画布只保留当前使用的一种
+	mIndexed = bEnable;
+	const int32 numPixels = mGIF->SWidth * mGIF->SHeight;
+	if (mIndexed)
+	{
+		mFrameBuffer.Empty();
+		mIndexBuffer.SetNumUninitialized(numPixels);
+	}
+	else
+	{
+		mIndexBuffer.Empty();
+		mFrameBuffer.SetNumUninitialized(numPixels);
+	}
+	ClearFrameBuffer(mGIF->SColorMap, true);
+	SetSnapshotInterval(mSnapshotInterval);
+
+	Reset();
+	return true;
+}
+
+void FGIFDecoder::SetSnapshotInterval(int32 Interval)
+{
+	mSnapshotInterval = Interval;
+	mSnapshots.Init(mIndexed ? 0 : Interval, mFrames.Num());
+	mIndexSnapshots.Init(mIndexed ? Interval : 0, mFrames.Num());
+}
+
+bool FGIFDecoder::SkipImageData()
+{
+	GifByteType* codeBlock = nullptr;
+	do
+	{
+		if (DGifGetCodeNext(mGIF, &codeBlock) == GIF_ERROR)
+			return false;
+	} while (codeBlock);
+
+	return true;
+}
+
+bool FGIFDecoder::DecodeImageRows(int32 FrameIndex, ColorMapObject* colorMap, int transparentColor)
+{
+	// 全局调色板的 LUT 在加载时构建；局部调色板每帧都会重新读取，随之重建。
+	// 索引输出只需要把帧的重映射表和透明色合成一张索引 LUT
+	FGIFPaletteLUT& LUT = colorMap == mGIF->SColorMap ? mGlobalLUT : mLocalLUT;
+	if (mIndexed)
+	{
+		const int32 remap = mFrames.Remap[FrameIndex];
+		if (remap == INDEX_NONE)
+			return true;
+		mIndexLUT.Build(mPalette.GetRemap(remap), transparentColor, mDoNotDispose, mTransparentSlot);
+	}
+	else if (&LUT == &mLocalLUT)
+	{
+		LUT.Build(colorMap);
+	}
+	FScopedTransparentColor ScopedTransparent(LUT, transparentColor, mDoNotDispose);
+
+	const FIntRect& rect = mFrames.Rect[FrameIndex];
+	const int frameLeft = rect.Min.X;
+	const int frameTop = rect.Min.Y;
+	const int imageWidth = rect.Width();
+	const int imageHeight = rect.Height();
+
+	const int frameWidth = GetWidth();
+	const int frameHeight = GetHeight();
+	const bool bInterlace = mGIF->Image.Interlace;
+
+	// 边界安全：对帧子图像区域进行画布边界裁剪
+	const int clampedLeft = FMath::Max(0, frameLeft);
+	const int clampedRight = FMath::Min(frameWidth, rect.Max.X);
+
+	// 交错存储的行顺序：4 个 pass
+	static const int InterlacedOffset[] = { 0, 4, 2, 1 };
+	static const int InterlacedJumps[] = { 8, 8, 4, 2 };
+
+	const int numPasses = bInterlace ? 4 : 1;
+	for (int pass = 0; pass < numPasses; pass++)
+	{
+		const int firstRow = bInterlace ? InterlacedOffset[pass] : 0;
+		const int rowStep = bInterlace ? InterlacedJumps[pass] : 1;
+
+		for (int row = firstRow; row < imageHeight; row += rowStep)
+		{
+			// 画布外的行也必须解压，LZW 流只能顺序读取
+			if (DGifGetLine(mGIF, mLineBuffer.GetData(), imageWidth) == GIF_ERROR)
+				return false;
+
+			const int y = frameTop + row;
+			if (y < 0 || y >= frameHeight)
+				continue;
+
+			// 整行查表展开并合成，越界索引和透明色已在 LUT 中处理
+			const GifPixelType* line = mLineBuffer.GetData() + (clampedLeft - frameLeft);
+			if (mIndexed)
+			{
+				uint8* outRow = mIndexBuffer.GetData() + y * frameWidth + clampedLeft;
+				GIFCompositeIndexRow(outRow, line, clampedRight - clampedLeft, mIndexLUT);
+			}
+			else
+			{
+				FColor* outRow = mFrameBuffer.GetData() + y * frameWidth + clampedLeft;
+				GIFCompositeRow(outRow, line, clampedRight - clampedLeft, LUT);
+			}
+		}  // end of row
+	}  // end of pass
+
+	return true;
+}
+
 void FGIFDecoder::Close()
 {
 	if (mGIF)
@@ -57,139 +294,205 @@ void FGIFDecoder::Close()
 		mGIF = nullptr;
 	}
 
+	mInput = FInputCursor();
+	mFrames.Empty();
+	mLineBuffer.Empty();
 	mFrameBuffer.Empty();
+	mSnapshots.Init(0, 0);
+	mSnapshotInterval = 0;
+
+	mIndexed = false;
+	mPalette.Reset();
+	mGlobalRemap = INDEX_NONE;
+	mIndexBuffer.Empty();
+	mIndexSnapshots.Init(0, 0);
+}
+
+void FGIFDecoder::AdvanceFrame(bool bLooping)
+{
+	mCurrentFrame++;
+	if (mCurrentFrame >= mFrames.Num()) {
+		mDoNotDispose = false;
+		mCurrentFrame = bLooping ? 0 : mFrames.Num() - 1;
+		mLoopCount++;
+	}
 }
 
 uint32 FGIFDecoder::NextFrame(uint32 DefaultFrameDelay, bool bLooping)
 {
-	if (!mGIF) return DefaultFrameDelay;
+	mDirtyRect = FIntRect();
+	if (!mGIF || mFrames.Num() == 0) return DefaultFrameDelay;
+
+	// 热路径只读帧元数据表
+	const int32 frameIndex = mCurrentFrame;
+	mLastFrame = frameIndex;
+	const FIntRect& frameRect = mFrames.Rect[frameIndex];
+	const int delayTime = mFrames.DelayMs[frameIndex];
+	const int transparentColor = mFrames.TransparentIndex[frameIndex];
+
+	// 回到该帧的图像描述符，重新读取局部调色板并初始化 LZW 解压状态
+	mInput.Pos = mFrames.Offset[frameIndex];
+	if (DGifGetImageHeader(mGIF) == GIF_ERROR)
+	{
+		FString Error(GifErrorString(mGIF->Error));
+		UE_LOG(LogAnimTexture, Warning, TEXT("FGIFDecoder: Frame %d header read failed, %s."), mCurrentFrame, *Error);
+		mGIF->Error = 0;
+		AdvanceFrame(bLooping);
+		return delayTime == 0 ? DefaultFrameDelay : delayTime;
+	}
 
-	const SavedImage& image = mGIF->SavedImages[mCurrentFrame];
-	const auto& id = image.ImageDesc;
-	int frameWidth = GetWidth();
 	ColorMapObject* colorMap =
-		image.ImageDesc.ColorMap ? image.ImageDesc.ColorMap : mGIF->SColorMap;
+		mGIF->Image.ColorMap ? mGIF->Image.ColorMap : mGIF->SColorMap;
 
 	// handle GCB
-	int delayTime = 0;
-	int transparentColor = -1;
-
-	for (int i = 0; i < image.ExtensionBlockCount; i++)
+	switch (mFrames.Disposal[frameIndex])
 	{
-		const ExtensionBlock& eb = image.ExtensionBlocks[i];
-		if (eb.Function == GRAPHICS_EXT_FUNC_CODE)
-		{
-			GraphicsControlBlock gcb;
-			if (DGifExtensionToGCB(eb.ByteCount, eb.Bytes, &gcb) != GIF_ERROR)
-			{
-				delayTime = gcb.DelayTime * 10;  // 1/100 second
-				if (gcb.TransparentColor != NO_TRANSPARENT_COLOR)
-					transparentColor = gcb.TransparentColor;
-
-				switch (gcb.DisposalMode)
-				{
-				case DISPOSAL_UNSPECIFIED:
-					// No disposal specified. The decoder is not required to take any
-					// action.
-					break;
-				case DISPOSE_DO_NOT:
-					// Do not dispose. The graphic is to be left in place.
-					mDoNotDispose = true;
-					break;
-				case DISPOSE_BACKGROUND:
-					//  Restore to background color. The area used by the graphic must
-					//  be restored to the background color.
-					if (!mDoNotDispose)  // MY HACK!!!
-						GCB_Background(id.Left, id.Top, id.Width, id.Height, colorMap,
-							transparentColor != NO_TRANSPARENT_COLOR);
-					break;
-				case DISPOSE_PREVIOUS:
-					// Restore to previous. The decoder is required to restore the area
-					// overwritten by the graphic with what was there prior to rendering
-					// the graphic.
-					//std::cout << "DISPOSE_PREVIOUS" << std::endl;
-					break;
-				}// end of switch
-			}
-		}  // end of if
-	}    // end of for
+	case DISPOSAL_UNSPECIFIED:
+		// No disposal specified. The decoder is not required to take any
+		// action.
+		break;
+	case DISPOSE_DO_NOT:
+		// Do not dispose. The graphic is to be left in place.
+		mDoNotDispose = true;
+		break;
+	case DISPOSE_BACKGROUND:
+		//  Restore to background color. The area used by the graphic must
+		//  be restored to the background color.
+		if (!mDoNotDispose)  // MY HACK!!!
+			GCB_Background(frameRect.Min.X, frameRect.Min.Y, frameRect.Width(), frameRect.Height(), colorMap,
+				mFrames.Remap[frameIndex], transparentColor != NO_TRANSPARENT_COLOR);
+		break;
+	case DISPOSE_PREVIOUS:
+		// Restore to previous. The decoder is required to restore the area
+		// overwritten by the graphic with what was there prior to rendering
+		// the graphic.
+		break;
+	}// end of switch
 
 	// first frame -- draw the background
 	if (mCurrentFrame == 0)
 	{
 		ClearFrameBuffer(mGIF->SColorMap,
 			transparentColor != NO_TRANSPARENT_COLOR);
+		mDirtyRect = FIntRect(0, 0, GetWidth(), GetHeight());
 	}
 
 	// 边界安全：colorMap 空指针检查
 	if (!colorMap)
 	{
 		UE_LOG(LogAnimTexture, Warning, TEXT("FGIFDecoder: Frame %d has no color map, skipping."), mCurrentFrame);
-		mCurrentFrame++;
-		if (mCurrentFrame >= mGIF->ImageCount) {
-			mDoNotDispose = false;
-			mCurrentFrame = bLooping ? 0 : mGIF->ImageCount - 1;
-			mLoopCount++;
-		}
+		AdvanceFrame(bLooping);
 		return delayTime == 0 ? DefaultFrameDelay : delayTime;
 	}
 
-	// 边界安全：对帧子图像区域进行画布边界裁剪
-	const int frameHeight = GetHeight();
-	const int clampedLeft = FMath::Max(0, (int)id.Left);
-	const int clampedTop = FMath::Max(0, (int)id.Top);
-	const int clampedRight = FMath::Min(frameWidth, (int)(id.Left + id.Width));
-	const int clampedBottom = FMath::Min(frameHeight, (int)(id.Top + id.Height));
+	const int clampedLeft = FMath::Max(0, frameRect.Min.X);
+	const int clampedTop = FMath::Max(0, frameRect.Min.Y);
+	const int clampedRight = FMath::Min((int)GetWidth(), frameRect.Max.X);
+	const int clampedBottom = FMath::Min((int)GetHeight(), frameRect.Max.Y);
+	mDirtyRect = UnionRect(mDirtyRect, FIntRect(clampedLeft, clampedTop, clampedRight, clampedBottom));
 
-	// decode current image to frame buffer
-	for (int y = clampedTop; y < clampedBottom; y++)
+	// decode current image to frame buffer, line by line
+	if (!DecodeImageRows(frameIndex, colorMap, transparentColor))
 	{
-		for (int x = clampedLeft; x < clampedRight; x++)
+		// 损坏的 LZW 数据：保留已解出的行
+		FString Error(GifErrorString(mGIF->Error));
+		UE_LOG(LogAnimTexture, Warning, TEXT("FGIFDecoder: Frame %d decode failed, %s."), mCurrentFrame, *Error);
+		mGIF->Error = 0;
+	}
+	if (mIndexed)
+		mIndexSnapshots.Capture(frameIndex, mIndexBuffer);
+	else
+		mSnapshots.Capture(frameIndex, mFrameBuffer);
+
+	// next frame
+	AdvanceFrame(bLooping);
+
+	return delayTime == 0 ? DefaultFrameDelay : delayTime;
+}
+
+void FGIFDecoder::SkipFrames(uint32 NumFrames, uint32 DefaultFrameDelay, bool bLooping, FIntRect& InOutDirtyRect)
+{
+	if (!mGIF || mFrames.Num() == 0 || NumFrames == 0)
+		return;
+
+	// 在被跳过的帧和紧随其后的目标帧中找最后一个关键帧，它之前的帧会被完整覆盖，不必解码
+	uint32 NumJump = 0;
+	int32 frame = mCurrentFrame;
+	for (uint32 i = 0; i <= NumFrames; i++)
+	{
+		if (mFrames.KeyFrame[frame])
+			NumJump = i;
+
+		frame++;
+		if (frame >= mFrames.Num())
+			frame = bLooping ? 0 : mFrames.Num() - 1;
+	}
+
+	if (NumJump > 0)
+	{
+		for (uint32 i = 0; i < NumJump; i++)
 		{
-			int p = y * frameWidth + x;
-			int i = (y - id.Top) * id.Width + x - id.Left;
-			int c = image.RasterBits[i];
-			FColor& out = mFrameBuffer[p];
+			mLastFrame = mCurrentFrame;
+			AdvanceFrame(bLooping);
+		}
 
-			// 边界安全：检查颜色索引是否在 colorMap 范围内
-			if (c < 0 || c >= colorMap->ColorCount)
-				continue;
+		// 关键帧会重画整张画布
+		mDoNotDispose = mCurrentFrame > 0 && mFrames.DoNotDispose[mCurrentFrame - 1];
+		InOutDirtyRect = FIntRect(0, 0, GetWidth(), GetHeight());
+	}
 
-			const GifColorType& colorEntry = colorMap->Colors[c];
-			if (mDoNotDispose)
-			{
-				if (c != transparentColor)
-				{
-					out.R = colorEntry.Red;
-					out.G = colorEntry.Green;
-					out.B = colorEntry.Blue;
-					out.A = 255;
-				}
-			}
-			else
-			{
-				out.R = colorEntry.Red;
-				out.G = colorEntry.Green;
-				out.B = colorEntry.Blue;
-				out.A = (c == transparentColor ? 0 : 255);
-			}
-		}// end of x
-	}  // end of y
+	for (uint32 i = NumJump; i < NumFrames; i++)
+	{
+		NextFrame(DefaultFrameDelay, bLooping);
+		InOutDirtyRect = UnionRect(InOutDirtyRect, mDirtyRect);
+	}
+}
 
-	// next frame
-	mCurrentFrame++;
-	if (mCurrentFrame >= mGIF->ImageCount) {
-		mDoNotDispose = false;
-		mCurrentFrame = bLooping ? 0 : mGIF->ImageCount - 1;
-		mLoopCount++;
+void FGIFDecoder::SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay)
+{
+	if (!mGIF || mFrames.Num() == 0)
+		return;
+
+	// 从关键帧、快照、当前位置中离目标最近的一个开始解码
+	const int32 target = FMath::Clamp(FrameIndex, 0, mFrames.Num() - 1);
+	const int32 keyFrame = mFrames.FindKeyFrame(target);
+	const int32 snapshot = mIndexed ? mIndexSnapshots.FindBefore(target) : mSnapshots.FindBefore(target);
+
+	if (mCurrentFrame <= target && mCurrentFrame >= FMath::Max(keyFrame, snapshot + 1))
+	{
+		// 当前位置最近，直接向前解码
+	}
+	else if (snapshot >= keyFrame)
+	{
+		if (mIndexed)
+		{
+			const TArray<uint8>& canvas = mIndexSnapshots.Get(snapshot);
+			FMemory::Memcpy(mIndexBuffer.GetData(), canvas.GetData(), canvas.Num());
+		}
+		else
+		{
+			const TArray<FColor>& canvas = mSnapshots.Get(snapshot);
+			FMemory::Memcpy(mFrameBuffer.GetData(), canvas.GetData(), canvas.Num() * sizeof(FColor));
+		}
+		mLastFrame = snapshot;
+		mCurrentFrame = snapshot + 1;
+		mDoNotDispose = mFrames.DoNotDispose[snapshot];
+	}
+	else
+	{
+		mLastFrame = keyFrame - 1;
+		mCurrentFrame = keyFrame;
+		mDoNotDispose = keyFrame > 0 && mFrames.DoNotDispose[keyFrame - 1];
 	}
 
-	return delayTime == 0 ? DefaultFrameDelay : delayTime;
+	while (mCurrentFrame < target)
+		NextFrame(DefaultFrameDelay, false);
 }
 
 void FGIFDecoder::Reset()
 {
 	mCurrentFrame = 0;
+	mLastFrame = INDEX_NONE;
 	mLoopCount = 0;
 	mDoNotDispose = false;
 }
@@ -212,63 +515,28 @@ uint32 FGIFDecoder::GetHeight() const
 
 const FColor* FGIFDecoder::GetFrameBuffer() const
 {
-	return mFrameBuffer.GetData();
+	return mIndexed ? nullptr : mFrameBuffer.GetData();
 }
 
 uint32 FGIFDecoder::GetDuration(uint32 DefaultFrameDelay) const
 {
-	if (!mGIF)
-		return 0;
-
-	int duration = 0;
-	for (int i = 0; i < mGIF->ImageCount; i++)
-	{
-		const SavedImage& image = mGIF->SavedImages[i];
-		int delayTime = 0;
-		for (int j = 0; j < image.ExtensionBlockCount; j++)
-		{
-			const ExtensionBlock& eb = image.ExtensionBlocks[j];
-			if (eb.Function == GRAPHICS_EXT_FUNC_CODE)
-			{
-				GraphicsControlBlock gcb;
-				if (DGifExtensionToGCB(eb.ByteCount, eb.Bytes, &gcb) != GIF_ERROR)
-					delayTime = gcb.DelayTime * 10;  // 1/100 second
-			}
-		}// end of for(ext)
-		duration += delayTime == 0 ? DefaultFrameDelay : delayTime;
-	}
-
-	return duration;
+	return mFrames.GetDuration(DefaultFrameDelay);
 }
 
 bool FGIFDecoder::SupportsTransparency() const
 {
-	if (!mGIF)
-		return false;
-
-	for (int i = 0; i < mGIF->ImageCount; i++)
-	{
-		const SavedImage& image = mGIF->SavedImages[i];
-		for (int j = 0; j < image.ExtensionBlockCount; j++)
-		{
-			const ExtensionBlock& eb = image.ExtensionBlocks[j];
-			if (eb.Function == GRAPHICS_EXT_FUNC_CODE)
-			{
-				GraphicsControlBlock gcb;
-				if (DGifExtensionToGCB(eb.ByteCount, eb.Bytes, &gcb) != GIF_ERROR)
-				{
-					if (gcb.TransparentColor != NO_TRANSPARENT_COLOR)
-						return true;
-				}
-			}
-		}// end of for(ext)
-	}
-	return false;
+	return mFrames.bHasTransparency;
 }
 
 void FGIFDecoder::ClearFrameBuffer(ColorMapObject* ColorMap,
 	bool bTransparent) 
 {
+	if (mIndexed)
+	{
+		FMemory::Memset(mIndexBuffer.GetData(), GetBackgroundIndex(mGlobalRemap, bTransparent), mIndexBuffer.Num());
+		return;
+	}
+
 	FColor bg = { 0, 0, 0, 255 };
 
 	// 边界安全：使用传入的 ColorMap（而非 mGIF->SColorMap）进行验证和取色
@@ -284,8 +552,19 @@ void FGIFDecoder::ClearFrameBuffer(ColorMapObject* ColorMap,
 	for (auto& pixel : mFrameBuffer) pixel = bg;
 }
 
+uint8 FGIFDecoder::GetBackgroundIndex(int32 RemapIndex, bool bTransparent) const
+{
+	if (bTransparent)
+		return mTransparentSlot;
+
+	const int bg = mGIF->SBackGroundColor;
+	if (RemapIndex != INDEX_NONE && bg >= 0 && bg < 256 && mPalette.GetRemap(RemapIndex)[bg] >= 0)
+		return static_cast<uint8>(mPalette.GetRemap(RemapIndex)[bg]);
+	return mBlackSlot;
+}
+
 void FGIFDecoder::GCB_Background(int left, int top, int width, int height,
-	ColorMapObject* colorMap,
+	ColorMapObject* colorMap, int32 remapIndex,
 	bool bTransparent)
 {
 	// 边界安全：检查 colorMap 和背景色索引
@@ -304,6 +583,15 @@ void FGIFDecoder::GCB_Background(int left, int top, int width, int height,
 	const int clampedTop = FMath::Max(0, top);
 	const int clampedRight = FMath::Min(frameWidth, left + width);
 	const int clampedBottom = FMath::Min(frameHeight, top + height);
+	mDirtyRect = UnionRect(mDirtyRect, FIntRect(clampedLeft, clampedTop, clampedRight, clampedBottom));
+
+	if (mIndexed)
+	{
+		const uint8 bgIndex = GetBackgroundIndex(remapIndex, bTransparent);
+		for (int y = clampedTop; y < clampedBottom && clampedRight > clampedLeft; y++)
+			FMemory::Memset(mIndexBuffer.GetData() + y * frameWidth + clampedLeft, bgIndex, clampedRight - clampedLeft);
+		return;
+	}
 
 	for (int y = clampedTop; y < clampedBottom; y++)
 	{
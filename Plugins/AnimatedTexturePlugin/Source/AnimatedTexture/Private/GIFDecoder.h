@@ -12,8 +12,170 @@
 
 #include "CoreMinimal.h"
 #include "AnimatedTextureDecoder.h"
+#include "GIFPaletteKernel.h"
 #include "giflib/gif_lib.h"
 
+/**
+ * GIF 帧元数据表（struct-of-arrays）
+ *
+ * 加载时解析一次所有 GCB，播放热路径只读这张表，不再遍历扩展块。
+ * DelayMs 为 0 表示文件未指定延迟，播放时使用 DefaultFrameDelay；
+ * 累计时间拆成「已指定延迟之和」与「未指定延迟的帧数」两部分，使 DefaultFrameDelay 改变后无需重建。
+ */
+struct FGIFFrameTable
+{
+	TArray<uint32> Offset;			// 图像描述符（紧跟 ',' 之后）在文件中的偏移
+	TArray<uint32> DelayMs;
+	TArray<uint8> Disposal;			// DISPOSAL_UNSPECIFIED / DISPOSE_DO_NOT / DISPOSE_BACKGROUND / DISPOSE_PREVIOUS
+	TArray<int16> TransparentIndex;	// NO_TRANSPARENT_COLOR(-1) 表示不透明
+	TArray<FIntRect> Rect;			// 文件中记录的子图像区域（未裁剪）
+	TArray<int32> Remap;			// 调色板在 FGIFSharedPalette 中的重映射表，INDEX_NONE 表示无法合并
+
+	// 关键帧：解码结果不依赖之前的画布（第 0 帧，或覆盖整张画布且不露出上一帧的帧）
+	// DoNotDispose：解码完该帧之后解码器的 mDoNotDispose 状态，跳帧时据此恢复
+	TBitArray<> KeyFrame;
+	TBitArray<> DoNotDispose;
+
+	// 第 i 帧的开始时间 = StartDelayMs[i] + StartDefaultCount[i] * DefaultFrameDelay，
+	// 两个数组都比帧数多一个元素，最后一个元素对应总时长
+	TArray<uint32> StartDelayMs;
+	TArray<uint32> StartDefaultCount;
+
+	bool bHasTransparency = false;
+
+	int32 Num() const { return Offset.Num(); }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Offset.GetAllocatedSize() + DelayMs.GetAllocatedSize() + Disposal.GetAllocatedSize()
+			+ TransparentIndex.GetAllocatedSize() + Rect.GetAllocatedSize() + Remap.GetAllocatedSize()
+			+ KeyFrame.GetAllocatedSize() + DoNotDispose.GetAllocatedSize()
+			+ StartDelayMs.GetAllocatedSize() + StartDefaultCount.GetAllocatedSize();
+	}
+
+	void Reset()
+	{
+		Offset.Reset();
+		DelayMs.Reset();
+		Disposal.Reset();
+		TransparentIndex.Reset();
+		Rect.Reset();
+		Remap.Reset();
+		KeyFrame.Reset();
+		DoNotDispose.Reset();
+		StartDelayMs.Reset();
+		StartDefaultCount.Reset();
+		StartDelayMs.Add(0);
+		StartDefaultCount.Add(0);
+		bHasTransparency = false;
+	}
+
+	void Empty()
+	{
+		Reset();
+		KeyFrame.Empty();
+		DoNotDispose.Empty();
+		StartDelayMs.Empty();
+		StartDefaultCount.Empty();
+	}
+
+	void Add(uint32 InOffset, const FIntRect& InRect, const GraphicsControlBlock& GCB, int32 InRemap)
+	{
+		if (StartDelayMs.Num() == 0)
+			Reset();
+
+		const uint32 delay = FMath::Max(GCB.DelayTime, 0) * 10;  // 1/100 second
+		Offset.Add(InOffset);
+		DelayMs.Add(delay);
+		Disposal.Add(static_cast<uint8>(GCB.DisposalMode));
+		TransparentIndex.Add(static_cast<int16>(GCB.TransparentColor));
+		Rect.Add(InRect);
+		Remap.Add(InRemap);
+		StartDelayMs.Add(StartDelayMs.Last() + delay);
+		StartDefaultCount.Add(StartDefaultCount.Last() + (delay == 0 ? 1 : 0));
+		bHasTransparency |= GCB.TransparentColor != NO_TRANSPARENT_COLOR;
+	}
+
+	/**
+	 * 所有帧加入之后调用，按 FGIFDecoder 的合成规则标记关键帧：
+	 * 不清除模式（DISPOSE_DO_NOT）一旦出现，直到循环回第 0 帧之前，透明像素都会露出上一帧
+	 */
+	void BuildKeyFrames(int32 CanvasWidth, int32 CanvasHeight)
+	{
+		KeyFrame.Init(false, Num());
+		DoNotDispose.Init(false, Num());
+
+		bool bDoNotDispose = false;
+		for (int32 i = 0; i < Num(); i++)
+		{
+			bDoNotDispose |= Disposal[i] == DISPOSE_DO_NOT;
+			DoNotDispose[i] = bDoNotDispose;
+
+			const bool bFullCanvas = Rect[i].Min.X <= 0 && Rect[i].Min.Y <= 0
+				&& Rect[i].Max.X >= CanvasWidth && Rect[i].Max.Y >= CanvasHeight;
+			KeyFrame[i] = i == 0
+				|| (bFullCanvas && (TransparentIndex[i] == NO_TRANSPARENT_COLOR || !bDoNotDispose));
+		}
+	}
+
+	/** FrameIndex（含）之前最近的关键帧 */
+	int32 FindKeyFrame(int32 FrameIndex) const
+	{
+		for (int32 i = FMath::Min(FrameIndex, Num() - 1); i > 0; i--)
+		{
+			if (KeyFrame[i])
+				return i;
+		}
+		return 0;
+	}
+
+	uint32 GetFrameDelay(int32 Index, uint32 DefaultFrameDelay) const
+	{
+		return DelayMs[Index] == 0 ? DefaultFrameDelay : DelayMs[Index];
+	}
+
+	uint32 GetStartTime(int32 Index, uint32 DefaultFrameDelay) const
+	{
+		return StartDelayMs[Index] + StartDefaultCount[Index] * DefaultFrameDelay;
+	}
+
+	uint32 GetDuration(uint32 DefaultFrameDelay) const
+	{
+		return Num() > 0 ? GetStartTime(Num(), DefaultFrameDelay) : 0;
+	}
+
+	/** 开始时间 <= TimeMs 的最后一帧；超出总时长时返回最后一帧 */
+	int32 FindFrameAtTime(uint32 TimeMs, uint32 DefaultFrameDelay) const
+	{
+		if (Num() == 0)
+			return INDEX_NONE;
+
+		int32 Lo = 0;
+		int32 Hi = Num() - 1;
+		while (Lo < Hi)
+		{
+			const int32 Mid = (Lo + Hi + 1) / 2;
+			if (GetStartTime(Mid, DefaultFrameDelay) <= TimeMs)
+				Lo = Mid;
+			else
+				Hi = Mid - 1;
+		}
+		return Lo;
+	}
+};
+
+/**
+ * GIF 流式解码
+ *
+ * - LoadFromMemory 只做一遍记录级扫描（DGifGetRecordType），建立帧索引：每帧图像描述符在文件中的偏移、
+ *   子图像区域以及 GCB（存入 FGIFFrameTable），LZW 数据只跳过不解压；
+ * - 播放时 NextFrame 把输入游标定位到当前帧，用 DGifGetImageHeader + DGifGetLine 逐行解压并直接合成到画布；
+ * - 常驻内存只有画布和一行索引缓冲，与帧数无关；
+ * - 建立索引时顺带把所有调色板合并成一个共用调色板，不超过 256 色时可以输出 8 位索引画布（SetIndexedOutput），
+ *   合成只做索引重映射，不展开成 BGRA。
+ *
+ * 注意：解码器直接引用 LoadFromMemory 传入的内存，调用方需保证其在 Close 之前有效。
+ */
 class FGIFDecoder : public FAnimatedTextureDecoder
 {
 public:
@@ -25,24 +187,85 @@ public:
 
 	virtual uint32 NextFrame(uint32 DefaultFrameDelay, bool bLooping) override;
 	virtual void Reset() override;
+	virtual void SkipFrames(uint32 NumFrames, uint32 DefaultFrameDelay, bool bLooping, FIntRect& InOutDirtyRect) override;
+	virtual void SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay) override;
+	virtual void SetSnapshotInterval(int32 Interval) override;
+	virtual int32 GetCurrentFrame() const override { return mLastFrame; }
 
 	virtual uint32 GetWidth() const override;
 	virtual uint32 GetHeight() const override;
 	virtual const FColor* GetFrameBuffer() const override;
 
+	virtual bool SupportsIndexedOutput() const override { return mPalette.bValid && mPalette.Colors.Num() > 0; }
+	virtual bool SetIndexedOutput(bool bEnable) override;
+	virtual bool IsIndexedOutput() const override { return mIndexed; }
+	virtual const FColor* GetPalette() const override { return SupportsIndexedOutput() ? mPalette.Colors.GetData() : nullptr; }
+	virtual const uint8* GetIndexBuffer() const override { return mIndexed ? mIndexBuffer.GetData() : nullptr; }
+
+	virtual uint32 GetNumFrames() const override { return mFrames.Num(); }
+	virtual uint32 GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const override { return mFrames.GetFrameDelay(FrameIndex, DefaultFrameDelay); }
 	virtual uint32 GetDuration(uint32 DefaultFrameDelay) const override;
+	virtual uint32 GetFrameStartTime(uint32 FrameIndex, uint32 DefaultFrameDelay) const override { return mFrames.GetStartTime(FrameIndex, DefaultFrameDelay); }
 	virtual bool SupportsTransparency() const override;
+	virtual FIntRect GetDirtyRect() const override { return mDirtyRect; }
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		return mFrames.GetAllocatedSize() + mLineBuffer.GetAllocatedSize() + mFrameBuffer.GetAllocatedSize()
+			+ mSnapshots.GetAllocatedSize() + mPalette.GetAllocatedSize() + mIndexBuffer.GetAllocatedSize()
+			+ mIndexSnapshots.GetAllocatedSize();
+	}
+
+	/** 二分查找 TimeMs（0 ~ GetDuration）所在的帧，O(log n) */
+	virtual int32 FindFrameAtTime(uint32 TimeMs, uint32 DefaultFrameDelay) const override { return mFrames.FindFrameAtTime(TimeMs, DefaultFrameDelay); }
 
 private:
+	/** DGifOpen 的输入游标，使解码器可以随机定位到任意帧 */
+	struct FInputCursor
+	{
+		const uint8* Data = nullptr;
+		uint32 Size = 0;
+		uint32 Pos = 0;
+	};
+
+	static int InputFunc(GifFileType* gifFile, GifByteType* buffer, int length);
+
+	bool BuildFrameIndex();
+	void BuildSharedPalette();
+	bool SkipImageData();
+	bool DecodeImageRows(int32 FrameIndex, ColorMapObject* colorMap, int transparentColor);
+	void AdvanceFrame(bool bLooping);
+
 	void ClearFrameBuffer(ColorMapObject* ColorMap, bool bTransparent);
+
+	/** 索引画布上的背景色：透明色、背景色在调色板中的索引，或调色板不含背景色时的黑色 */
+	uint8 GetBackgroundIndex(int32 RemapIndex, bool bTransparent) const;
 	void GCB_Background(int left, int top, int width, int height,
-		ColorMapObject* colorMap, bool bTransparent);
+		ColorMapObject* colorMap, int32 remapIndex, bool bTransparent);
 
 private:
-	int mCurrentFrame = 0;
+	int mCurrentFrame = 0;		// 下一次 NextFrame 解码的帧
+	int mLastFrame = INDEX_NONE;	// 上一次 NextFrame 解码的帧
 	int mLoopCount = 0;
 	bool mDoNotDispose = false;
+	FIntRect mDirtyRect;
 
 	GifFileType* mGIF = nullptr;
+	FInputCursor mInput;
+	FGIFFrameTable mFrames;
+	TArray<GifPixelType> mLineBuffer;
+	FGIFPaletteLUT mGlobalLUT;
+	FGIFPaletteLUT mLocalLUT;
 	TArray<FColor> mFrameBuffer;
+	FAnimatedTextureSnapshots mSnapshots;	// mFrameBuffer 的快照
+	int32 mSnapshotInterval = 0;
+
+	// 索引输出：mIndexed 时只维护 mIndexBuffer，mFrameBuffer 与 mSnapshots 为空
+	bool mIndexed = false;
+	FGIFSharedPalette mPalette;		// 补齐到 256 项
+	int32 mGlobalRemap = INDEX_NONE;
+	uint8 mTransparentSlot = 0;
+	uint8 mBlackSlot = 0;
+	FGIFIndexLUT mIndexLUT;
+	TArray<uint8> mIndexBuffer;
+	TAnimatedTextureSnapshots<uint8> mIndexSnapshots;
 };
@@ -0,0 +1,357 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Palette expansion and transparency compositing for GIF frames
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "GIFPaletteKernel.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#include <arm_neon.h>
+	#define AT_GIF_KERNEL_NEON 1
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+	#include <emmintrin.h>
+	#define AT_GIF_KERNEL_SSE2 1
+#endif
+
+#ifndef AT_GIF_KERNEL_NEON
+	#define AT_GIF_KERNEL_NEON 0
+#endif
+#ifndef AT_GIF_KERNEL_SSE2
+	#define AT_GIF_KERNEL_SSE2 0
+#endif
+
+static_assert(sizeof(FColor) == sizeof(uint32), "FColor must be packed into 32 bits");
+
+static void SetLUTEntry(FGIFPaletteLUT& LUT, int Index, uint32 Color)
+{
+	LUT.Color[Index] = Color;
+	for (int k = 0; k < 4; k++)
+		LUT.Planes[k][Index] = static_cast<uint8>(Color >> (k * 8));
+}
+
+void FGIFPaletteLUT::Build(const ColorMapObject* ColorMap)
+{
+	const int colorCount = ColorMap ? FMath::Clamp(ColorMap->ColorCount, 0, 256) : 0;
+
+	for (int i = 0; i < colorCount; i++)
+	{
+		const GifColorType& colorEntry = ColorMap->Colors[i];
+		SetLUTEntry(*this, i, FColor(colorEntry.Red, colorEntry.Green, colorEntry.Blue, 255).DWColor());
+		KeepMask[i] = 0;
+	}
+
+	// 边界安全：超出 colorMap 范围的索引保留画布原有像素
+	for (int i = colorCount; i < 256; i++)
+	{
+		SetLUTEntry(*this, i, 0);
+		KeepMask[i] = 0xFFFFFFFFu;
+	}
+
+	NumColors = colorCount;
+	KeepIndex = -1;
+	bBaseHasKeep = colorCount < 256;
+	bHasKeep = bBaseHasKeep;
+}
+
+FScopedTransparentColor::FScopedTransparentColor(FGIFPaletteLUT& InLUT, int TransparentColor, bool bDoNotDispose)
+	: LUT(InLUT)
+{
+	bSavedHasKeep = LUT.bHasKeep;
+	SavedKeepIndex = LUT.KeepIndex;
+	if (TransparentColor < 0 || TransparentColor > 255)
+		return;
+
+	Index = TransparentColor;
+	SavedColor = LUT.Color[Index];
+	SavedMask = LUT.KeepMask[Index];
+
+	if (SavedMask != 0)
+		return;	// 透明色本身越界，保持「保留画布」
+
+	if (bDoNotDispose)
+	{
+		// 不清除模式：透明像素露出上一帧
+		LUT.KeepMask[Index] = 0xFFFFFFFFu;
+		LUT.KeepIndex = Index;
+		LUT.bHasKeep = true;
+	}
+	else
+	{
+		// 透明像素写入 Alpha = 0
+		FColor Transparent(SavedColor);
+		Transparent.A = 0;
+		SetLUTEntry(LUT, Index, Transparent.DWColor());
+	}
+}
+
+FScopedTransparentColor::~FScopedTransparentColor()
+{
+	if (Index >= 0)
+	{
+		SetLUTEntry(LUT, Index, SavedColor);
+		LUT.KeepMask[Index] = SavedMask;
+	}
+	LUT.KeepIndex = SavedKeepIndex;
+	LUT.bHasKeep = bSavedHasKeep;
+}
+
+#if AT_GIF_KERNEL_NEON
+/** 256 项字节表查 16 个索引：TBL 查 [0, 64)，之后每 64 项用 TBX 补上，越界的索引保持之前的结果 */
+static FORCEINLINE uint8x16_t LookupPlane(const uint8* Plane, uint8x16_t Idx)
+{
+	const uint8x16_t Step = vdupq_n_u8(64);
+	uint8x16x4_t T;
+
+	T.val[0] = vld1q_u8(Plane); T.val[1] = vld1q_u8(Plane + 16); T.val[2] = vld1q_u8(Plane + 32); T.val[3] = vld1q_u8(Plane + 48);
+	uint8x16_t R = vqtbl4q_u8(T, Idx);
+	for (int Block = 1; Block < 4; Block++)
+	{
+		Idx = vsubq_u8(Idx, Step);
+		const uint8* B = Plane + Block * 64;
+		T.val[0] = vld1q_u8(B); T.val[1] = vld1q_u8(B + 16); T.val[2] = vld1q_u8(B + 32); T.val[3] = vld1q_u8(B + 48);
+		R = vqtbx4q_u8(R, T, Idx);
+	}
+	return R;
+}
+
+static FORCEINLINE uint8x16x4_t LookupColors(const FGIFPaletteLUT& LUT, uint8x16_t Idx)
+{
+	uint8x16x4_t Px;
+	Px.val[0] = LookupPlane(LUT.Planes[0], Idx);
+	Px.val[1] = LookupPlane(LUT.Planes[1], Idx);
+	Px.val[2] = LookupPlane(LUT.Planes[2], Idx);
+	Px.val[3] = LookupPlane(LUT.Planes[3], Idx);
+	return Px;
+}
+
+/** 每个索引一个字节的掩码，0xFF 表示保留画布 */
+static FORCEINLINE uint8x16_t KeepMask16(const FGIFPaletteLUT& LUT, uint8x16_t Idx)
+{
+	uint8x16_t Keep = vdupq_n_u8(0);
+	if (LUT.NumColors < 256)
+		Keep = vcgeq_u8(Idx, vdupq_n_u8(static_cast<uint8>(LUT.NumColors)));
+	if (LUT.KeepIndex >= 0)
+		Keep = vorrq_u8(Keep, vceqq_u8(Idx, vdupq_n_u8(static_cast<uint8>(LUT.KeepIndex))));
+	return Keep;
+}
+#endif // AT_GIF_KERNEL_NEON
+
+#if AT_GIF_KERNEL_SSE2
+/** 每个索引一个字节的掩码，0xFF 表示保留画布 */
+static FORCEINLINE __m128i KeepMask16(const FGIFPaletteLUT& LUT, __m128i Idx)
+{
+	__m128i Keep = _mm_setzero_si128();
+	if (LUT.NumColors < 256)
+	{
+		// 无符号 Idx >= NumColors  <=>  max(Idx, NumColors) == Idx
+		const __m128i Limit = _mm_set1_epi8(static_cast<char>(LUT.NumColors));
+		Keep = _mm_cmpeq_epi8(_mm_max_epu8(Idx, Limit), Idx);
+	}
+	if (LUT.KeepIndex >= 0)
+		Keep = _mm_or_si128(Keep, _mm_cmpeq_epi8(Idx, _mm_set1_epi8(static_cast<char>(LUT.KeepIndex))));
+	return Keep;
+}
+
+/** x86 没有不依赖 gather 的 256 项查表，4 个颜色逐项读取后用 unpack 拼成一个向量 */
+static FORCEINLINE __m128i LoadColors4(const uint32* Color, const GifPixelType* Src)
+{
+	const __m128i C01 = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)Color[Src[0]]), _mm_cvtsi32_si128((int)Color[Src[1]]));
+	const __m128i C23 = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)Color[Src[2]]), _mm_cvtsi32_si128((int)Color[Src[3]]));
+	return _mm_unpacklo_epi64(C01, C23);
+}
+
+static FORCEINLINE void BlendStore4(uint32* Dst, __m128i V, __m128i M, int Bits)
+{
+	__m128i* Out = (__m128i*)Dst;
+	if (Bits == 0)
+		_mm_storeu_si128(Out, V);
+	else
+		_mm_storeu_si128(Out, _mm_or_si128(_mm_andnot_si128(M, V), _mm_and_si128(M, _mm_loadu_si128(Out))));
+}
+#endif // AT_GIF_KERNEL_SSE2
+
+/** 不需要保留画布：整行直接展开 */
+static void ExpandRow(uint32* Dst, const GifPixelType* Src, int32 Count, const FGIFPaletteLUT& LUT)
+{
+	int32 i = 0;
+
+#if AT_GIF_KERNEL_NEON
+	for (; i + 16 <= Count; i += 16)
+		vst4q_u8(reinterpret_cast<uint8*>(Dst + i), LookupColors(LUT, vld1q_u8(Src + i)));
+#endif
+	// x86：逐项查表本身就是最快的写法，交给编译器展开
+
+	for (; i < Count; i++)
+		Dst[i] = LUT.Color[Src[i]];
+}
+
+/** 有需要保留画布的项：按掩码混合，整组都需要保留时不读不写，都不需要保留时不读画布 */
+static void BlendRow(uint32* Dst, const GifPixelType* Src, int32 Count, const FGIFPaletteLUT& LUT)
+{
+	int32 i = 0;
+
+#if AT_GIF_KERNEL_NEON
+	for (; i + 16 <= Count; i += 16)
+	{
+		const uint8x16_t Idx = vld1q_u8(Src + i);
+		const uint8x16_t Keep = KeepMask16(LUT, Idx);
+		if (vminvq_u8(Keep) == 0xFF)
+			continue;
+
+		uint8* Out = reinterpret_cast<uint8*>(Dst + i);
+		uint8x16x4_t Px = LookupColors(LUT, Idx);
+		if (vmaxvq_u8(Keep) != 0)
+		{
+			const uint8x16x4_t Old = vld4q_u8(Out);
+			for (int k = 0; k < 4; k++)
+				Px.val[k] = vbslq_u8(Keep, Old.val[k], Px.val[k]);
+		}
+		vst4q_u8(Out, Px);
+	}
+#elif AT_GIF_KERNEL_SSE2
+	for (; i + 16 <= Count; i += 16)
+	{
+		const __m128i Idx = _mm_loadu_si128((const __m128i*)(Src + i));
+		const __m128i Keep = KeepMask16(LUT, Idx);
+		const int Bits = _mm_movemask_epi8(Keep);
+		if (Bits == 0xFFFF)
+			continue;
+
+		// 字节掩码扩展成 4 组 32 位掩码
+		const __m128i KeepLo = _mm_unpacklo_epi8(Keep, Keep);
+		const __m128i KeepHi = _mm_unpackhi_epi8(Keep, Keep);
+		const GifPixelType* S = Src + i;
+		uint32* D = Dst + i;
+		if ((Bits & 0x000F) != 0x000F)
+			BlendStore4(D, LoadColors4(LUT.Color, S), _mm_unpacklo_epi16(KeepLo, KeepLo), Bits & 0xF);
+		if ((Bits & 0x00F0) != 0x00F0)
+			BlendStore4(D + 4, LoadColors4(LUT.Color, S + 4), _mm_unpackhi_epi16(KeepLo, KeepLo), (Bits >> 4) & 0xF);
+		if ((Bits & 0x0F00) != 0x0F00)
+			BlendStore4(D + 8, LoadColors4(LUT.Color, S + 8), _mm_unpacklo_epi16(KeepHi, KeepHi), (Bits >> 8) & 0xF);
+		if ((Bits & 0xF000) != 0xF000)
+			BlendStore4(D + 12, LoadColors4(LUT.Color, S + 12), _mm_unpackhi_epi16(KeepHi, KeepHi), (Bits >> 12) & 0xF);
+	}
+#endif
+
+	for (; i < Count; i++)
+	{
+		const uint8 c = Src[i];
+		const uint32 m = LUT.KeepMask[c];
+		Dst[i] = (LUT.Color[c] & ~m) | (Dst[i] & m);
+	}
+}
+
+void GIFCompositeRow(FColor* Dst, const GifPixelType* Src, int32 Count, const FGIFPaletteLUT& LUT)
+{
+	if (Count <= 0)
+		return;
+
+	uint32* out = reinterpret_cast<uint32*>(Dst);
+	if (LUT.bHasKeep)
+		BlendRow(out, Src, Count, LUT);
+	else
+		ExpandRow(out, Src, Count, LUT);
+}
+
+void FGIFSharedPalette::Reset()
+{
+	Colors.Reset();
+	Remaps.Reset();
+	ColorIndices.Reset();
+	RemapHashes.Reset();
+	bValid = true;
+}
+
+int32 FGIFSharedPalette::FindOrAddColor(FColor Color)
+{
+	if (const uint8* Found = ColorIndices.Find(Color.DWColor()))
+		return *Found;
+	if (Colors.Num() >= 256)
+		return INDEX_NONE;
+
+	const int32 Index = Colors.Add(Color);
+	ColorIndices.Add(Color.DWColor(), static_cast<uint8>(Index));
+	return Index;
+}
+
+int32 FGIFSharedPalette::AddColorMap(const ColorMapObject* ColorMap)
+{
+	if (!bValid)
+		return INDEX_NONE;
+
+	int16 Remap[256];
+	const int colorCount = ColorMap ? FMath::Clamp(ColorMap->ColorCount, 0, 256) : 0;
+	for (int i = 0; i < colorCount; i++)
+	{
+		const GifColorType& colorEntry = ColorMap->Colors[i];
+		const int32 Index = FindOrAddColor(FColor(colorEntry.Red, colorEntry.Green, colorEntry.Blue, 255));
+		if (Index == INDEX_NONE)
+		{
+			bValid = false;
+			return INDEX_NONE;
+		}
+		Remap[i] = static_cast<int16>(Index);
+	}
+	for (int i = colorCount; i < 256; i++)
+		Remap[i] = -1;
+
+	// 很多文件每帧都带一份相同的局部调色板，相同的重映射表只保存一份
+	const uint32 Hash = FCrc::MemCrc32(Remap, sizeof(Remap));
+	for (int32 i = 0; i < RemapHashes.Num(); i++)
+	{
+		if (RemapHashes[i] == Hash && FMemory::Memcmp(GetRemap(i), Remap, sizeof(Remap)) == 0)
+			return i;
+	}
+
+	RemapHashes.Add(Hash);
+	Remaps.Append(Remap, 256);
+	return RemapHashes.Num() - 1;
+}
+
+void FGIFIndexLUT::Build(const int16* Remap, int TransparentColor, bool bDoNotDispose, uint8 TransparentSlot)
+{
+	bHasKeep = false;
+	for (int i = 0; i < 256; i++)
+	{
+		const bool bKeep = Remap[i] < 0;
+		Index[i] = bKeep ? 0 : static_cast<uint8>(Remap[i]);
+		KeepMask[i] = bKeep ? 0xFF : 0;
+		bHasKeep |= bKeep;
+	}
+
+	// 与 FScopedTransparentColor 相同：越界的透明色保持「保留画布」，不清除模式下透明像素露出上一帧
+	if (TransparentColor < 0 || TransparentColor > 255 || KeepMask[TransparentColor] != 0)
+		return;
+
+	if (bDoNotDispose)
+	{
+		KeepMask[TransparentColor] = 0xFF;
+		bHasKeep = true;
+	}
+	else
+	{
+		Index[TransparentColor] = TransparentSlot;
+	}
+}
+
+void GIFCompositeIndexRow(uint8* Dst, const GifPixelType* Src, int32 Count, const FGIFIndexLUT& LUT)
+{
+	if (!LUT.bHasKeep)
+	{
+		for (int32 i = 0; i < Count; i++)
+			Dst[i] = LUT.Index[Src[i]];
+		return;
+	}
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const uint8 c = Src[i];
+		const uint8 m = LUT.KeepMask[c];
+		Dst[i] = (LUT.Index[c] & ~m) | (Dst[i] & m);
+	}
+}
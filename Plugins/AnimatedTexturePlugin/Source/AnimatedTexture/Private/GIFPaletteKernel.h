@@ -0,0 +1,122 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Palette expansion and transparency compositing for GIF frames
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "giflib/gif_lib.h"
+
+/**
+ * 256 项调色板查找表
+ *
+ * - Color：颜色索引 -> 打包好的 FColor（与帧缓冲的内存布局一致）；
+ * - Planes：Color 按字节拆成 4 个平面（B、G、R、A），NEON 用 TBL 指令整组查表；
+ * - KeepMask：0xFFFFFFFF 表示保留画布原有像素（越界索引、不清除模式下的透明色），0 表示写入 Color；
+ *   需要保留的索引只有「>= NumColors」与「== KeepIndex」两类，向量实现直接用比较得到掩码，不查 KeepMask；
+ * - 每个调色板只构建一次，每帧只需用 FScopedTransparentColor 修补透明色这一项。
+ */
+struct FGIFPaletteLUT
+{
+	alignas(32) uint32 Color[256];
+	alignas(32) uint32 KeepMask[256];
+	alignas(16) uint8 Planes[4][256];
+
+	int32 NumColors = 0;	// 调色板的有效项数，之后的索引保留画布
+	int32 KeepIndex = -1;	// 保留画布的透明色（不清除模式），-1 表示没有
+
+	/** 调色板本身（不含透明色）是否有需要保留画布的项 */
+	bool bBaseHasKeep = true;
+	/** 当前是否有需要保留画布的项；为 false 时整行直接展开写入，不读画布 */
+	bool bHasKeep = true;
+
+	void Build(const ColorMapObject* ColorMap);
+};
+
+/**
+ * 在作用域内把透明色写入 LUT，离开作用域时恢复，LUT 可以在帧之间复用
+ */
+class FScopedTransparentColor
+{
+public:
+	FScopedTransparentColor(FGIFPaletteLUT& InLUT, int TransparentColor, bool bDoNotDispose);
+	~FScopedTransparentColor();
+
+private:
+	FGIFPaletteLUT& LUT;
+	int Index = -1;
+	uint32 SavedColor = 0;
+	uint32 SavedMask = 0;
+	int32 SavedKeepIndex = -1;
+	bool bSavedHasKeep = true;
+};
+
+/**
+ * 展开一行颜色索引并合成到画布：Dst[i] = KeepMask[Src[i]] ? Dst[i] : Color[Src[i]]
+ *
+ * - NEON：16 个索引一组，用 TBL/TBX 在 4 个字节平面上查表，VBSL 按掩码混合，VST4 交错写回；
+ * - SSE2：没有 gather，x86 上 256 项查表只能逐项读取；掩码由比较得到，整组保留画布时不读不写，
+ *   部分保留时按掩码混合。
+ * 输出与逐像素的标量实现完全一致。
+ */
+void GIFCompositeRow(FColor* Dst, const GifPixelType* Src, int32 Count, const FGIFPaletteLUT& LUT);
+
+/**
+ * 索引上传模式下所有帧共用的调色板（最多 256 色）
+ *
+ * 全局调色板与各帧的局部调色板按颜色合并去重，每个源调色板得到一张「源索引 -> 共用索引」的重映射表，
+ * 内容相同的局部调色板共用一张表。合并后超过 256 色时 bValid 为 false，文件只能按 BGRA 上传。
+ */
+struct FGIFSharedPalette
+{
+	TArray<FColor> Colors;
+	TArray<int16> Remaps;	// 每张表 256 项，-1 表示超出源调色板的索引
+	bool bValid = true;
+
+	void Reset();
+
+	/** 登记一个源调色板，返回它的重映射表编号；颜色超过 256 种时返回 INDEX_NONE */
+	int32 AddColorMap(const ColorMapObject* ColorMap);
+
+	/** 返回颜色在共用调色板中的索引，没有时追加；已满时返回 INDEX_NONE */
+	int32 FindOrAddColor(FColor Color);
+
+	const int16* GetRemap(int32 RemapIndex) const { return Remaps.GetData() + RemapIndex * 256; }
+	int32 GetNumRemaps() const { return Remaps.Num() / 256; }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Colors.GetAllocatedSize() + Remaps.GetAllocatedSize() + ColorIndices.GetAllocatedSize() + RemapHashes.GetAllocatedSize();
+	}
+
+private:
+	TMap<uint32, uint8> ColorIndices;	// FColor::DWColor() -> 索引
+	TArray<uint32> RemapHashes;
+};
+
+/**
+ * 一帧的索引查找表：源索引 -> 共用调色板索引，KeepMask 的含义与 FGIFPaletteLUT 相同。
+ * 每帧由重映射表和透明色构建（512 字节），不需要在帧之间恢复
+ */
+struct FGIFIndexLUT
+{
+	alignas(32) uint8 Index[256];
+	alignas(32) uint8 KeepMask[256];
+	bool bHasKeep = true;
+
+	/**
+	 * @param TransparentSlot	透明像素在共用调色板里的索引（不清除模式下透明像素保留画布，不使用它）
+	 */
+	void Build(const int16* Remap, int TransparentColor, bool bDoNotDispose, uint8 TransparentSlot);
+};
+
+/**
+ * 一行颜色索引重映射后合成到索引画布：Dst[i] = KeepMask[Src[i]] ? Dst[i] : Index[Src[i]]
+ */
+void GIFCompositeIndexRow(uint8* Dst, const GifPixelType* Src, int32 Count, const FGIFIndexLUT& LUT);
@@ -62,8 +62,20 @@ bool UMtlExpTextureSampleParameterAnim::TextureIsValid(UTexture* InTexture, FStr
 	bool Result = false;
 	if (InTexture)
 	{
-		if (InTexture->IsA(UAnimatedTexture2D::StaticClass()))
+		if (const UAnimatedTexture2D* AnimTexture = Cast<UAnimatedTexture2D>(InTexture))
 		{
+			// FrameArray 模式是 Texture2DArray，需要 ParamAnimTextureArray
+			if (AnimTexture->IsFrameArrayMode())
+			{
+				OutMessage = TEXT("FrameArray playback mode requires ParamAnimTextureArray");
+				return false;
+			}
+			// 调色板索引模式采样得到的是索引，需要 ParamAnimTextureIndexed 查表
+			if (AnimTexture->IsPaletteIndexed())
+			{
+				OutMessage = TEXT("Palette indexed textures require ParamAnimTextureIndexed");
+				return false;
+			}
 			Result = true;
 		}
 
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Animated Texture from GIF file
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+
+#include "MtlExpTextureSampleParameterAnimArray.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureFrameArrayTiming.h"
+
+#if WITH_EDITOR
+#include "MaterialCompiler.h"
+#endif // WITH_EDITOR
+
+#define LOCTEXT_NAMESPACE "MaterialExpression"
+
+
+UMtlExpTextureSampleParameterAnimArray::UMtlExpTextureSampleParameterAnimArray(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// 没有引擎内置的 Texture2DArray 默认资源，Texture 留空，由用户指定
+	Texture = nullptr;
+
+#if WITH_EDITORONLY_DATA
+	MenuCategories.Empty();
+	MenuCategories.Add(LOCTEXT("Texture", "Texture"));
+	MenuCategories.Add(LOCTEXT("Parameters", "Parameters"));
+#endif
+}
+
+#if WITH_EDITOR
+int32 UMtlExpTextureSampleParameterAnimArray::Compile(FMaterialCompiler* Compiler, int32 OutputIndex)
+{
+	UAnimatedTexture2D* AnimTexture = Cast<UAnimatedTexture2D>(Texture);
+	if (!AnimTexture || !AnimTexture->IsFrameArrayMode())
+	{
+		return Compiler->Errorf(TEXT("ParamAnimTextureArray requires an AnimatedTexture2D in FrameArray playback mode"));
+	}
+
+	UAnimatedTextureFrameArrayTiming* Timing = AnimTexture->GetFrameArrayTiming();
+	if (!Timing)
+	{
+		return Compiler->Errorf(TEXT("AnimatedTexture '%s' has no frame array yet"), *AnimTexture->GetName());
+	}
+
+	// PlayRate、切片数与循环时长从播放参数纹理读取，运行时修改或重新烘焙都不需要重新编译材质：
+	// (X, Y, Z) = (PlayRate / Length, 1 / Length, N)
+	int32 TimingReferenceIndex = INDEX_NONE;
+	const FName TimingParameterName(*(ParameterName.ToString() + TEXT("Timing")));
+	const int32 TimingCodeIndex = Compiler->TextureParameter(TimingParameterName, Timing, TimingReferenceIndex, SAMPLERTYPE_LinearColor, SSM_FromTextureAsset);
+	if (TimingCodeIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+	const int32 TimingValue = Compiler->TextureSample(TimingCodeIndex, Compiler->Constant2(0.5f, 0.5f), SAMPLERTYPE_LinearColor);
+	const int32 RateOverLength = Compiler->ComponentMask(TimingValue, true, false, false, false);
+	const int32 InvLength = Compiler->ComponentMask(TimingValue, false, true, false, false);
+	const int32 NumSlices = Compiler->ComponentMask(TimingValue, false, false, true, false);
+
+	// t = (Time * PlayRate + Phase) / Length，循环播放：Slice = min(floor(frac(t) * N), N - 1)
+	const int32 TimeIndex = Time.GetTracedInput().Expression ? Time.Compile(Compiler) : Compiler->GameTime(false, 0.0f);
+	int32 CycleIndex = Compiler->Mul(TimeIndex, RateOverLength);
+	if (PhaseOffset.GetTracedInput().Expression)
+	{
+		CycleIndex = Compiler->Add(CycleIndex, Compiler->Mul(PhaseOffset.Compile(Compiler), InvLength));
+	}
+
+	const int32 Cycle = Compiler->Frac(CycleIndex);
+	const int32 SliceIndex = Compiler->Min(
+		Compiler->Floor(Compiler->Mul(Cycle, NumSlices)),
+		Compiler->Sub(NumSlices, Compiler->Constant(1.0f)));
+
+	const int32 UVIndex = Coordinates.GetTracedInput().Expression
+		? Compiler->ComponentMask(Coordinates.Compile(Compiler), true, true, false, false)
+		: Compiler->TextureCoordinate(ConstCoordinate, false, false);
+	const int32 CoordIndex = Compiler->AppendVector(UVIndex, SliceIndex);
+
+	int32 TextureReferenceIndex = INDEX_NONE;
+	const int32 TextureCodeIndex = Compiler->TextureParameter(ParameterName, Texture, TextureReferenceIndex, SamplerType, SamplerSource);
+	if (TextureCodeIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	return Compiler->TextureSample(TextureCodeIndex, CoordIndex, SamplerType);
+}
+
+void UMtlExpTextureSampleParameterAnimArray::GetCaption(TArray<FString>& OutCaptions) const
+{
+	OutCaptions.Add(TEXT("ParamAnimTextureArray"));
+	OutCaptions.Add(FString::Printf(TEXT("'%s'"), *ParameterName.ToString()));
+}
+
+bool UMtlExpTextureSampleParameterAnimArray::TextureIsValid(UTexture* InTexture, FString& OutMessage)
+{
+	bool Result = false;
+	if (InTexture)
+	{
+		const UAnimatedTexture2D* AnimTexture = Cast<UAnimatedTexture2D>(InTexture);
+		if (AnimTexture && AnimTexture->IsFrameArrayMode())
+		{
+			Result = true;
+		}
+
+		if (!Result)
+			OutMessage = TEXT("Requires an AnimatedTexture2D in FrameArray playback mode");
+	}
+	else
+	{
+		OutMessage = TEXT("NULL Textue");
+	}
+
+	return Result;
+}
+
+void UMtlExpTextureSampleParameterAnimArray::SetDefaultTexture()
+{
+	Texture = nullptr;
+}
+#endif // WITH_EDITOR
+
+#undef LOCTEXT_NAMESPACE
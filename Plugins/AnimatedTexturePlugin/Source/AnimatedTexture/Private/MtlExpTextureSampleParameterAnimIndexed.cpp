@@ -0,0 +1,115 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Animated Texture from GIF file
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+
+#include "MtlExpTextureSampleParameterAnimIndexed.h"
+#include "AnimatedTexture2D.h"
+#include "AnimatedTexturePalette.h"
+
+#if WITH_EDITOR
+#include "MaterialCompiler.h"
+#endif // WITH_EDITOR
+
+#define LOCTEXT_NAMESPACE "MaterialExpression"
+
+
+UMtlExpTextureSampleParameterAnimIndexed::UMtlExpTextureSampleParameterAnimIndexed(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// 需要调色板索引模式的 AnimatedTexture2D，没有合适的引擎默认资源，Texture 留空，由用户指定
+	Texture = nullptr;
+
+#if WITH_EDITORONLY_DATA
+	MenuCategories.Empty();
+	MenuCategories.Add(LOCTEXT("Texture", "Texture"));
+	MenuCategories.Add(LOCTEXT("Parameters", "Parameters"));
+#endif
+}
+
+#if WITH_EDITOR
+int32 UMtlExpTextureSampleParameterAnimIndexed::Compile(FMaterialCompiler* Compiler, int32 OutputIndex)
+{
+	UAnimatedTexture2D* AnimTexture = Cast<UAnimatedTexture2D>(Texture);
+	if (!AnimTexture || !AnimTexture->IsPaletteIndexed())
+	{
+		return Compiler->Errorf(TEXT("ParamAnimTextureIndexed requires an AnimatedTexture2D with Palette Indexed enabled"));
+	}
+
+	UAnimatedTexturePalette* Palette = AnimTexture->GetPaletteTexture();
+	if (!Palette)
+	{
+		return Compiler->Errorf(TEXT("AnimatedTexture '%s' has no palette yet"), *AnimTexture->GetName());
+	}
+
+	const int32 UVIndex = Coordinates.GetTracedInput().Expression
+		? Compiler->ComponentMask(Coordinates.Compile(Compiler), true, true, false, false)
+		: Compiler->TextureCoordinate(ConstCoordinate, false, false);
+
+	// 两次采样都使用纹理自带的点采样器：共享采样器会对索引做插值
+	int32 TextureReferenceIndex = INDEX_NONE;
+	const int32 TextureCodeIndex = Compiler->TextureParameter(ParameterName, Texture, TextureReferenceIndex, SamplerType, SSM_FromTextureAsset);
+	if (TextureCodeIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+	const int32 IndexValue = Compiler->ComponentMask(Compiler->TextureSample(TextureCodeIndex, UVIndex, SamplerType), true, false, false, false);
+
+	// R8 UNORM 读出 i / 255，映射到第 i 个调色板像素的中心：(i + 0.5) / 256
+	const int32 PaletteU = Compiler->Add(
+		Compiler->Mul(IndexValue, Compiler->Constant(255.0f / 256.0f)),
+		Compiler->Constant(0.5f / 256.0f));
+	const int32 PaletteUV = Compiler->AppendVector(PaletteU, Compiler->Constant(0.5f));
+
+	int32 PaletteReferenceIndex = INDEX_NONE;
+	const FName PaletteParameterName(*(ParameterName.ToString() + TEXT("Palette")));
+	const int32 PaletteCodeIndex = Compiler->TextureParameter(PaletteParameterName, Palette, PaletteReferenceIndex, SamplerType, SSM_FromTextureAsset);
+	if (PaletteCodeIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	return Compiler->TextureSample(PaletteCodeIndex, PaletteUV, SamplerType);
+}
+
+void UMtlExpTextureSampleParameterAnimIndexed::GetCaption(TArray<FString>& OutCaptions) const
+{
+	OutCaptions.Add(TEXT("ParamAnimTextureIndexed"));
+	OutCaptions.Add(FString::Printf(TEXT("'%s'"), *ParameterName.ToString()));
+}
+
+bool UMtlExpTextureSampleParameterAnimIndexed::TextureIsValid(UTexture* InTexture, FString& OutMessage)
+{
+	bool Result = false;
+	if (InTexture)
+	{
+		const UAnimatedTexture2D* AnimTexture = Cast<UAnimatedTexture2D>(InTexture);
+		if (AnimTexture && AnimTexture->IsPaletteIndexed())
+		{
+			Result = true;
+		}
+
+		if (!Result)
+			OutMessage = TEXT("Requires an AnimatedTexture2D with Palette Indexed enabled");
+	}
+	else
+	{
+		OutMessage = TEXT("NULL Textue");
+	}
+
+	return Result;
+}
+
+void UMtlExpTextureSampleParameterAnimIndexed::SetDefaultTexture()
+{
+	Texture = nullptr;
+}
+#endif // WITH_EDITOR
+
+#undef LOCTEXT_NAMESPACE
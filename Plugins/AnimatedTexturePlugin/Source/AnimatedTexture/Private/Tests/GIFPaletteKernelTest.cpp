@@ -0,0 +1,158 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Compares the vectorized GIF row compositor against the per-pixel loop
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "GIFPaletteKernel.h"
+#include "AnimatedTextureCompat.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#if AT_UE_VERSION_GE(5, 5)
+	#define AT_GIF_KERNEL_TEST_FLAGS (EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+#else
+	#define AT_GIF_KERNEL_TEST_FLAGS (EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+#endif
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGIFPaletteKernelTest, "Plugins.AnimatedTexture.GIFPaletteKernel", AT_GIF_KERNEL_TEST_FLAGS)
+
+namespace
+{
+	/** 原来的逐像素实现：只依赖调色板与 GCB 的语义，不使用 LUT */
+	void CompositeRowReference(uint32* Dst, const uint8* Src, int32 Count, const ColorMapObject& ColorMap, int TransparentColor, bool bDoNotDispose)
+	{
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int c = Src[i];
+			if (c >= ColorMap.ColorCount)
+				continue;	// 越界索引保留画布
+			if (c == TransparentColor && bDoNotDispose)
+				continue;	// 不清除模式下透明像素露出上一帧
+
+			const GifColorType& Entry = ColorMap.Colors[c];
+			Dst[i] = FColor(Entry.Red, Entry.Green, Entry.Blue, c == TransparentColor ? 0 : 255).DWColor();
+		}
+	}
+
+	enum class ECase
+	{
+		OpaqueFullPalette,	// 256 色、没有透明色：整行直接展开
+		Transparent,
+		OutOfRange,
+		DoNotDispose,
+		OutOfRangeTransparent,
+		Num
+	};
+}
+
+bool FGIFPaletteKernelTest::RunTest(const FString& Parameters)
+{
+	static const TCHAR* CaseNames[] = { TEXT("opaque full palette"), TEXT("transparent index"), TEXT("out-of-range index"), TEXT("do-not-dispose"), TEXT("out-of-range transparent index") };
+	FRandomStream Random(1234);
+
+	for (int32 Case = 0; Case < int32(ECase::Num); Case++)
+	{
+		for (int32 Iter = 0; Iter < 200; Iter++)
+		{
+			const ECase Kind = ECase(Case);
+			const bool bFullPalette = Kind == ECase::OpaqueFullPalette || Kind == ECase::Transparent || Kind == ECase::DoNotDispose;
+			const int32 ColorCount = bFullPalette ? 256 : Random.RandRange(1, 255);
+
+			TArray<GifColorType> Colors;
+			Colors.SetNumUninitialized(ColorCount);
+			for (GifColorType& Entry : Colors)
+			{
+				Entry.Red = uint8(Random.RandHelper(256));
+				Entry.Green = uint8(Random.RandHelper(256));
+				Entry.Blue = uint8(Random.RandHelper(256));
+			}
+			ColorMapObject ColorMap = {};
+			ColorMap.ColorCount = ColorCount;
+			ColorMap.Colors = Colors.GetData();
+
+			int TransparentColor = NO_TRANSPARENT_COLOR;
+			bool bDoNotDispose = false;
+			switch (Kind)
+			{
+			case ECase::Transparent:
+				TransparentColor = Random.RandHelper(256);
+				break;
+			case ECase::OutOfRange:
+				TransparentColor = (Iter & 1) ? Random.RandHelper(ColorCount) : NO_TRANSPARENT_COLOR;
+				bDoNotDispose = (Iter & 2) != 0;
+				break;
+			case ECase::DoNotDispose:
+				TransparentColor = Random.RandHelper(256);
+				bDoNotDispose = true;
+				break;
+			case ECase::OutOfRangeTransparent:
+				TransparentColor = Random.RandRange(ColorCount, 255);
+				bDoNotDispose = (Iter & 1) != 0;
+				break;
+			default:
+				break;
+			}
+
+			// 长串的透明色、越界索引与随机索引交替，覆盖整组保留、整组写入与部分混合；起点不对齐，覆盖尾部
+			const int32 Count = Random.RandHelper(300);
+			const int32 SrcOffset = Random.RandHelper(16);
+			const int32 DstOffset = Random.RandHelper(4);
+			TArray<uint8> Src;
+			Src.SetNumZeroed(SrcOffset + Count);
+			for (int32 i = 0; i < Count; i++)
+			{
+				const int32 Run = (i / 20) % 3;
+				uint8 Index = uint8(Random.RandHelper(256));
+				if (Run == 0 && TransparentColor != NO_TRANSPARENT_COLOR)
+					Index = uint8(TransparentColor);
+				else if (Run == 1 && ColorCount < 256)
+					Index = uint8(Random.RandRange(ColorCount, 255));
+				Src[SrcOffset + i] = Index;
+			}
+
+			TArray<uint32> Actual, Expected;
+			Actual.SetNumUninitialized(DstOffset + Count);
+			for (uint32& Pixel : Actual)
+				Pixel = uint32(Random.GetUnsignedInt());
+			Expected = Actual;
+
+			FGIFPaletteLUT LUT;
+			LUT.Build(&ColorMap);
+			{
+				FScopedTransparentColor ScopedTransparent(LUT, TransparentColor, bDoNotDispose);
+				GIFCompositeRow(reinterpret_cast<FColor*>(Actual.GetData() + DstOffset), Src.GetData() + SrcOffset, Count, LUT);
+			}
+			CompositeRowReference(Expected.GetData() + DstOffset, Src.GetData() + SrcOffset, Count, ColorMap, TransparentColor, bDoNotDispose);
+
+			if (Actual != Expected)
+			{
+				AddError(FString::Printf(TEXT("GIFCompositeRow differs from the per-pixel loop (%s, iteration %d)."), CaseNames[Case], Iter));
+				return false;
+			}
+
+			// 离开作用域后 LUT 恢复原状，可以给下一帧复用
+			FGIFPaletteLUT Fresh;
+			Fresh.Build(&ColorMap);
+			if (FMemory::Memcmp(Fresh.Color, LUT.Color, sizeof(LUT.Color)) != 0
+				|| FMemory::Memcmp(Fresh.Planes, LUT.Planes, sizeof(LUT.Planes)) != 0
+				|| Fresh.KeepIndex != LUT.KeepIndex || Fresh.bHasKeep != LUT.bHasKeep)
+			{
+				AddError(FString::Printf(TEXT("FScopedTransparentColor did not restore the LUT (%s, iteration %d)."), CaseNames[Case], Iter));
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+#undef AT_GIF_KERNEL_TEST_FLAGS
+
+#endif // WITH_DEV_AUTOMATION_TESTS
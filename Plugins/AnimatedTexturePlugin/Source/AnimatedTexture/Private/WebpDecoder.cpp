@@ -11,6 +11,16 @@
 #include "WebpDecoder.h"
 #include "AnimatedTextureModule.h"
 
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarAnimTextureWebPThreads(
+	TEXT("AnimatedTexture.WebPThreads"),
+	1,
+	TEXT("Let libwebp run VP8 filtering and output on a worker task (only used for frames at least 512 pixels wide).\n")
+	TEXT(" 0: single-threaded decoding\n")
+	TEXT(" 1: multi-threaded decoding (default)\n")
+	TEXT("Takes effect for textures created or reloaded after the change."));
+
 FWebpDecoder::~FWebpDecoder()
 {
 	Close();
@@ -18,51 +28,96 @@ FWebpDecoder::~FWebpDecoder()
 
 bool FWebpDecoder::LoadFromMemory(const uint8* InBuffer, uint32 InBufferSize)
 {
-	// get image width height
-	int ret = WebPGetFeatures(InBuffer, InBufferSize, &Features);
-	if (ret != VP8_STATUS_OK)
+	if (!BuildFrameIndex(InBuffer, InBufferSize))
 	{
-		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: Get Webp info failed, %d."), ret);
+		Close();
 		return false;
 	}
 
-	// create WebPAnimDecoder
-	WebPAnimDecoderOptions opt;
-	WebPAnimDecoderOptionsInit(&opt);
-	opt.color_mode = MODE_BGRA;
-	opt.use_threads = 0;
+	if (!WebPInitDecoderConfig(&Config))
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: WebP library version mismatch."));
+		Close();
+		return false;
+	}
+	Config.output.colorspace = MODE_BGRA;
+	Config.output.is_external_memory = 1;
+	Config.options.use_threads = CVarAnimTextureWebPThreads.GetValueOnAnyThread() != 0 ? 1 : 0;
+
+	Data = InBuffer;
+	DataSize = InBufferSize;
+
+	const int32 NumPixels = CanvasWidth * CanvasHeight;
+	Canvas.SetNumZeroed(NumPixels);
+	PrevCanvas.SetNumZeroed(NumPixels);
+	return true;
+}
 
+bool FWebpDecoder::BuildFrameIndex(const uint8* InBuffer, uint32 InBufferSize)
+{
+	// 唯一的一次容器解析
 	WebPData WData = { InBuffer, InBufferSize };
-	Decoder = WebPAnimDecoderNew(&WData, &opt);
-	if (!Decoder)
+	WebPDemuxer* Demuxer = WebPDemux(&WData);
+	if (!Demuxer)
 	{
 		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: Error parsing image."));
 		return false;
 	}
 
-	// get anim info
-	if (!WebPAnimDecoderGetInfo(Decoder, &AnimInfo)) {
-		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: Error getting global info about the animation."));
+	CanvasWidth = WebPDemuxGetI(Demuxer, WEBP_FF_CANVAS_WIDTH);
+	CanvasHeight = WebPDemuxGetI(Demuxer, WEBP_FF_CANVAS_HEIGHT);
+	bHasAlpha = (WebPDemuxGetI(Demuxer, WEBP_FF_FORMAT_FLAGS) & ALPHA_FLAG) != 0;
+
+	const uint32 NumFrames = WebPDemuxGetI(Demuxer, WEBP_FF_FRAME_COUNT);
+	Frames.Reset(NumFrames);
+	Duration = 0;
+	NumUnspecifiedDelays = 0;
+
+	WebPIterator Iter;
+	if (WebPDemuxGetFrame(Demuxer, 1, &Iter))
+	{
+		do {
+			FFrameInfo& Frame = Frames.AddDefaulted_GetRef();
+			Frame.Offset = static_cast<uint32>(Iter.fragment.bytes - InBuffer);
+			Frame.Size = static_cast<uint32>(Iter.fragment.size);
+			Frame.Rect = FIntRect(Iter.x_offset, Iter.y_offset, Iter.x_offset + Iter.width, Iter.y_offset + Iter.height);
+			Frame.Duration = FMath::Max(Iter.duration, 0);
+			Frame.StartTime = Duration;
+			Frame.bBlend = Iter.blend_method == WEBP_MUX_BLEND;
+			Frame.bDisposeBackground = Iter.dispose_method == WEBP_MUX_DISPOSE_BACKGROUND;
+			Frame.bHasAlpha = Iter.has_alpha != 0;
+
+			Duration += Frame.Duration;
+			NumUnspecifiedDelays += Frame.Duration == 0 ? 1 : 0;
+			bHasAlpha |= Frame.bHasAlpha;
+		} while (WebPDemuxNextFrame(&Iter));
+		WebPDemuxReleaseIterator(&Iter);
+	}
+	WebPDemuxDelete(Demuxer);
+
+	if (Frames.Num() == 0 || CanvasWidth == 0 || CanvasHeight == 0)
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: Image has no frames."));
 		return false;
 	}
 
-	// 使用 WebPDemux API 直接从文件头信息获取动画总时长，
-	// 避免在初始化阶段遍历解码所有帧造成不必要的性能开销
+	// 关键帧判定与 WebPAnimDecoder 相同（anim_decode.c: IsKeyFrame）
+	const FIntRect FullCanvas(0, 0, CanvasWidth, CanvasHeight);
+	for (int32 i = 0; i < Frames.Num(); i++)
 	{
-		WebPDemuxer* Demuxer = WebPDemux(&WData);
-		if (Demuxer)
+		FFrameInfo& Frame = Frames[i];
+		if (i == 0)
 		{
-			WebPIterator Iter;
-			if (WebPDemuxGetFrame(Demuxer, 1, &Iter))
-			{
-				uint32 TotalDuration = 0;
-				do {
-					TotalDuration += Iter.duration;
-				} while (WebPDemuxNextFrame(&Iter));
-				Duration = TotalDuration;
-				WebPDemuxReleaseIterator(&Iter);
-			}
-			WebPDemuxDelete(Demuxer);
+			Frame.bKeyFrame = 1;
+		}
+		else if ((!Frame.bHasAlpha || !Frame.bBlend) && Frame.Rect == FullCanvas)
+		{
+			Frame.bKeyFrame = 1;
+		}
+		else
+		{
+			const FFrameInfo& Prev = Frames[i - 1];
+			Frame.bKeyFrame = Prev.bDisposeBackground && (Prev.Rect == FullCanvas || Prev.bKeyFrame);
 		}
 	}
 
@@ -71,64 +126,272 @@ bool FWebpDecoder::LoadFromMemory(const uint8* InBuffer, uint32 InBufferSize)
 
 void FWebpDecoder::Close()
 {
-	if (Decoder)
+	Data = nullptr;
+	DataSize = 0;
+	Frames.Empty();
+	Canvas.Empty();
+	PrevCanvas.Empty();
+	Snapshots.Init(0, 0);
+	NextFrameIndex = 0;
+}
+
+int32 FWebpDecoder::FindKeyFrame(int32 FrameIndex) const
+{
+	for (int32 i = FMath::Min(FrameIndex, Frames.Num() - 1); i > 0; i--)
+	{
+		if (Frames[i].bKeyFrame)
+			return i;
+	}
+	return 0;
+}
+
+// Blend 'src' over 'dst' assuming they are NOT pre-multiplied by alpha,
+// same integer arithmetic as anim_decode.c so the output is identical to WebPAnimDecoder.
+static uint8 BlendChannelNonPremult(uint32 src, uint8 src_a, uint32 dst, uint8 dst_a, uint32 scale, int shift)
+{
+	const uint8 src_channel = (src >> shift) & 0xff;
+	const uint8 dst_channel = (dst >> shift) & 0xff;
+	const uint32 blend_unscaled = src_channel * src_a + dst_channel * dst_a;
+	return (blend_unscaled * scale) >> 24;
+}
+
+static uint32 BlendPixelNonPremult(uint32 src, uint32 dst)
+{
+	const uint8 src_a = (src >> 24) & 0xff;
+	if (src_a == 0)
+		return dst;
+
+	const uint8 dst_a = (dst >> 24) & 0xff;
+	const uint8 dst_factor_a = (dst_a * (256 - src_a)) >> 8;
+	const uint8 blend_a = src_a + dst_factor_a;
+	const uint32 scale = (1UL << 24) / blend_a;
+
+	const uint8 blend_0 = BlendChannelNonPremult(src, src_a, dst, dst_factor_a, scale, 0);
+	const uint8 blend_1 = BlendChannelNonPremult(src, src_a, dst, dst_factor_a, scale, 8);
+	const uint8 blend_2 = BlendChannelNonPremult(src, src_a, dst, dst_factor_a, scale, 16);
+
+	return (blend_0 << 0) | (blend_1 << 8) | (blend_2 << 16) | ((uint32)blend_a << 24);
+}
+
+static void BlendPixelRowNonPremult(uint32* src, const uint32* dst, int num_pixels)
+{
+	for (int i = 0; i < num_pixels; ++i)
+	{
+		const uint8 src_alpha = (src[i] >> 24) & 0xff;
+		if (src_alpha != 0xff)
+			src[i] = BlendPixelNonPremult(src[i], dst[i]);
+	}
+}
+
+bool FWebpDecoder::DecodeFrame(int32 Index)
+{
+	const FFrameInfo& Frame = Frames[Index];
+	const int32 Width = CanvasWidth;
+	const int32 NumPixels = Canvas.Num();
+
+	// Initialize.
+	if (Frame.bKeyFrame)
+		FMemory::Memzero(Canvas.GetData(), NumPixels * sizeof(FColor));
+	else
+		FMemory::Memcpy(Canvas.GetData(), PrevCanvas.GetData(), NumPixels * sizeof(FColor));
+
+	// Decode straight into the frame rect of the canvas.
+	const uint32 Stride = Width * sizeof(FColor);
+	WebPRGBABuffer& Buf = Config.output.u.RGBA;
+	Buf.rgba = reinterpret_cast<uint8*>(Canvas.GetData() + Frame.Rect.Min.Y * Width + Frame.Rect.Min.X);
+	Buf.stride = Stride;
+	Buf.size = static_cast<size_t>(Frame.Rect.Height()) * Stride;
+
+	const VP8StatusCode Status = WebPDecode(Data + Frame.Offset, Frame.Size, &Config);
+	if (Status != VP8_STATUS_OK)
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: Error decoding frame %d, %d."), Index, (int32)Status);
+		return false;
+	}
+
+	// Blend transparent pixels with the previous (disposed) canvas.
+	if (Index > 0 && Frame.bBlend && !Frame.bKeyFrame)
+	{
+		const FFrameInfo& Prev = Frames[Index - 1];
+		uint32* Curr = reinterpret_cast<uint32*>(Canvas.GetData());
+		const uint32* Disposed = reinterpret_cast<const uint32*>(PrevCanvas.GetData());
+
+		for (int32 y = Frame.Rect.Min.Y; y < Frame.Rect.Max.Y; y++)
+		{
+			const int32 RowOffset = y * Width;
+			if (!Prev.bDisposeBackground
+				|| y < Prev.Rect.Min.Y || y >= Prev.Rect.Max.Y
+				|| Frame.Rect.Min.X >= Prev.Rect.Max.X || Frame.Rect.Max.X <= Prev.Rect.Min.X)
+			{
+				BlendPixelRowNonPremult(Curr + RowOffset + Frame.Rect.Min.X, Disposed + RowOffset + Frame.Rect.Min.X, Frame.Rect.Width());
+				continue;
+			}
+
+			// 上一帧清除到透明的区域内无需混合，只处理它左右两侧的部分
+			if (Frame.Rect.Min.X < Prev.Rect.Min.X)
+			{
+				const int32 Left = Frame.Rect.Min.X;
+				BlendPixelRowNonPremult(Curr + RowOffset + Left, Disposed + RowOffset + Left, Prev.Rect.Min.X - Left);
+			}
+			if (Frame.Rect.Max.X > Prev.Rect.Max.X)
+			{
+				const int32 Left = Prev.Rect.Max.X;
+				BlendPixelRowNonPremult(Curr + RowOffset + Left, Disposed + RowOffset + Left, Frame.Rect.Max.X - Left);
+			}
+		}
+	}
+
+	// Dispose the current frame for the next iteration.
+	FMemory::Memcpy(PrevCanvas.GetData(), Canvas.GetData(), NumPixels * sizeof(FColor));
+	if (Frame.bDisposeBackground)
 	{
-		WebPAnimDecoderDelete(Decoder);
-		Decoder = nullptr;
-		FrameBuffer = nullptr;
+		for (int32 y = Frame.Rect.Min.Y; y < Frame.Rect.Max.Y; y++)
+		{
+			FMemory::Memzero(PrevCanvas.GetData() + y * Width + Frame.Rect.Min.X, Frame.Rect.Width() * sizeof(FColor));
+		}
 	}
+	Snapshots.Capture(Index, PrevCanvas);
+
+	return true;
 }
 
 uint32 FWebpDecoder::NextFrame(uint32 DefaultFrameDelay, bool bLooping)
 {
-	if (Decoder == nullptr)
+	DirtyRect = FIntRect();
+	if (Frames.Num() == 0)
 		return DefaultFrameDelay;
 
 	// restart
-	if (!WebPAnimDecoderHasMoreFrames(Decoder))
+	if (NextFrameIndex >= Frames.Num())
 	{
 		if (bLooping)
-			WebPAnimDecoderReset(Decoder);
+		{
+			NextFrameIndex = 0;
+			PrevDisposeRect = FIntRect();
+		}
 		else
 			return DefaultFrameDelay;
 	}
 
 	// decode next frame
-	int Timestamp = 0;
-	if (!WebPAnimDecoderGetNext(Decoder, &FrameBuffer, &Timestamp))
+	const int32 Index = NextFrameIndex++;
+	DecodeFrame(Index);
+	UpdateDirtyRect(Index);
+
+	// frame duration
+	const uint32 FrameDuration = Frames[Index].Duration;
+	return FrameDuration == 0 ? DefaultFrameDelay : FrameDuration;
+}
+
+void FWebpDecoder::SkipFrames(uint32 NumFrames, uint32 DefaultFrameDelay, bool bLooping, FIntRect& InOutDirtyRect)
+{
+	if (Frames.Num() == 0 || NumFrames == 0)
+		return;
+
+	// 在被跳过的帧和紧随其后的目标帧中找最后一个关键帧，它之前的帧不必解码
+	uint32 NumJump = 0;
+	int32 Index = NextFrameIndex;
+	for (uint32 i = 0; i <= NumFrames; i++)
+	{
+		if (Index >= Frames.Num())
+		{
+			if (!bLooping)
+				break;
+			Index = 0;
+		}
+
+		if (Frames[Index].bKeyFrame)
+			NumJump = i;
+		Index++;
+	}
+
+	if (NumJump > 0)
 	{
-		UE_LOG(LogAnimTexture, Error, TEXT("FWebpDecoder: Error decoding frame."));
+		NextFrameIndex = (NextFrameIndex + NumJump) % Frames.Num();
+
+		// 关键帧只重画自己的区域，之前的帧留在纹理上的内容需要整张刷新
+		PrevDisposeRect = FIntRect();
+		InOutDirtyRect = FIntRect(0, 0, GetWidth(), GetHeight());
 	}
 
-	// frame duration
-	int FrameDuration = Timestamp - PrevFrameTimestamp;
-	PrevFrameTimestamp = Timestamp;
-	return FrameDuration;
+	for (uint32 i = NumJump; i < NumFrames; i++)
+	{
+		NextFrame(DefaultFrameDelay, bLooping);
+		InOutDirtyRect = UnionRect(InOutDirtyRect, DirtyRect);
+	}
+}
+
+void FWebpDecoder::SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay)
+{
+	if (Frames.Num() == 0)
+		return;
+
+	// 从关键帧、快照、当前位置中离目标最近的一个开始解码
+	const int32 Target = FMath::Clamp(FrameIndex, 0, Frames.Num() - 1);
+	const int32 KeyFrame = FindKeyFrame(Target);
+	const int32 Snapshot = Snapshots.FindBefore(Target);
+
+	if (NextFrameIndex <= Target && NextFrameIndex >= FMath::Max(KeyFrame, Snapshot + 1))
+	{
+		// 当前位置最近，直接向前解码
+	}
+	else if (Snapshot >= KeyFrame)
+	{
+		const TArray<FColor>& Disposed = Snapshots.Get(Snapshot);
+		FMemory::Memcpy(PrevCanvas.GetData(), Disposed.GetData(), Disposed.Num() * sizeof(FColor));
+		NextFrameIndex = Snapshot + 1;
+	}
+	else
+	{
+		// 关键帧不读 PrevCanvas
+		NextFrameIndex = KeyFrame;
+	}
+	PrevDisposeRect = FIntRect();
+
+	while (NextFrameIndex < Target)
+		NextFrame(DefaultFrameDelay, false);
 }
 
 void FWebpDecoder::Reset()
 {
-	if (Decoder)
+	NextFrameIndex = 0;
+	PrevDisposeRect = FIntRect();
+	DirtyRect = FIntRect();
+}
+
+void FWebpDecoder::UpdateDirtyRect(int32 Index)
+{
+	const FIntRect FullCanvas(0, 0, GetWidth(), GetHeight());
+
+	// 第一帧（包括循环重新开始）会清空整张画布
+	if (Index == 0)
 	{
-		WebPAnimDecoderReset(Decoder);
+		DirtyRect = FullCanvas;
+		PrevDisposeRect = FIntRect();
+		return;
 	}
-	FrameBuffer = nullptr;
-	PrevFrameTimestamp = 0;
+
+	// 本帧区域 + 上一帧 dispose 到背景色的区域；
+	// 关键帧虽然会清空整张画布，但区域外的像素此前已经是透明色，不会产生变化
+	const FFrameInfo& Frame = Frames[Index];
+	FIntRect FrameRect = Frame.Rect;
+	FrameRect.Clip(FullCanvas);
+
+	DirtyRect = UnionRect(PrevDisposeRect, FrameRect);
+	PrevDisposeRect = Frame.bDisposeBackground ? FrameRect : FIntRect();
 }
 
 const FColor* FWebpDecoder::GetFrameBuffer() const
 {
-	return (FColor*)FrameBuffer;
+	return Canvas.GetData();
 }
 
 uint32 FWebpDecoder::GetDuration(uint32 DefaultFrameDelay) const
 {
-	return Duration;
+	return Duration + NumUnspecifiedDelays * DefaultFrameDelay;
 }
 
 bool FWebpDecoder::SupportsTransparency() const
 {
-	return Features.has_alpha != 0;
+	return bHasAlpha;
 }
-
-
@@ -17,10 +17,31 @@
 
 /**
 * @see https://developers.google.com/speed/webp/docs/api
+*
+* 加载时只做一次 WebPDemux 解析，建立帧索引（数据偏移/大小、区域、时长、blend/dispose、alpha、关键帧）后
+* 立即释放 Demuxer；播放时直接对索引中的帧数据调用 WebPDecode，并按 WebPAnimDecoder 的规则自行合成画布。
+*
+* 注意：解码器直接引用 LoadFromMemory 传入的内存，调用方需保证其在 Close 之前有效。
 */
 class FWebpDecoder : public FAnimatedTextureDecoder
 {
 public:
+	/** 帧索引 */
+	struct FFrameInfo
+	{
+		uint32 Offset = 0;		// 帧数据（ALPH + VP8/VP8L）在文件中的偏移
+		uint32 Size = 0;
+		FIntRect Rect;			// 在画布上的区域
+		uint32 Duration = 0;	// milliseconds, 0 = unspecified
+		uint32 StartTime = 0;	// 本帧之前所有帧的时长之和（未指定时长的帧按 0 计）
+		uint32 bBlend : 1;
+		uint32 bDisposeBackground : 1;
+		uint32 bHasAlpha : 1;
+		uint32 bKeyFrame : 1;	// 不依赖之前的画布，可以从这一帧开始解码
+
+		FFrameInfo() : bBlend(0), bDisposeBackground(0), bHasAlpha(0), bKeyFrame(0) {}
+	};
+
 	FWebpDecoder() = default;
 	virtual ~FWebpDecoder();
 
@@ -29,21 +50,57 @@ public:
 
 	virtual uint32 NextFrame(uint32 DefaultFrameDelay, bool bLooping) override;
 	virtual void Reset() override;
+	virtual void SkipFrames(uint32 NumFrames, uint32 DefaultFrameDelay, bool bLooping, FIntRect& InOutDirtyRect) override;
+	virtual void SeekFrame(int32 FrameIndex, uint32 DefaultFrameDelay) override;
+	virtual void SetSnapshotInterval(int32 Interval) override { Snapshots.Init(Interval, Frames.Num()); }
+	virtual int32 GetCurrentFrame() const override { return NextFrameIndex - 1; }
 
-	virtual uint32 GetWidth() const override { return AnimInfo.canvas_width; }
-	virtual uint32 GetHeight() const override { return AnimInfo.canvas_height; }
+	virtual uint32 GetWidth() const override { return CanvasWidth; }
+	virtual uint32 GetHeight() const override { return CanvasHeight; }
 	virtual const FColor* GetFrameBuffer() const override;
 
+	virtual uint32 GetNumFrames() const override { return Frames.Num(); }
+	virtual uint32 GetFrameDelay(uint32 FrameIndex, uint32 DefaultFrameDelay) const override
+	{
+		return Frames[FrameIndex].Duration == 0 ? DefaultFrameDelay : Frames[FrameIndex].Duration;
+	}
 	virtual uint32 GetDuration(uint32 DefaultFrameDelay) const override;
 	virtual bool SupportsTransparency() const override;
+	virtual FIntRect GetDirtyRect() const override { return DirtyRect; }
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		return Frames.GetAllocatedSize() + Canvas.GetAllocatedSize() + PrevCanvas.GetAllocatedSize()
+			+ Snapshots.GetAllocatedSize();
+	}
+
+	const TArray<FFrameInfo>& GetFrames() const { return Frames; }
+
+	/** 向前查找 FrameIndex（含）之前最近的关键帧，随机访问时从这里开始解码 */
+	int32 FindKeyFrame(int32 FrameIndex) const;
 
 private:
-	int PrevFrameTimestamp = 0;
+	bool BuildFrameIndex(const uint8* InBuffer, uint32 InBufferSize);
+	bool DecodeFrame(int32 Index);
+	void UpdateDirtyRect(int32 Index);
+
+private:
+	const uint8* Data = nullptr;
+	uint32 DataSize = 0;
+
+	uint32 CanvasWidth = 0;
+	uint32 CanvasHeight = 0;
+	bool bHasAlpha = false;
 	uint32 Duration = 0;
+	uint32 NumUnspecifiedDelays = 0;
+
+	TArray<FFrameInfo> Frames;
+	WebPDecoderConfig Config;
 
-	WebPAnimInfo AnimInfo;
-	WebPBitstreamFeatures Features;
+	TArray<FColor> Canvas;			// 当前帧
+	TArray<FColor> PrevCanvas;		// 上一帧 dispose 之后的画布
+	FAnimatedTextureSnapshots Snapshots;	// PrevCanvas 的快照
 
-	uint8* FrameBuffer = nullptr;
-	WebPAnimDecoder* Decoder = nullptr;
+	int32 NextFrameIndex = 0;		// 0-based
+	FIntRect PrevDisposeRect;
+	FIntRect DirtyRect;
 };
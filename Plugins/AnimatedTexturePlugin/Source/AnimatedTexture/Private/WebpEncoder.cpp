@@ -0,0 +1,148 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Animated WebP encoder used to transcode imported GIFs
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "WebpEncoder.h"
+
+#if WITH_EDITOR
+#include "AnimatedTexture2D.h"
+#include "AnimatedTextureDecoder.h"
+#include "AnimatedTextureModule.h"
+#include "libwebp/src/webp/encode.h"
+#include "libwebp/src/webp/mux.h"
+
+static bool InitWebpConfig(const FAnimatedTextureWebpSettings& Settings, WebPConfig& OutConfig)
+{
+	if (!WebPConfigInit(&OutConfig))
+		return false;
+
+	switch (Settings.Compression)
+	{
+	case EAnimatedTextureWebpCompression::Lossless:
+		// 无损模式下 quality 表示压缩力度
+		OutConfig.lossless = 1;
+		OutConfig.quality = Settings.Quality;
+		break;
+	case EAnimatedTextureWebpCompression::NearLossless:
+		OutConfig.lossless = 1;
+		OutConfig.quality = Settings.Quality;
+		OutConfig.near_lossless = FMath::Clamp(Settings.NearLosslessLevel, 0, 100);
+		break;
+	default:
+		OutConfig.lossless = 0;
+		OutConfig.quality = Settings.Quality;
+		break;
+	}
+	OutConfig.method = FMath::Clamp(Settings.Method, 0, 6);
+
+	// 多线程编码：使用 WebpWorker.cpp 提供的 worker
+	OutConfig.thread_level = Settings.bMultiThreaded ? 1 : 0;
+
+	return WebPValidateConfig(&OutConfig) != 0;
+}
+
+FAnimatedTextureDecodeCost FAnimatedTextureDecodeCost::Measure(FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay)
+{
+	FAnimatedTextureDecodeCost Cost;
+	Cost.NumFrames = Decoder.GetNumFrames();
+
+	Decoder.Reset();
+	for (int32 Frame = 0; Frame < Cost.NumFrames; Frame++)
+	{
+		Decoder.NextFrame(DefaultFrameDelay, false);
+		const FIntRect Rect = Decoder.GetDirtyRect();
+		Cost.DecodedPixels += double(FMath::Max(Rect.Width(), 0)) * FMath::Max(Rect.Height(), 0);
+	}
+	Decoder.Reset();
+
+	const uint32 Duration = Decoder.GetDuration(DefaultFrameDelay);
+	Cost.PixelsPerSecond = Duration > 0 ? Cost.DecodedPixels * 1000.0 / Duration : 0;
+	return Cost;
+}
+
+bool FWebpEncoder::HasUnspecifiedFrameDelay(const FAnimatedTextureDecoder& Decoder)
+{
+	for (uint32 Frame = 0; Frame < Decoder.GetNumFrames(); Frame++)
+	{
+		if (Decoder.GetFrameDelay(Frame, 0) == 0)
+			return true;
+	}
+	return false;
+}
+
+bool FWebpEncoder::EncodeAnimation(FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay,
+	const FAnimatedTextureWebpSettings& Settings, bool bMinimizeSize, TArray<uint8>& OutWebp)
+{
+	OutWebp.Reset();
+
+	const int32 Width = Decoder.GetWidth();
+	const int32 Height = Decoder.GetHeight();
+	const uint32 NumFrames = Decoder.GetNumFrames();
+	if (Width <= 0 || Height <= 0 || NumFrames == 0)
+		return false;
+
+	WebPConfig Config;
+	if (!InitWebpConfig(Settings, Config))
+	{
+		UE_LOG(LogAnimTexture, Error, TEXT("FWebpEncoder: invalid encoder settings."));
+		return false;
+	}
+
+	WebPAnimEncoderOptions EncoderOptions;
+	if (!WebPAnimEncoderOptionsInit(&EncoderOptions))
+		return false;
+	EncoderOptions.anim_params.loop_count = 0;	// 循环由 UAnimatedTexture2D::bLooping 控制
+	EncoderOptions.allow_mixed = Settings.Compression == EAnimatedTextureWebpCompression::Lossy ? 1 : 0;
+	EncoderOptions.minimize_size = bMinimizeSize ? 1 : 0;
+
+	WebPAnimEncoder* Encoder = WebPAnimEncoderNew(Width, Height, &EncoderOptions);
+	if (!Encoder)
+		return false;
+
+	WebPPicture Picture;
+	WebPPictureInit(&Picture);
+	Picture.width = Width;
+	Picture.height = Height;
+	Picture.use_argb = 1;
+
+	bool bOk = true;
+	int Timestamp = 0;
+	Decoder.Reset();
+	for (uint32 Frame = 0; Frame < NumFrames && bOk; Frame++)
+	{
+		const uint32 Delay = Decoder.NextFrame(DefaultFrameDelay, false);
+		const FColor* Canvas = Decoder.GetFrameBuffer();
+
+		// FColor 是 BGRA 字节序，与 WebPPictureImportBGRA 的输入一致
+		bOk = Canvas
+			&& WebPPictureImportBGRA(&Picture, reinterpret_cast<const uint8_t*>(Canvas), Width * sizeof(FColor))
+			&& WebPAnimEncoderAdd(Encoder, &Picture, Timestamp, &Config);
+		Timestamp += Delay;
+	}
+
+	// 最后一帧的时长由结束时间戳决定
+	WebPData Assembled;
+	WebPDataInit(&Assembled);
+	bOk = bOk
+		&& WebPAnimEncoderAdd(Encoder, nullptr, Timestamp, nullptr)
+		&& WebPAnimEncoderAssemble(Encoder, &Assembled);
+
+	if (bOk)
+		OutWebp.Append(Assembled.bytes, int32(Assembled.size));
+	else
+		UE_LOG(LogAnimTexture, Error, TEXT("FWebpEncoder: %s"), UTF8_TO_TCHAR(WebPAnimEncoderGetError(Encoder)));
+
+	WebPDataClear(&Assembled);
+	WebPPictureFree(&Picture);
+	WebPAnimEncoderDelete(Encoder);
+	Decoder.Reset();
+	return bOk;
+}
+
+#endif // WITH_EDITOR
@@ -0,0 +1,55 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Animated WebP encoder used to transcode imported GIFs
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_EDITOR
+
+class FAnimatedTextureDecoder;
+struct FAnimatedTextureWebpSettings;
+
+/**
+ * 播放一遍动画的解码开销：帧数，以及需要合成并上传的像素（按每帧的脏矩形统计）。
+ * 只由文件内容决定，同一个文件在任何机器上得到同样的结果，导入时据此决定是否采用转码结果。
+ */
+struct FAnimatedTextureDecodeCost
+{
+	int32 NumFrames = 0;
+	double DecodedPixels = 0;	// 播放一遍的脏矩形面积之和
+	double PixelsPerSecond = 0;
+
+	/** 从头解码 Decoder 的所有帧一遍并统计，结束后 Reset */
+	static FAnimatedTextureDecodeCost Measure(FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay);
+};
+
+/**
+ * 用 libwebp 的 WebPAnimEncoder 把解码器输出的全部画布重新编码成动画 WebP。
+ * WebPAnimEncoder 自己计算相邻帧的差异子区域、选择 blend/dispose 与关键帧，输入只需要完整画布。
+ */
+class FWebpEncoder
+{
+public:
+	/**
+	 * 从头解码 Decoder 的所有帧并编码；WebP 没有「未指定时长」，这样的帧使用 DefaultFrameDelay（毫秒），
+	 * 需要保留未指定时长的调用者应当先检查 HasUnspecifiedFrameDelay。
+	 * 与前一帧相同的帧合并到前一帧的时长里，每帧裁剪到实际改变的区域。
+	 * @param bMinimizeSize	每帧都比较两种 dispose 方式与关键帧/非关键帧的结果，取最小的（更慢）
+	 * @return 编码失败时返回 false，OutWebp 为空
+	 */
+	static bool EncodeAnimation(FAnimatedTextureDecoder& Decoder, uint32 DefaultFrameDelay,
+		const FAnimatedTextureWebpSettings& Settings, bool bMinimizeSize, TArray<uint8>& OutWebp);
+
+	/** 是否有帧没有在文件里指定时长（播放时使用纹理的 DefaultFrameDelay） */
+	static bool HasUnspecifiedFrameDelay(const FAnimatedTextureDecoder& Decoder);
+};
+
+#endif // WITH_EDITOR
@@ -0,0 +1,112 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * libwebp worker interface backed by UE tasks
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#include "WebpWorker.h"
+#include "AnimatedTextureModule.h"
+
+#include "Tasks/Task.h"
+#include "libwebp/src/utils/thread_utils.h"
+
+namespace
+{
+	/** WebPWorker::impl_ 指向的对象：最近一次 Launch 的任务 */
+	struct FWebpWorkerImpl
+	{
+		UE::Tasks::FTask Task;
+	};
+
+	void WorkerInit(WebPWorker* const Worker)
+	{
+		FMemory::Memzero(Worker, sizeof(*Worker));
+		Worker->status_ = NOT_OK;
+	}
+
+	void WorkerExecute(WebPWorker* const Worker)
+	{
+		if (Worker->hook != nullptr)
+		{
+			Worker->had_error |= !Worker->hook(Worker->data1, Worker->data2);
+		}
+	}
+
+	int WorkerSync(WebPWorker* const Worker)
+	{
+		FWebpWorkerImpl* Impl = static_cast<FWebpWorkerImpl*>(Worker->impl_);
+		if (Impl && Impl->Task.IsValid())
+		{
+			// 任务尚未开始时 Wait 会把它收回到当前线程执行，不会因线程池占满而死锁
+			Impl->Task.Wait();
+			Impl->Task = UE::Tasks::FTask();
+		}
+
+		if (Worker->status_ == WORK)
+			Worker->status_ = OK;
+		return !Worker->had_error;
+	}
+
+	int WorkerReset(WebPWorker* const Worker)
+	{
+		Worker->had_error = 0;
+		if (Worker->status_ < OK)
+		{
+			Worker->impl_ = new FWebpWorkerImpl();
+			Worker->status_ = OK;
+			return 1;
+		}
+		else if (Worker->status_ > OK)
+		{
+			return WorkerSync(Worker);
+		}
+		return 1;
+	}
+
+	void WorkerLaunch(WebPWorker* const Worker)
+	{
+		FWebpWorkerImpl* Impl = static_cast<FWebpWorkerImpl*>(Worker->impl_);
+		if (!Impl)
+		{
+			WorkerExecute(Worker);
+			return;
+		}
+
+		Worker->status_ = WORK;
+		Impl->Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Worker]()
+			{
+				WorkerExecute(Worker);
+			});
+	}
+
+	void WorkerEnd(WebPWorker* const Worker)
+	{
+		if (Worker->impl_)
+		{
+			WorkerSync(Worker);
+			delete static_cast<FWebpWorkerImpl*>(Worker->impl_);
+			Worker->impl_ = nullptr;
+		}
+		Worker->status_ = NOT_OK;
+	}
+}
+
+void InstallWebpWorkerInterface()
+{
+	WebPWorkerInterface Interface;
+	Interface.Init = WorkerInit;
+	Interface.Reset = WorkerReset;
+	Interface.Sync = WorkerSync;
+	Interface.Launch = WorkerLaunch;
+	Interface.Execute = WorkerExecute;
+	Interface.End = WorkerEnd;
+
+	if (!WebPSetWorkerInterface(&Interface))
+	{
+		UE_LOG(LogAnimTexture, Warning, TEXT("Failed to install the libwebp worker interface, WebP decoding stays single-threaded."));
+	}
+}
@@ -0,0 +1,24 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * libwebp worker interface backed by UE tasks
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 把 libwebp 的 WebPWorkerInterface 映射到 UE::Tasks
+ *
+ * libwebp 以 WEBP_USE_THREAD + WEBP_USE_EXTERNAL_WORKER 编译（见 AnimatedTexture.Build.cs），
+ * 自带的 pthread worker 被裁掉；模块启动时安装本接口后，VP8 的环路滤波/输出阶段
+ * 以任务的形式跑在 UE 的工作线程上，而不是每个解码器各自创建一个系统线程。
+ *
+ * 必须在任何 WebP 解码/编码开始之前调用（WebPSetWorkerInterface 不是线程安全的）。
+ */
+void InstallWebpWorkerInterface();
@@ -16,7 +16,15 @@
 #include "src/utils/thread_utils.h"
 #include "src/utils/utils.h"
 
-#ifdef WEBP_USE_THREAD
+// UAnimatedTexture: with WEBP_USE_EXTERNAL_WORKER the codec is still built with
+// WEBP_USE_THREAD (multi-threaded code paths enabled), but the pthread based
+// worker is compiled out. The default interface then runs hooks synchronously
+// until the host installs its own through WebPSetWorkerInterface().
+#if defined(WEBP_USE_THREAD) && !defined(WEBP_USE_EXTERNAL_WORKER)
+#define WEBP_USE_NATIVE_THREAD
+#endif
+
+#ifdef WEBP_USE_NATIVE_THREAD
 
 #if defined(_WIN32)
 
@@ -256,7 +264,7 @@ static void ChangeState(WebPWorker* const worker, WebPWorkerStatus new_status) {
   pthread_mutex_unlock(&impl->mutex_);
 }
 
-#endif  // WEBP_USE_THREAD
+#endif  // WEBP_USE_NATIVE_THREAD
 
 //------------------------------------------------------------------------------
 
@@ -266,7 +274,7 @@ static void Init(WebPWorker* const worker) {
 }
 
 static int Sync(WebPWorker* const worker) {
-#ifdef WEBP_USE_THREAD
+#ifdef WEBP_USE_NATIVE_THREAD
   ChangeState(worker, OK);
 #endif
   assert(worker->status_ <= OK);
@@ -277,7 +285,7 @@ static int Reset(WebPWorker* const worker) {
   int ok = 1;
   worker->had_error = 0;
   if (worker->status_ < OK) {
-#ifdef WEBP_USE_THREAD
+#ifdef WEBP_USE_NATIVE_THREAD
     WebPWorkerImpl* const impl =
         (WebPWorkerImpl*)WebPSafeCalloc(1, sizeof(WebPWorkerImpl));
     worker->impl_ = (void*)impl;
@@ -320,7 +328,7 @@ static void Execute(WebPWorker* const worker) {
 }
 
 static void Launch(WebPWorker* const worker) {
-#ifdef WEBP_USE_THREAD
+#ifdef WEBP_USE_NATIVE_THREAD
   ChangeState(worker, WORK);
 #else
   Execute(worker);
@@ -328,7 +336,7 @@ static void Launch(WebPWorker* const worker) {
 }
 
 static void End(WebPWorker* const worker) {
-#ifdef WEBP_USE_THREAD
+#ifdef WEBP_USE_NATIVE_THREAD
   if (worker->impl_ != NULL) {
     WebPWorkerImpl* const impl = (WebPWorkerImpl*)worker->impl_;
     ChangeState(worker, NOT_OK);
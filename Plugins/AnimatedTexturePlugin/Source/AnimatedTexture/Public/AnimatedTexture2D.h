@@ -12,10 +12,26 @@
 
 #include "CoreMinimal.h"
 #include "Engine/Texture.h"
-#include "Tickable.h"	// Engine
+#include "Memory/SharedBuffer.h"
+#include "Serialization/BulkData.h"
+#include "AnimatedTextureLoadTypes.h"
+#if WITH_EDITORONLY_DATA
+#include "Serialization/EditorBulkData.h"
+#endif
 #include "AnimatedTexture2D.generated.h"
 
 class FAnimatedTextureDecoder;
+class FAnimatedTextureDecodeAhead;
+class FAnimatedTextureStagingPool;
+class FAnimatedTexturePixelPacker;
+class FAnimatedTextureSharedSource;
+struct FAnimatedTextureFrameUpdate;
+struct FAnimatedTexturePreparedLoad;
+struct FAnimatedTextureBakedFrames;
+class UAnimatedTexturePalette;
+class UAnimatedTextureFrameArrayTiming;
+class FAnimatedTextureLoadTask;
+class IBulkDataIORequest;
 
 UENUM()
 enum class EAnimatedTextureType : uint8
@@ -25,13 +41,93 @@ enum class EAnimatedTextureType : uint8
 	Webp
 };
 
+UENUM()
+enum class EAnimatedTexturePlaybackMode : uint8
+{
+	/** Decode on the CPU while playing and upload the changed region of each frame */
+	Streaming,
+	/** Composite every frame once into a Texture2DArray, sample it with UMtlExpTextureSampleParameterAnimArray */
+	FrameArray
+};
+
+UENUM(BlueprintType)
+enum class EAnimatedTexturePlayDirection : uint8
+{
+	Forward,
+	/** Last frame to first */
+	Reverse,
+	/** First to last and back, the first and last frames are shown once per cycle */
+	PingPong
+};
+
+UENUM()
+enum class EAnimatedTextureTickPolicy : uint8
+{
+	/** Decode while playing, whether or not anything shows the texture */
+	Always,
+	/** Pause decoding while no material has sampled the texture recently, resume at the time-correct frame */
+	WhenRendered,
+	/** Never ticked automatically, advance with AdvancePlayback() */
+	Manual
+};
+
+UENUM()
+enum class EAnimatedTextureUploadFormat : uint8
+{
+	/** BGRA8, or Compact when AnimatedTexture.CompactUpload is set (e.g. in a low-end device profile) */
+	Default,
+	/** 32-bit BGRA */
+	BGRA8,
+	/** 16-bit: RGB565 for opaque animations, RGBA5551 for GIF transparency, BGRA8 for WebP with alpha and for sRGB textures */
+	Compact,
+	/** 16-bit with 1-bit alpha, WebP alpha is cut at 50%, sRGB textures stay BGRA8 */
+	RGBA5551
+};
+
+UENUM(BlueprintType)
+enum class EAnimatedTextureWebpCompression : uint8
+{
+	/** Pixel-exact, Quality is the compression effort */
+	Lossless,
+	/** Lossless bitstream with pixels pre-quantized near smooth areas, see NearLosslessLevel */
+	NearLossless,
+	/** VP8 lossy, Quality is the visual quality */
+	Lossy
+};
+
+/** Settings used to transcode GIF files to animated WebP at import */
+USTRUCT(BlueprintType)
+struct FAnimatedTextureWebpSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture)
+		EAnimatedTextureWebpCompression Compression = EAnimatedTextureWebpCompression::Lossless;
+
+	/** Lossy: visual quality; Lossless/NearLossless: compression effort (higher is smaller and slower) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture, meta = (ClampMin = "0", ClampMax = "100"))
+		float Quality = 75.0f;
+
+	/** NearLossless: 100 is lossless, lower values quantize more */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture, meta = (ClampMin = "0", ClampMax = "100", EditCondition = "Compression == EAnimatedTextureWebpCompression::NearLossless"))
+		int32 NearLosslessLevel = 60;
+
+	/** Speed/size trade-off, 0 is fastest and 6 gives the smallest files */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture, meta = (ClampMin = "0", ClampMax = "6"))
+		int32 Method = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture)
+		bool bMultiThreaded = true;
+};
+
 
 /**
  * Animated Texture
+ * Playback is driven by UAnimatedTextureSubsystem, which owns the tick of all animated textures.
  * @see class UTexture2D
  */
 UCLASS(BlueprintType, Category = AnimatedTexture)
-class ANIMATEDTEXTURE_API UAnimatedTexture2D : public UTexture, public FTickableGameObject
+class ANIMATEDTEXTURE_API UAnimatedTexture2D : public UTexture
 {
 	GENERATED_BODY()
 
@@ -48,12 +144,60 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture)
 		float DefaultFrameDelay = 1.0f / 10;	// used while Frame.Delay==0
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetPlayRate, Category = AnimatedTexture)
 		float PlayRate = 1.0f;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AnimatedTexture)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetLooping, Category = AnimatedTexture)
 		bool bLooping = true;
 
+	/** Reverse and PingPong cache composited frames so that each displayed frame costs about the same as forward playback */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetPlayDirection, Category = AnimatedTexture)
+		EAnimatedTexturePlayDirection PlayDirection = EAnimatedTexturePlayDirection::Forward;
+
+	/** WhenRendered treats textures that never report a render time (e.g. shown only in UMG) as visible */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetTickPolicy, Category = AnimatedTexture)
+		EAnimatedTextureTickPolicy TickPolicy = EAnimatedTextureTickPolicy::WhenRendered;
+
+	/** FrameArray: no per-frame CPU or upload cost, the material picks the slice by time (always loops, ignores Play/Stop) */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture)
+		EAnimatedTexturePlaybackMode PlaybackMode = EAnimatedTexturePlaybackMode::Streaming;
+
+	/** Upper bound of Texture2DArray slices in FrameArray mode, frames are resampled at a coarser interval beyond this */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (EditCondition = "PlaybackMode == EAnimatedTexturePlaybackMode::FrameArray", ClampMin = "1", ClampMax = "2048"))
+		int32 MaxFrameArraySlices = 256;
+
+	/** FrameArray: cook the slices in the target platform's block-compressed format (BC/ASTC/ETC2), the cooked game ships no GIF/WebP data and never decodes */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (EditCondition = "PlaybackMode == EAnimatedTexturePlaybackMode::FrameArray"))
+		bool bCookCompressedFrames = false;
+
+	/** Textures with identical content share one RHI texture driven by the first of them; Play/Stop/PlayRate of the others are ignored */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay)
+		bool bShareTexture = false;
+
+	/** GIFs whose frames fit one 256-color palette upload 8-bit indices plus the palette instead of BGRA (a quarter of the bandwidth and VRAM); sample with ParamAnimTextureIndexed, always point-sampled */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (EditCondition = "PlaybackMode == EAnimatedTexturePlaybackMode::Streaming && !bShareTexture"))
+		bool bPaletteIndexed = false;
+
+	/** Pixel format of the streamed texture, the 16-bit formats halve upload bandwidth and VRAM; ignored while palette indexed upload is active */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (EditCondition = "PlaybackMode == EAnimatedTexturePlaybackMode::Streaming && !bShareTexture"))
+		EAnimatedTextureUploadFormat UploadFormat = EAnimatedTextureUploadFormat::Default;
+
+	/** Ordered dithering when converting to a 16-bit upload format */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (EditCondition = "PlaybackMode == EAnimatedTexturePlaybackMode::Streaming && !bShareTexture"))
+		bool bDitherUpload = true;
+
+	/** Decode frames on a worker thread ahead of the playhead, Tick only picks the ready frame */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay)
+		bool bAsyncDecode = false;
+
+	/** Number of pre-decoded frames kept in the decode-ahead ring */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (EditCondition = "bAsyncDecode", ClampMin = "2", ClampMax = "16"))
+		int32 DecodeAheadFrames = 3;
+
+	/** Keep a decoded snapshot every N frames so that seeking decodes at most N frames (0 = keyframes only, each snapshot costs one canvas) */
+	UPROPERTY(EditAnywhere, Category = AnimatedTexture, AdvancedDisplay, meta = (ClampMin = "0"))
+		int32 SeekSnapshotInterval = 0;
+
 public:	// Playback APIs
 	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
 		void Play();
@@ -68,13 +212,13 @@ public:	// Playback APIs
 		bool IsPlaying() const { return bPlaying; }
 
 	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
-		void SetLooping(bool bNewLooping) { bLooping = bNewLooping; }
+		void SetLooping(bool bNewLooping);
 
 	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
 		bool IsLooping() const { return bLooping; }
 
 	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
-		void SetPlayRate(float NewRate) { PlayRate = NewRate; }
+		void SetPlayRate(float NewRate);
 
 	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
 		float GetPlayRate() const { return PlayRate; }
@@ -82,43 +226,91 @@ public:	// Playback APIs
 	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
 		float GetAnimationLength() const;
 
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		void SetPlayDirection(EAnimatedTexturePlayDirection NewDirection);
+
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		EAnimatedTexturePlayDirection GetPlayDirection() const { return PlayDirection; }
+
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		void SetTickPolicy(EAnimatedTextureTickPolicy NewPolicy);
+
+	/** Jump to the given time in seconds along the play direction (wrapped when looping) and show that frame immediately, also while stopped */
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		void SetPlaybackPosition(float Seconds);
+
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		float GetPlaybackPosition() const;
+
+	/** Jump to the start of the given file frame and show it immediately, also while stopped */
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		void SeekToFrame(int32 FrameIndex);
+
+	/** Index of the file frame currently shown, -1 before the first frame is decoded */
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		int32 GetCurrentFrame() const;
+
+	/** Manual tick policy: advance the playhead by DeltaSeconds (scaled by PlayRate) and upload the frame due at that time */
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		void AdvancePlayback(float DeltaSeconds);
+
+	UFUNCTION(BlueprintCallable, Category = AnimatedTexture)
+		int32 GetFrameCount() const { return SourceFrameCount; }
+
 public:	// UTexture Interface
 	virtual float GetSurfaceWidth() const override;
 	virtual float GetSurfaceHeight() const override;
 	virtual float GetSurfaceDepth() const override { return 0; }
-	virtual uint32 GetSurfaceArraySize() const override { return 0; }
-	virtual ETextureClass GetTextureClass() const override { return ETextureClass::TwoDDynamic; }
+	virtual uint32 GetSurfaceArraySize() const override { return IsFrameArrayMode() ? FrameArraySlices : 0; }
+	virtual ETextureClass GetTextureClass() const override { return IsFrameArrayMode() ? ETextureClass::TwoDArray : ETextureClass::TwoDDynamic; }
 
 	virtual FTextureResource* CreateResource() override;
-	virtual EMaterialValueType GetMaterialType() const override { return MCT_Texture2D; }
-
-public:	// FTickableGameObject Interface
-	virtual void Tick(float DeltaTime) override;
-	virtual bool IsTickable() const override
-	{
-		return true;
-	}
-	virtual TStatId GetStatId() const
-	{
-		RETURN_QUICK_DECLARE_CYCLE_STAT(UAnimatedTexture2D, STATGROUP_Tickables);
-	}
-	virtual bool IsTickableInEditor() const
-	{
-		return true;
-	}
+	virtual EMaterialValueType GetMaterialType() const override { return IsFrameArrayMode() ? MCT_Texture2DArray : MCT_Texture2D; }
 
-	virtual UWorld* GetTickableGameObjectWorld() const
-	{
-		return GetWorld();
-	}
 public:	// UObject Interface.
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+	virtual void ClearAllCachedCookedPlatformData() override;
 #endif // WITH_EDITOR
 
 public: // Internal APIs
 	void ImportFile(EAnimatedTextureType InFileType, const uint8* InBuffer, uint32 InBufferSize);
 
+	/**
+	 * 接管一份文件数据：游戏进程里 InBuffer 自己持有内存（MakeSharedBufferFromArray、内存映射的文件）时
+	 * 直接交给共享源，不拷贝；编辑器与 Headless 进程需要 FileBlob，仍拷贝一份。
+	 */
+	void ImportFile(EAnimatedTextureType InFileType, const FSharedBuffer& InBuffer);
+
+	EAnimatedTextureType GetFileType() const { return FileType; }
+
+#if WITH_EDITOR
+	/**
+	 * 把 GIF 重新编码成动画 WebP，原始 GIF 作为编辑器数据保留（不进入 Cook 产物）。
+	 * 编码结果不比原文件小时保留 GIF 并返回 false
+	 */
+	bool TranscodeToWebp(const FAnimatedTextureWebpSettings& Settings);
+
+	/**
+	 * 导入时的动画优化：合并相同的连续帧（时长相加），每帧裁剪到实际改变的矩形并选择开销更小的 dispose 方式，
+	 * 用无损 WebP 重新编码（像素不变）。合成的像素没有减少至少 25%，或文件变大时保留 GIF 并返回 false
+	 */
+	bool OptimizeAnimation();
+
+	/** 是否由 TranscodeToWebp / OptimizeAnimation 从 GIF 转码而来 */
+	bool IsTranscodedFromGif() const { return OriginalFileType == EAnimatedTextureType::Gif; }
+#endif // WITH_EDITOR
+
+	/**
+	 * 接收异步加载管线在后台线程上准备好的共享源与解码器（已解码第 0 帧），
+	 * 之后的 CreateResource 直接使用它们，GameThread 上不再解析或解码。
+	 */
+	void ImportPrepared(FAnimatedTexturePreparedLoad& Prepared);
+
 	float RenderFrameToTexture();
 
 	/**
@@ -136,18 +328,279 @@ public: // Internal APIs
 	 */
 	static EAnimatedTextureType DetectTypeFromMagic(const uint8* Buffer, int32 Size);
 
+	/**
+	 * 当前进程是否永远不会显示动画纹理（Dedicated Server，或 -nullrhi 运行的游戏进程）。
+	 * Headless 模式下纹理只保留元数据（尺寸、时长、帧数），不创建解码器、不上传、不 Tick。
+	 * 编辑器与 Commandlet（例如 Cook）不算 Headless，它们仍需要完整的 FileBlob。
+	 */
+	static bool IsHeadless();
+
+	bool IsFrameArrayMode() const { return PlaybackMode == EAnimatedTexturePlaybackMode::FrameArray; }
+
+	/** FrameArray 模式：切片数量与一个循环的时长（秒），材质表达式用它们把时间换算成切片索引 */
+	int32 GetFrameArraySize() const { return FrameArraySlices; }
+	float GetFrameArrayLength() const { return FrameArrayLength; }
+
+	/** FrameArray 模式的播放参数纹理（PlayRate、切片数、循环时长），ParamAnimTextureArray 在运行时读取 */
+	UAnimatedTextureFrameArrayTiming* GetFrameArrayTiming() const { return FrameArrayTiming; }
+
+	/** FrameArray 模式 Texture2DArray 的像素格式：Cook 时烘焙过的资源是压缩格式，否则是 BGRA8 */
+	EPixelFormat GetFrameArrayFormat() const { return BakedFormat != PF_Unknown ? BakedFormat : PF_B8G8R8A8; }
+
+	/**
+	 * 是否按调色板索引上传：开启了 bPaletteIndexed 的 Streaming 模式 GIF，所有帧能共用一个 256 色调色板，且不共用 RHI 纹理。
+	 * 材质需要用 ParamAnimTextureIndexed 采样
+	 */
+	bool IsPaletteIndexed() const
+	{
+		return bPaletteIndexed && FileType == EAnimatedTextureType::Gif && bSourcePaletteIndexable
+			&& !IsFrameArrayMode() && !bShareTexture;
+	}
+
+	/** 索引模式的调色板纹理，开启索引模式或导入文件后读取元数据时创建 */
+	UAnimatedTexturePalette* GetPaletteTexture() const { return PaletteTexture; }
+
+	/** 当前资源的像素格式：索引模式为 PF_R8，16 位上传为 RGB565 / RGBA5551，否则为 BGRA8 */
+	EPixelFormat GetStreamingFormat() const { return StreamingFormat; }
+
 private:
 	UPROPERTY()
 		EAnimatedTextureType FileType = EAnimatedTextureType::None;
 
+	// 编辑器里的文件数据（加载后从 FileBulkData 读入）；
+	// 旧资源（FAnimatedTextureCustomVersion::FileBulkData 之前保存）的文件数据也在这里
 	UPROPERTY()
 		TArray<uint8> FileBlob;
 
+	// 保存后的文件数据：Cook 后位于单独的 bulk 文件 / IoStore chunk，加载包时不读入，
+	// 游戏进程在创建资源时异步读取，见 RequestPayload
+	FByteBulkData FileBulkData;
+
+	// bCookCompressedFrames：Cook 时烘焙的压缩切片（FAnimatedTextureBakedFrames），此时不再保存文件数据
+	FByteBulkData BakedFramesBulkData;
+	EPixelFormat BakedFormat = PF_Unknown;
+
+#if WITH_EDITORONLY_DATA
+	// TranscodeToWebp 之前的原始文件，只保存在编辑器数据中
+	EAnimatedTextureType OriginalFileType = EAnimatedTextureType::None;
+	UE::Serialization::FEditorBulkData OriginalFileData;
+
+	// 按目标平台缓存的烘焙结果，Cook 期间有效
+	TMap<FString, TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe>> CookedBakedFrames;
+#endif
+
+	// 源文件元数据，在创建解码器时刷新并随资源保存；
+	// 服务器 Cook 时 FileBlob 可能被剥离，此时只能依赖这些值
+	UPROPERTY()
+		int32 SourceWidth = 0;
+
+	UPROPERTY()
+		int32 SourceHeight = 0;
+
+	UPROPERTY()
+		int32 SourceFrameCount = 0;
+
+	UPROPERTY()
+		float AnimationLength = 0.0f;
+
+	// 所有帧能否共用一个 256 色调色板，见 IsPaletteIndexed
+	UPROPERTY()
+		bool bSourcePaletteIndexable = false;
+
+	UPROPERTY()
+		TObjectPtr<UAnimatedTexturePalette> PaletteTexture;
+
+	/** 用解码器的结果刷新元数据 */
+	void UpdateSourceMetadata(const FAnimatedTextureDecoder& InDecoder);
+
+	/** 元数据缺失（旧资源）时，只解析一遍文件头来补全 */
+	void EnsureSourceMetadata();
+
+	/** Headless 模式：补全元数据后释放 FileBlob */
+	void ReleaseSourceForHeadless();
+
+	/**
+	 * 按内容从注册表取共享源；游戏进程里取到之后释放 FileBlob，数据只在共享源里保留一份
+	 * （编辑器需要 FileBlob 保存资源，不释放）
+	 */
+	bool AcquireSharedSource();
+
+	/** 离开共用 RHI 纹理的分组 */
+	void LeaveTextureGroup();
+
+	bool HasBulkPayload() const { return FileBulkData.GetBulkDataSize() > 0; }
+
+	/** 编辑器数据：转码前的原始文件（Cook 时被过滤） */
+	void SerializeOriginalSource(FArchive& Ar);
+
+	bool HasBakedFrames() const { return BakedFormat != PF_Unknown && BakedFramesBulkData.GetBulkDataSize() > 0; }
+
+#if WITH_EDITOR
+	/** TranscodeToWebp 与 OptimizeAnimation 的实现：bOptimize 时按合成像素与文件大小决定是否采用 */
+	bool ReencodeGifAsWebp(const FAnimatedTextureWebpSettings& Settings, bool bOptimize);
+
+	/** Cook：烘焙（或从 DDC 取）目标平台的压缩切片；没有启用、不适用或烘焙失败时返回 nullptr */
+	TSharedPtr<FAnimatedTextureBakedFrames, ESPMode::ThreadSafe> FindOrBakeFrames(const ITargetPlatform* TargetPlatform);
+#endif
+
+	/** 同步读取 FileBulkData 的全部内容（编辑器、补全元数据） */
+	bool ReadBulkPayload(TArray<uint8>& OutBytes);
+
+	/**
+	 * 游戏进程：异步读取 FileBulkData，读入后在后台解析并解码第一帧，完成时重建资源；
+	 * 烘焙过的资源读取 BakedFramesBulkData，读入后直接上传
+	 */
+	void RequestPayload();
+
+	/** GameThread：bulk data 读取完成（失败时 Payload 为空） */
+	void OnPayloadRead(FSharedBuffer Payload);
+
+	/** GameThread：解析与第一帧解码完成，交接共享源与解码器 */
+	void OnPayloadPrepared(FAnimatedTexturePreparedLoad& Prepared, EAnimatedTextureLoadError Error);
+
+	/** 取消进行中的读取与解析，丢弃它们的结果 */
+	void CancelPayloadRequest();
+
+private:	// Tick manager interface, see UAnimatedTextureSubsystem
+	friend class UAnimatedTextureSubsystem;
+
+	/** 把 FrameTime 推进到管理器的当前时钟 */
+	void SyncFrameTime();
+
+	/** 下一帧到期的管理器时钟；暂停时返回 TNumericLimits<double>::Max() */
+	double GetNextFrameClock() const;
+
+	/**
+	 * 按流逝的时间计算需要跳过几帧（当前帧之后、应该显示的帧之前）
+	 * @return 应该显示的帧已经播放了多久（秒）
+	 */
+	float CountElapsedFrames(uint32 DefaultDelayMs, uint32& OutNumSkip) const;
+
+	/** 解码按时间应该显示的帧并拷贝像素到 OutUpdate；只访问本纹理自己的解码器，可在工作线程并行调用 */
+	void DecodeFrame(FAnimatedTextureFrameUpdate& OutUpdate);
+
+	/** GameThread：DecodeFrame 之后的收尾，开始计时新的一帧 */
+	void FinishFrame();
+
+	/** GameThread：立即解码到期的帧并提交上传（不经过管理器） */
+	void UpdateFrameNow();
+
+	/** 定位到 FrameIndex 帧开始之后 OffsetSeconds 的位置并立即显示该帧 */
+	void SeekInternal(int32 FrameIndex, float OffsetSeconds);
+
+	void UnregisterFromTick();
+
+	/** 播放中、没有停在最后一帧、且不是 Manual 策略时才需要 Tick */
+	bool ShouldTick() const;
+
+	/** 播放状态改变后调用：需要 Tick 时注册并重新计算到期时间，否则从管理器注销 */
+	void UpdateTickRegistration();
+
+	/** WhenRendered 策略下最近是否被材质采样过；从未上报渲染时间的纹理（例如只用在 UMG 中）视为可见 */
+	bool IsRenderedRecently(double Now) const;
+
+	/** 创建预解码队列与 staging buffer，从第一帧开始 Tick */
+	void StartPlayback();
+
+	/** IsPaletteIndexed 时把解码器切换到索引输出并更新调色板纹理；共享帧缓存的解码器换成独立的 GIF 解码器 */
+	void EnableIndexedOutput();
+
+	/** 创建（需要时）调色板子对象并写入 256 个颜色 */
+	void UpdatePaletteTexture(const FColor* Colors);
+
+	/** 按 UploadFormat、AnimatedTexture.CompactUpload 与解码器的透明度决定 StreamingFormat，16 位格式时创建 Packer */
+	void ResolveStreamingFormat();
+
+	/** 播放方向改变后重建解码状态（解码器外层的反向/往返包装），并回到原来显示的帧 */
+	void ApplyPlayDirection();
+
+private:	// Memory budget interface, see UAnimatedTextureSubsystem
+	/** 解码器、预解码队列与 staging buffer 占用的 CPU 内存（共享源单独统计） */
+	SIZE_T GetDecodeStateSize() const;
+
+	/** 最近一次被渲染或被播放接口使用的时间（FApp::GetCurrentTime），LRU 淘汰按它排序 */
+	double GetLastUsedTime() const;
+
+	/** 共用 RHI 纹理的分组与 FrameArray 模式不参与淘汰 */
+	bool CanEvictDecodeState() const;
+
+	/** 持有解码器的纹理登记到子系统，停止、播完、没有被渲染的纹理也计入预算 */
+	void RegisterDecodeState();
+	void UnregisterDecodeState();
+
+	/**
+	 * 释放解码状态并停止 Tick，RHI 纹理保留最后上传的画面；
+	 * bReleaseSource 时游戏进程里可以重新读取的文件数据（bulk data）也一起释放
+	 */
+	void EvictDecodeState(bool bReleaseSource = true);
+
+	/** 被淘汰后重新被渲染或调用播放接口时，重建解码状态并从动画开头播放 */
+	void RestoreDecodeState();
+
+	/** 记录一次使用；解码状态已被淘汰时立即重建 */
+	void TouchDecodeState();
+
 private:
 	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> Decoder;
+	TSharedPtr<FAnimatedTextureDecodeAhead, ESPMode::ThreadSafe> DecodeAhead;
+	TSharedPtr<FAnimatedTextureStagingPool, ESPMode::ThreadSafe> StagingPool;
+	TSharedPtr<FAnimatedTextureSharedSource, ESPMode::ThreadSafe> SharedSource;
+	TSharedPtr<FAnimatedTextureDecoder, ESPMode::ThreadSafe> PreparedDecoder;	// ImportPrepared 交接的解码器，由 CreateResource 取走
+	bool bInTextureGroup = false;
 
-	float AnimationLength = 0.0f;
 	float FrameDelay = 0.0f;
 	float FrameTime = 0.0f;
 	bool bPlaying = true;
+
+	int32 TickSlot = INDEX_NONE;
+	double LastSyncClock = 0;
+	uint32 PendingFrameDelay = 0;	// milliseconds, written by DecodeFrame
+	bool bPendingFromDecodeAhead = false;
+	bool bPendingFrame = false;		// DecodeFrame 是否得到了新的一帧
+	int32 PendingFrameIndex = INDEX_NONE;
+	float PendingFrameTime = 0.0f;	// 新的一帧已经播放了多久（追赶之后的余量）
+
+	int32 CurrentFrame = INDEX_NONE;	// 正在显示的帧
+	bool bFinished = false;			// 不循环且已经显示到最后一帧
+
+	FIntRect PendingDirtyRect;		// 已解码但还没有上传的画布区域
+	bool bIndexedUpload = false;	// 解码器输出调色板索引，RHI 纹理是 PF_R8
+	EPixelFormat StreamingFormat = PF_B8G8R8A8;
+	TSharedPtr<FAnimatedTexturePixelPacker, ESPMode::ThreadSafe> Packer;	// BGRA 画布 -> 16 位格式，预解码队列共用
+	bool bForceFullUpload = true;
+	bool bFirstFrameDecoded = false;	// 解码器已经输出了第 0 帧（加载管线预解码），比 CurrentFrame 领先一帧
+
+	double LastUsedTime = 0;
+	bool bDecodeStateEvicted = false;
+	float EvictedPosition = -1.0f;	// 淘汰时的播放位置（秒），-1 表示还没有显示过帧
+	double EvictedClock = 0;		// 淘汰时子系统的时钟
+
+	IBulkDataIORequest* PayloadIORequest = nullptr;
+	TSharedPtr<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> PayloadTask;
+	uint32 PayloadSerial = 0;		// 用于丢弃过期（已取消或已重新导入）的读取结果
+	bool bPayloadPending = false;
+
+	/** FrameArray 模式：在工作线程合成所有切片，完成后回到 GameThread 上传 */
+	FTextureResource* CreateFrameArrayResource();
+
+	/** 烘焙过的 FrameArray：按保存的格式与切片数创建资源，压缩切片读入后上传 */
+	FTextureResource* CreateBakedFrameArrayResource();
+
+	/** GameThread：压缩切片读取完成，在工作线程反序列化后上传 */
+	void UploadBakedFrames(FSharedBuffer Payload);
+
+	// 材质编译（包括 Cook）需要这两个值，随资源一起保存
+	UPROPERTY()
+		int32 FrameArraySlices = 0;
+
+	UPROPERTY()
+		float FrameArrayLength = 0.0f;
+
+	UPROPERTY()
+		TObjectPtr<UAnimatedTextureFrameArrayTiming> FrameArrayTiming;
+
+	/** 把 PlayRate 与当前的切片布局写入 FrameArrayTiming，第一次调用时创建它 */
+	void UpdateFrameArrayTiming();
+
+	uint32 FrameArrayBuildSerial = 0;	// 用于丢弃过期（Resource 已重建）的合成结果
 };
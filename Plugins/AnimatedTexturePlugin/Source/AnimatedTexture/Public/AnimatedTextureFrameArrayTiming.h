@@ -0,0 +1,54 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Playback parameters of FrameArray animated textures
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Texture.h"
+#include "AnimatedTextureFrameArrayTiming.generated.h"
+
+/**
+ * 1×1 的 RGBA32F 纹理，保存 FrameArray 模式选择切片所需的播放参数，点采样
+ *
+ * ParamAnimTextureArray 从这里读取 PlayRate、切片数与循环时长，而不是把它们编译成常量：
+ * 运行时 SetPlayRate、重新合成或 Cook 烘焙改变了切片布局，都不需要重新编译材质。
+ * UAnimatedTexture2D 在 FrameArray 模式下创建它并作为子对象随资源保存。
+ */
+UCLASS(Within = AnimatedTexture2D)
+class ANIMATEDTEXTURE_API UAnimatedTextureFrameArrayTiming : public UTexture
+{
+	GENERATED_BODY()
+
+public:
+	UAnimatedTextureFrameArrayTiming(const FObjectInitializer& ObjectInitializer);
+
+	/**
+	 * GameThread：写入播放参数，改变时重建资源
+	 * @param Length	循环时长（秒），NumSlices 个切片平均分配
+	 */
+	void SetTiming(float PlayRate, int32 NumSlices, float Length);
+
+	/** 纹素内容：X = PlayRate / Length，Y = 1 / Length，Z = NumSlices */
+	const FVector4f& GetValue() const { return Value; }
+
+public:	// UTexture Interface
+	virtual float GetSurfaceWidth() const override { return 1; }
+	virtual float GetSurfaceHeight() const override { return 1; }
+	virtual float GetSurfaceDepth() const override { return 0; }
+	virtual uint32 GetSurfaceArraySize() const override { return 0; }
+	virtual ETextureClass GetTextureClass() const override { return ETextureClass::TwoDDynamic; }
+
+	virtual FTextureResource* CreateResource() override;
+	virtual EMaterialValueType GetMaterialType() const override { return MCT_Texture2D; }
+
+private:
+	UPROPERTY()
+		FVector4f Value = FVector4f(0, 0, 0, 0);
+};
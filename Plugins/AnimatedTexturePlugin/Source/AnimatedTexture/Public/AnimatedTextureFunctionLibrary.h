@@ -18,16 +18,21 @@
 #include "AnimatedTextureLoadTypes.h"
 #include "AnimatedTextureFunctionLibrary.generated.h"
 
+class UMaterialInstanceDynamic;
+
 /**
  * UAnimatedTextureFunctionLibrary
  *
  * Runtime Load 入口集合。所有函数对蓝图和 C++ 均可见（除内部原子函数 InitAnimatedTextureFromMemory 之外）。
  *
  * 调用关系（唯一真源）：
- *   LoadAnimatedTextureFromFile   -> LoadAnimatedTextureFromMemory -> InitAnimatedTextureFromMemory -> UAnimatedTexture2D::ImportFile
- *   AsyncLoadAnimatedTextureFromFile -> LoadAnimatedTextureFromMemory
- *   AsyncDownloadAnimatedTexture     -> LoadAnimatedTextureFromMemory
+ *   LoadAnimatedTextureFromFile   -> (内存映射) LoadAnimatedTextureFromBuffer -> InitAnimatedTextureFromBuffer -> UAnimatedTexture2D::ImportFile
+ *   LoadAnimatedTextureFromMemory -> LoadAnimatedTextureFromBuffer -> InitAnimatedTextureFromBuffer -> UAnimatedTexture2D::ImportFile
+ *   AsyncLoadAnimatedTextureFromFile -> FAnimatedTextureLoadTask (后台：IO/解析/第一帧解码) -> UAnimatedTexture2D::ImportPrepared
+ *   AsyncDownloadAnimatedTexture     -> FAnimatedTextureLoadTask (后台：解析/第一帧解码) -> UAnimatedTexture2D::ImportPrepared
  *   UAnimatedTextureFactory::FactoryCreateBinary -> InitAnimatedTextureFromMemory (Editor 走 PostEditChange 触发 UpdateResource)
+ *
+ * 材质参数：SetAnimatedTextureParameterValue 同时覆盖纹理参数和材质节点从纹理派生出的伴随参数。
  */
 UCLASS()
 class ANIMATEDTEXTURE_API UAnimatedTextureFunctionLibrary : public UBlueprintFunctionLibrary
@@ -48,6 +53,12 @@ public:
 	 */
 	static bool InitAnimatedTextureFromMemory(UAnimatedTexture2D* Target, const uint8* Buffer, int32 BufferSize, EAnimatedTextureType Type = EAnimatedTextureType::None);
 
+	/**
+	 * 同 InitAnimatedTextureFromMemory，但接管 Buffer 的所有权（纯 C++ 接口）：
+	 * 游戏进程里自己持有内存的 Buffer（MakeSharedBufferFromArray、内存映射的文件）直接交给纹理的共享源，不再拷贝。
+	 */
+	static bool InitAnimatedTextureFromBuffer(UAnimatedTexture2D* Target, const FSharedBuffer& Buffer, EAnimatedTextureType Type = EAnimatedTextureType::None);
+
 	/**
 	 * 从一段字节流同步创建 UAnimatedTexture2D。
 	 * 内部会 NewObject 出一个新的瞬态对象、调用 InitAnimatedTextureFromMemory、最后主动调用 UpdateResource。
@@ -65,14 +76,50 @@ public:
 		UObject* Outer = nullptr,
 		FName Name = NAME_None);
 
+	/** 同上，接管 Bytes 的内存，不再拷贝（纯 C++ 接口）。 */
+	static UAnimatedTexture2D* LoadAnimatedTextureFromMemory(
+		TArray<uint8>&& Bytes,
+		EAnimatedTextureType Type = EAnimatedTextureType::None,
+		UObject* Outer = nullptr,
+		FName Name = NAME_None);
+
+	/** 同上，接管 Buffer 的所有权（纯 C++ 接口）；上面两个函数最终都走这里。 */
+	static UAnimatedTexture2D* LoadAnimatedTextureFromBuffer(
+		const FSharedBuffer& Buffer,
+		EAnimatedTextureType Type = EAnimatedTextureType::None,
+		UObject* Outer = nullptr,
+		FName Name = NAME_None);
+
 	/**
 	 * 从本地文件路径同步加载。失败时返回 nullptr，并通过 OutError 返回错误码。
 	 * 相对路径相对于 FPaths::ProjectDir()；绝对路径按原样使用。
 	 * 内部会先用文件扩展名推断类型，再 fallback 到 magic bytes 嗅探。
+	 * 平台支持时文件以内存映射方式打开，解码器访问到哪里才读入哪里，不再整读进内存。
 	 * 必须在 GameThread 调用。
 	 */
 	UFUNCTION(BlueprintCallable, Category = "AnimatedTexture|Runtime Load")
 	static UAnimatedTexture2D* LoadAnimatedTextureFromFile(
 		const FString& FilePath,
 		EAnimatedTextureLoadError& OutError);
+
+	/**
+	 * 在动态材质实例里覆盖动画纹理参数，并一起覆盖材质节点读取的伴随参数
+	 * （FrameArray 模式的 "<ParameterName>Timing"，调色板索引模式的 "<ParameterName>Palette"）。
+	 * 伴随参数是独立的纹理参数，着色器无法从主参数推出它；只调用 SetTextureParameterValue 会留下材质默认纹理的伴随参数，
+	 * 播放的切片或查出的颜色就对不上了。Texture 为空时只清除主参数。
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AnimatedTexture|Material")
+	static void SetAnimatedTextureParameterValue(
+		UMaterialInstanceDynamic* Material,
+		FName ParameterName,
+		UAnimatedTexture2D* Texture);
+
+	/**
+	 * 纹理作为 ParameterName 的值时，材质节点还需要的伴随纹理参数及其取值（纯 C++ 接口）。
+	 * 编辑器用它让材质实例常量里的覆盖保持一致。
+	 */
+	static void GetCompanionTextureParameters(
+		const UAnimatedTexture2D* Texture,
+		FName ParameterName,
+		TArray<TPair<FName, UTexture*>>& OutParameters);
 };
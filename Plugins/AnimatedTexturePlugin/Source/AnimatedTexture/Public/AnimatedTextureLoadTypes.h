@@ -37,5 +37,22 @@ enum class EAnimatedTextureLoadError : uint8
 	/** 下载大小超过上限 */
 	SizeLimitExceeded	UMETA(DisplayName = "Size Limit Exceeded"),
 	/** URL 非法或 scheme 不支持 */
-	InvalidUrl			UMETA(DisplayName = "Invalid Url")
+	InvalidUrl			UMETA(DisplayName = "Invalid Url"),
+	/** 加载被 Cancel() 中止 */
+	Canceled			UMETA(DisplayName = "Canceled")
+};
+
+/**
+ * 异步加载管线（文件 IO、容器解析、第一帧解码）在后台线程上的优先级。
+ * 大量纹理同时加载时，High 的任务先于 Normal / Low 执行。
+ */
+UENUM(BlueprintType)
+enum class EAnimatedTextureLoadPriority : uint8
+{
+	/** 后台普通优先级，适合预加载 */
+	Low					UMETA(DisplayName = "Low"),
+	/** 后台高优先级（默认） */
+	Normal				UMETA(DisplayName = "Normal"),
+	/** 前台工作线程，适合马上要显示的纹理 */
+	High				UMETA(DisplayName = "High")
 };
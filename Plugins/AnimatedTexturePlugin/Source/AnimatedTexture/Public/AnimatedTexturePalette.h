@@ -0,0 +1,51 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Palette texture for palette-indexed animated textures
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Texture.h"
+#include "AnimatedTexturePalette.generated.h"
+
+/**
+ * 256×1 的调色板纹理，点采样
+ *
+ * UAnimatedTexture2D 开启 bPaletteIndexed 时创建并作为子对象随资源保存，
+ * ParamAnimTextureIndexed 用索引纹理采样到的值在这里查颜色。内容由所属纹理在读取文件元数据时写入。
+ */
+UCLASS(Within = AnimatedTexture2D)
+class ANIMATEDTEXTURE_API UAnimatedTexturePalette : public UTexture
+{
+	GENERATED_BODY()
+
+public:
+	UAnimatedTexturePalette(const FObjectInitializer& ObjectInitializer);
+
+	static constexpr int32 NumColors = 256;
+
+	/** GameThread：写入 NumColors 个 BGRA 颜色，内容改变时重建资源 */
+	void SetColors(const FColor* InColors);
+
+	const TArray<FColor>& GetColors() const { return Colors; }
+
+public:	// UTexture Interface
+	virtual float GetSurfaceWidth() const override { return NumColors; }
+	virtual float GetSurfaceHeight() const override { return 1; }
+	virtual float GetSurfaceDepth() const override { return 0; }
+	virtual uint32 GetSurfaceArraySize() const override { return 0; }
+	virtual ETextureClass GetTextureClass() const override { return ETextureClass::TwoDDynamic; }
+
+	virtual FTextureResource* CreateResource() override;
+	virtual EMaterialValueType GetMaterialType() const override { return MCT_Texture2D; }
+
+private:
+	UPROPERTY()
+		TArray<FColor> Colors;
+};
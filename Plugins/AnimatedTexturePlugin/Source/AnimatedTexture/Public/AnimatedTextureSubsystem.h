@@ -0,0 +1,128 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Central tick manager for all live UAnimatedTexture2D objects
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Tickable.h"	// Engine
+#include <atomic>
+#include "AnimatedTextureSubsystem.generated.h"
+
+class UAnimatedTexture2D;
+
+/**
+ * 所有动画纹理共用的 Tick 管理器
+ *
+ * - 每个纹理按「下一帧到期时间」放进一个小根堆，每次 Tick 只弹出到期的纹理，
+ *   游戏线程开销与本帧需要换帧的纹理数量成正比，而不是与存活纹理的总数成正比；
+ * - 到期纹理的解码通过 ParallelFor 分散到多个核心；
+ * - 所有纹理的上传合并成一条渲染命令提交；
+ * - 只有正在播放的纹理才注册；TickPolicy 为 WhenRendered 的纹理一段时间没有被渲染就移出调度，
+ *   再次被渲染时按流逝的时间追到应该显示的帧；
+ * - 解码状态（解码器、预解码队列、staging buffer、共享帧缓存）的总内存超过 AnimatedTexture.MemoryBudgetMB 时，
+ *   按最近一次渲染时间淘汰闲置纹理的解码状态，它们再次被渲染时重建；收到引擎的 MemoryTrim 通知时淘汰所有闲置纹理。
+ *
+ * 所有接口只能在 GameThread 调用。
+ */
+UCLASS()
+class ANIMATEDTEXTURE_API UAnimatedTextureSubsystem : public UEngineSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** 引擎尚未初始化（或已经销毁）时返回 nullptr */
+	static UAnimatedTextureSubsystem* Get();
+
+	//~ Begin USubsystem Interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override
+	{
+		return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Always;
+	}
+	virtual TStatId GetStatId() const override
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(UAnimatedTextureSubsystem, STATGROUP_Tickables);
+	}
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+	//~ End FTickableGameObject Interface
+
+public:	// Internal APIs, used by UAnimatedTexture2D
+	void Register(UAnimatedTexture2D* Texture);
+	void Unregister(UAnimatedTexture2D* Texture);
+
+	/** 纹理的播放状态（播放/暂停/PlayRate/当前帧）改变后调用，重新计算下一帧到期时间 */
+	void Reschedule(UAnimatedTexture2D* Texture);
+
+	/** 管理器时钟（秒），所有纹理的播放时间都基于此时钟推进 */
+	double GetClock() const { return Clock; }
+
+	int32 GetNumRegistered() const { return Slots.Num(); }
+
+	/** 持有解码状态的纹理，与是否在 Tick 无关；内存预算只统计、淘汰这些纹理 */
+	void RegisterDecodeState(UAnimatedTexture2D* Texture);
+	void UnregisterDecodeState(UAnimatedTexture2D* Texture);
+
+private:
+	struct FSlot
+	{
+		UAnimatedTexture2D* Texture = nullptr;
+		uint32 Serial = 0;
+		bool bHidden = false;	// 没有被渲染，暂时移出调度
+	};
+
+	struct FScheduleEntry
+	{
+		double DueTime = 0;
+		int32 SlotIndex = INDEX_NONE;
+		uint32 Serial = 0;
+
+		bool operator<(const FScheduleEntry& Other) const { return DueTime < Other.DueTime; }
+	};
+
+	bool IsEntryValid(const FScheduleEntry& Entry) const;
+	void CompactSchedule();
+
+	/** 把重新被渲染的隐藏纹理放回调度 */
+	void UpdateHiddenTextures();
+
+	/** 统计解码状态内存，超出预算时按 LRU 淘汰，并恢复重新被渲染的纹理 */
+	void UpdateMemoryBudget();
+
+	/** 任意线程：引擎的 MemoryTrim 通知，在下一次 Tick 处理 */
+	void OnMemoryTrim();
+
+private:
+	double Clock = 0;
+
+	TSparseArray<FSlot> Slots;
+	TArray<FScheduleEntry> Schedule;	// 小根堆，包含已失效（Serial 不匹配）的条目，弹出时丢弃
+
+	TArray<UAnimatedTexture2D*> DueTextures;	// Tick 内复用，避免每帧分配
+
+	int32 NumHidden = 0;
+	double NextVisibilityUpdateTime = 0;
+
+	TSet<UAnimatedTexture2D*> DecodeStateOwners;	// 纹理在 BeginDestroy 中注销
+	TArray<TWeakObjectPtr<UAnimatedTexture2D>> EvictedTextures;
+	TArray<UAnimatedTexture2D*> EvictCandidates;
+	double NextBudgetUpdateTime = 0;
+	std::atomic<bool> bMemoryTrimRequested{ false };
+	FDelegateHandle MemoryTrimHandle;
+};
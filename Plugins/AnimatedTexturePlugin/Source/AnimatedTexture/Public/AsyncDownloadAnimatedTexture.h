@@ -16,6 +16,7 @@
 
 class UAnimatedTexture2D;
 class FAnimatedTextureDownloader;
+class FAnimatedTextureLoadTask;
 
 /** 成功回调：Texture 非空；Url / ETag 为附加信息。 */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(
@@ -35,7 +36,8 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
 /**
  * 蓝图异步节点：通过 HTTP(S) 下载 .gif / .webp 并生成 UAnimatedTexture2D。
  * 提供 OnSuccess / OnCanceled / OnFailed 三个执行引脚。
- * 调用 Cancel() 可主动取消下载；Cancel 后会触发一次 OnCanceled 事件。
+ * 下载完成后，解析、校验与第一帧解码在后台线程执行（见 FAnimatedTextureLoadTask），GameThread 只创建对象。
+ * 调用 Cancel() 可主动取消下载或之后的解析；Cancel 后会触发一次 OnCanceled 事件。
  */
 UCLASS()
 class ANIMATEDTEXTURE_API UAsyncDownloadAnimatedTexture : public UBlueprintAsyncActionBase
@@ -65,18 +67,20 @@ public:
 	 * @param Url                HTTP(S) URL。
 	 * @param Timeout            超时（秒），默认 30。
 	 * @param MaxBytes           最大下载字节数，默认 32MB；<=0 表示不限制。
+	 * @param Priority           下载完成后后台解析任务的优先级。
 	 */
 	UFUNCTION(BlueprintCallable,
 		meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject",
 			DisplayName = "Download Animated Texture",
-			Category = "AnimatedTexture|Runtime Load"))
+			Category = "AnimatedTexture|Runtime Load", AdvancedDisplay = "Priority"))
 	static UAsyncDownloadAnimatedTexture* DownloadAnimatedTexture(
 		UObject* WorldContextObject,
 		const FString& Url,
 		float Timeout = 30.0f,
-		int32 MaxBytes = 33554432 /* 32 * 1024 * 1024 */);
+		int32 MaxBytes = 33554432 /* 32 * 1024 * 1024 */,
+		EAnimatedTextureLoadPriority Priority = EAnimatedTextureLoadPriority::Normal);
 
-	/** 取消下载。会触发一次 OnCanceled；之后不再触发 OnSuccess/OnFailed。 */
+	/** 取消下载（或下载完成后的后台解析）。会触发一次 OnCanceled；之后不再触发 OnSuccess/OnFailed。 */
 	UFUNCTION(BlueprintCallable, Category = "AnimatedTexture|Runtime Load")
 	void Cancel();
 
@@ -85,10 +89,12 @@ public:
 	//~ End UBlueprintAsyncActionBase Interface
 
 private:
-	/** 发起 HTTP 完成回调（成功路径）。 */
-	void HandleComplete(const TArray<uint8>& Body, const FString& ETag);
+	/** 发起 HTTP 完成回调（成功路径），接管响应体。 */
+	void HandleComplete(TArray<uint8>&& Body, const FString& ETag);
 	/** 发起 HTTP 失败回调。 */
 	void HandleError(EAnimatedTextureLoadError Error);
+	/** 后台解析完成回调（GameThread）。 */
+	void HandleLoaded(UAnimatedTexture2D* Texture, EAnimatedTextureLoadError Error);
 
 private:
 	UPROPERTY()
@@ -97,8 +103,11 @@ private:
 	FString UrlCached;
 	float TimeoutCached = 30.0f;
 	int32 MaxBytesCached = 32 * 1024 * 1024;
+	EAnimatedTextureLoadPriority PriorityCached = EAnimatedTextureLoadPriority::Normal;
+	FString ETagCached;
 
 	TSharedPtr<FAnimatedTextureDownloader, ESPMode::ThreadSafe> Downloader;
+	TSharedPtr<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> LoadTask;
 
 	bool bFinished = false;
 };
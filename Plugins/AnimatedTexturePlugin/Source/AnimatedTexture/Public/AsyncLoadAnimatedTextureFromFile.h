@@ -15,6 +15,7 @@
 #include "AsyncLoadAnimatedTextureFromFile.generated.h"
 
 class UAnimatedTexture2D;
+class FAnimatedTextureLoadTask;
 
 /**
  * 异步本地加载结果委托。
@@ -28,11 +29,13 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(
 
 /**
  * 蓝图异步节点：从本地文件异步加载 UAnimatedTexture2D。
- * 文件 IO 在后台线程执行；对象构造与 UpdateResource 回到 GameThread。
+ * 文件 IO、容器解析、元数据校验与第一帧解码都在后台线程执行（见 FAnimatedTextureLoadTask）；
+ * GameThread 只负责构造对象、交接解码器与 UpdateResource。
  *
  * 使用方式（蓝图）：
  *   - 节点名 "Load Animated Texture From File Async"
- *   - 输入 File Path；输出 OnSuccess / OnFailed 两个执行引脚 + Texture / Error 两个数据引脚。
+ *   - 输入 File Path / Priority；输出 OnSuccess / OnFailed / OnCanceled 三个执行引脚 + Texture / Error 两个数据引脚。
+ *   - 调用 Cancel() 可中止加载；Cancel 后会触发一次 OnCanceled 事件。
  */
 UCLASS()
 class ANIMATEDTEXTURE_API UAsyncLoadAnimatedTextureFromFile : public UBlueprintAsyncActionBase
@@ -52,25 +55,44 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FAnimatedTextureLoadFileResult OnFailed;
 
+	/** 被 Cancel() 中止：Texture 为 nullptr，Error 为 Canceled */
+	UPROPERTY(BlueprintAssignable)
+	FAnimatedTextureLoadFileResult OnCanceled;
+
 	/**
 	 * 静态工厂方法：创建并启动一个异步加载节点。
 	 * @param WorldContextObject 蓝图上下文（一般自动填充）。若失效节点会静默退出。
 	 * @param FilePath 本地文件路径；相对路径相对于 FPaths::ProjectDir()。
+	 * @param Priority 后台加载任务的优先级。
 	 */
 	UFUNCTION(BlueprintCallable,
 		meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject",
 			DisplayName = "Load Animated Texture From File Async",
-			Category = "AnimatedTexture|Runtime Load"))
+			Category = "AnimatedTexture|Runtime Load", AdvancedDisplay = "Priority"))
 	static UAsyncLoadAnimatedTextureFromFile* LoadAnimatedTextureFromFileAsync(
-		UObject* WorldContextObject, const FString& FilePath);
+		UObject* WorldContextObject, const FString& FilePath,
+		EAnimatedTextureLoadPriority Priority = EAnimatedTextureLoadPriority::Normal);
+
+	/** 中止加载。会触发一次 OnCanceled；之后不再触发 OnSuccess/OnFailed。 */
+	UFUNCTION(BlueprintCallable, Category = "AnimatedTexture|Runtime Load")
+	void Cancel();
 
 	//~ Begin UBlueprintAsyncActionBase Interface
 	virtual void Activate() override;
 	//~ End UBlueprintAsyncActionBase Interface
 
+private:
+	/** 加载管线完成回调（GameThread）。 */
+	void HandleLoaded(UAnimatedTexture2D* Texture, EAnimatedTextureLoadError Error);
+
 private:
 	UPROPERTY()
 	TWeakObjectPtr<UObject> WorldContextWeak;
 
 	FString FilePathCached;
+	EAnimatedTextureLoadPriority PriorityCached = EAnimatedTextureLoadPriority::Normal;
+
+	TSharedPtr<FAnimatedTextureLoadTask, ESPMode::ThreadSafe> LoadTask;
+
+	bool bFinished = false;
 };
@@ -0,0 +1,49 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Animated Texture from GIF file
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Materials/MaterialExpressionTextureSampleParameter.h"
+#include "MtlExpTextureSampleParameterAnimArray.generated.h"
+
+/**
+ * 采样 FrameArray 模式的 UAnimatedTexture2D：按时间在着色器里选择 Texture2DArray 切片，CPU 不参与播放。
+ * PlayRate、切片数与循环时长在运行时从纹理的播放参数纹理（名为 "<ParameterName>Timing" 的纹理参数）读取。
+ * 两个参数是耦合的：着色器无法从 <ParameterName> 推出它的播放参数纹理，覆盖纹理时必须同时覆盖 Timing。
+ * 材质实例常量由编辑器自动同步；动态材质实例请用 UAnimatedTextureFunctionLibrary::SetAnimatedTextureParameterValue。
+ */
+UCLASS(collapsecategories, hidecategories = Object)
+class ANIMATEDTEXTURE_API UMtlExpTextureSampleParameterAnimArray : public UMaterialExpressionTextureSampleParameter
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Playback time in seconds, defaults to game time when not connected */
+	UPROPERTY(meta = (RequiredInput = "false", ToolTip = "Playback time in seconds, defaults to game time"))
+		FExpressionInput Time;
+
+	/** Added to the playback time, e.g. per-instance random to desync copies */
+	UPROPERTY(meta = (RequiredInput = "false", ToolTip = "Time offset in seconds"))
+		FExpressionInput PhaseOffset;
+
+	//~ Begin UMaterialExpression Interface
+#if WITH_EDITOR
+	virtual int32 Compile(class FMaterialCompiler* Compiler, int32 OutputIndex) override;
+	virtual void GetCaption(TArray<FString>& OutCaptions) const override;
+#endif // WITH_EDITOR
+	//~ End UMaterialExpression Interface
+
+	//~ Begin UMaterialExpressionTextureSampleParameter Interface
+#if WITH_EDITOR
+	virtual bool TextureIsValid(UTexture* InTexture, FString& OutMessage) override;
+	virtual void SetDefaultTexture() override;
+#endif // WITH_EDITOR
+	//~ End UMaterialExpressionTextureSampleParameter Interface
+};
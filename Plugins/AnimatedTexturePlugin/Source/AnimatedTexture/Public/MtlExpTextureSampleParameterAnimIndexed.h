@@ -0,0 +1,40 @@
+/**
+ * Copyright 2019 Neil Fang. All Rights Reserved.
+ *
+ * Animated Texture from GIF file
+ *
+ * Created by Neil Fang
+ * GitHub: https://github.com/neil3d/UAnimatedTexture5
+ *
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Materials/MaterialExpressionTextureSampleParameter.h"
+#include "MtlExpTextureSampleParameterAnimIndexed.generated.h"
+
+/**
+ * 采样调色板索引模式的 UAnimatedTexture2D：点采样 R8 索引纹理，再用索引在 256x1 调色板纹理里查出颜色。
+ * 调色板是另一个名为 "<ParameterName>Palette" 的纹理参数。两个参数是耦合的：着色器无法从 <ParameterName> 推出它的调色板，
+ * 覆盖纹理时必须同时覆盖 Palette。材质实例常量由编辑器自动同步；动态材质实例请用 UAnimatedTextureFunctionLibrary::SetAnimatedTextureParameterValue。
+ */
+UCLASS(collapsecategories, hidecategories = Object)
+class ANIMATEDTEXTURE_API UMtlExpTextureSampleParameterAnimIndexed : public UMaterialExpressionTextureSampleParameter
+{
+	GENERATED_UCLASS_BODY()
+
+	//~ Begin UMaterialExpression Interface
+#if WITH_EDITOR
+	virtual int32 Compile(class FMaterialCompiler* Compiler, int32 OutputIndex) override;
+	virtual void GetCaption(TArray<FString>& OutCaptions) const override;
+#endif // WITH_EDITOR
+	//~ End UMaterialExpression Interface
+
+	//~ Begin UMaterialExpressionTextureSampleParameter Interface
+#if WITH_EDITOR
+	virtual bool TextureIsValid(UTexture* InTexture, FString& OutMessage) override;
+	virtual void SetDefaultTexture() override;
+#endif // WITH_EDITOR
+	//~ End UMaterialExpressionTextureSampleParameter Interface
+};
@@ -39,6 +39,10 @@ public class AnimatedTextureEditor : ModuleRules
                 "RHI",
                 "RenderCore",
                 "UnrealEd",
+                "Slate",
+                "SlateCore",
+                "ToolMenus",
+                "ContentBrowser",
                 "AnimatedTexture"
 			}
             );
@@ -10,15 +10,114 @@
 
 #include "AnimatedTextureEditorModule.h"
 #include "AnimatedTextureThumbnailRenderer.h"
+#include "AnimatedTextureFactory.h"
 #include "AnimatedTexture2D.h"
+#include "AnimatedTextureFunctionLibrary.h"
+#include "Materials/MaterialInstanceConstant.h"	// Engine
+#include "UObject/UObjectGlobals.h"	// CoreUObject
 #include "Misc/CoreDelegates.h"	// Core
+#include "Misc/ScopedSlowTask.h"	// Core
 #include "ThumbnailRendering/ThumbnailManager.h"	// UnrealEd
+#include "ToolMenus.h"	// ToolMenus
+#include "ContentBrowserMenuContexts.h"	// ContentBrowser
 
 #define LOCTEXT_NAMESPACE "FAnimatedTextureEditorModule"
 
 void FAnimatedTextureEditorModule::StartupModule()
 {
 	FCoreDelegates::OnPostEngineInit.AddRaw(this, &FAnimatedTextureEditorModule::OnPostEngineInit);
+	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FAnimatedTextureEditorModule::RegisterMenus));
+	PropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddStatic(&FAnimatedTextureEditorModule::OnObjectPropertyChanged);
+}
+
+void FAnimatedTextureEditorModule::RegisterMenus()
+{
+	FToolMenuOwnerScoped OwnerScoped(this);
+
+	// 多选的资源右键菜单：只要选中了动画纹理就显示，非 GIF 的纹理在执行时跳过
+	UToolMenu* Menu = UToolMenus::Get()->ExtendMenu("ContentBrowser.AssetContextMenu");
+	FToolMenuSection& Section = Menu->FindOrAddSection("GetAssetActions");
+	Section.AddDynamicEntry("AnimatedTextureTranscode", FNewToolMenuSectionDelegate::CreateLambda([](FToolMenuSection& InSection)
+		{
+			const UContentBrowserAssetContextMenuContext* Context = InSection.FindContext<UContentBrowserAssetContextMenuContext>();
+			if (!Context)
+				return;
+
+			TArray<FAssetData> Textures;
+			for (const FAssetData& Asset : Context->SelectedAssets)
+			{
+				if (Asset.IsInstanceOf(UAnimatedTexture2D::StaticClass()))
+					Textures.Add(Asset);
+			}
+			if (Textures.Num() == 0)
+				return;
+
+			InSection.AddMenuEntry("AnimatedTexture_TranscodeToWebp",
+				LOCTEXT("TranscodeToWebp", "Transcode GIF to WebP"),
+				LOCTEXT("TranscodeToWebpTooltip", "Re-encode the selected GIF animated textures as animated WebP with the import settings of the animated texture factory. The original GIF is kept as editor-only source data."),
+				FSlateIcon(),
+				FUIAction(FExecuteAction::CreateLambda([Textures]() { TranscodeToWebp(Textures); })));
+		}));
+}
+
+void FAnimatedTextureEditorModule::TranscodeToWebp(const TArray<FAssetData>& Assets)
+{
+	const FAnimatedTextureWebpSettings& Settings = GetDefault<UAnimatedTextureFactory>()->WebpSettings;
+
+	FScopedSlowTask SlowTask(Assets.Num(), LOCTEXT("TranscodingToWebp", "Transcoding GIF to WebP..."));
+	SlowTask.MakeDialog(/*bShowCancelButton=*/ true);
+
+	int32 NumTranscoded = 0;
+	for (const FAssetData& Asset : Assets)
+	{
+		if (SlowTask.ShouldCancel())
+			break;
+		SlowTask.EnterProgressFrame(1, FText::FromName(Asset.AssetName));
+
+		UAnimatedTexture2D* Texture = Cast<UAnimatedTexture2D>(Asset.GetAsset());
+		if (Texture && Texture->GetFileType() == EAnimatedTextureType::Gif && Texture->TranscodeToWebp(Settings))
+		{
+			// 引用这张纹理的材质需要刷新
+			Texture->PostEditChange();
+			NumTranscoded++;
+		}
+	}
+
+	UE_LOG(LogAnimTextureEditor, Log, TEXT("Transcoded %d of %d animated textures to WebP."), NumTranscoded, Assets.Num());
+}
+
+void FAnimatedTextureEditorModule::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& Event)
+{
+	UMaterialInstanceConstant* Instance = Cast<UMaterialInstanceConstant>(Object);
+	if (!Instance)
+		return;
+
+	// 先收集再写入：SetTextureParameterValueEditorOnly 会修改 TextureParameterValues
+	TArray<TPair<FMaterialParameterInfo, UTexture*>> Companions;
+	for (const FTextureParameterValue& Value : Instance->TextureParameterValues)
+	{
+		const UAnimatedTexture2D* Texture = Cast<UAnimatedTexture2D>(Value.ParameterValue);
+		if (!Texture)
+			continue;
+
+		TArray<TPair<FName, UTexture*>> Parameters;
+		UAnimatedTextureFunctionLibrary::GetCompanionTextureParameters(Texture, Value.ParameterInfo.Name, Parameters);
+		for (const TPair<FName, UTexture*>& Parameter : Parameters)
+		{
+			Companions.Emplace(FMaterialParameterInfo(Parameter.Key, Value.ParameterInfo.Association, Value.ParameterInfo.Index), Parameter.Value);
+		}
+	}
+
+	for (const TPair<FMaterialParameterInfo, UTexture*>& Companion : Companions)
+	{
+		UTexture* Current = nullptr;
+		if (!Instance->GetTextureParameterValue(Companion.Key, Current, /*bOveriddenOnly=*/ true) || Current != Companion.Value)
+		{
+			Instance->SetTextureParameterValueEditorOnly(Companion.Key, Companion.Value);
+			UE_LOG(LogAnimTextureEditor, Log, TEXT("%s: also overriding '%s' to match the animated texture parameter."),
+				*Instance->GetName(), *Companion.Key.Name.ToString());
+		}
+	}
 }
 
 void FAnimatedTextureEditorModule::OnPostEngineInit()
@@ -28,6 +127,10 @@ void FAnimatedTextureEditorModule::OnPostEngineInit()
 
 void FAnimatedTextureEditorModule::ShutdownModule()
 {
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(PropertyChangedHandle);
+	UToolMenus::UnRegisterStartupCallback(this);
+	UToolMenus::UnregisterOwner(this);
+
 	if (UObjectInitialized())
 	{
 		UThumbnailManager::Get().UnregisterCustomRenderer(UAnimatedTexture2D::StaticClass());
@@ -81,6 +81,16 @@ UObject* UAnimatedTextureFactory::FactoryCreateBinary(UClass* InClass, UObject*
 		return nullptr;
 	}
 
+	// 转码失败或结果更大时保留 GIF，TranscodeToWebp 会记录原因；转码同样会合并相同帧并裁剪，不再单独优化。
+	// 两者都会在导入日志里输出前后的帧数与每秒解码像素
+	if (AnimTexture->GetFileType() == EAnimatedTextureType::Gif)
+	{
+		if (bTranscodeGifToWebp)
+			AnimTexture->TranscodeToWebp(WebpSettings);
+		else if (bOptimizeAnimation)
+			AnimTexture->OptimizeAnimation();
+	}
+
 	//Replace the reference for the new texture with the existing one so that all current users still have valid references.
 	RefReplacer.Replace(AnimTexture);
 
@@ -140,6 +150,9 @@ EReimportResult::Type UAnimatedTextureFactory::Reimport(UObject* Obj)
 	float DefaultFrameDelay = pTex->DefaultFrameDelay;
 	bool bLooping = pTex->bLooping;
 
+	// 转码过的纹理重新导入时仍然转码（开启了优化时由 OptimizeAnimation 处理）
+	TGuardValue<bool> TranscodeGuard(bTranscodeGifToWebp, bTranscodeGifToWebp || (pTex->IsTranscodedFromGif() && !bOptimizeAnimation));
+
 	bool OutCanceled = false;
 	if (ImportObject(pTex->GetClass(), pTex->GetOuter(), *pTex->GetName(), RF_Public | RF_Standalone, ResolvedSourceFilePath, nullptr, OutCanceled) != nullptr)
 	{
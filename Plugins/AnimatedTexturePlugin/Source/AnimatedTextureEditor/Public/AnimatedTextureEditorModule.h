@@ -13,6 +13,8 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+struct FAssetData;
+
 class FAnimatedTextureEditorModule : public IModuleInterface
 {
 public:
@@ -23,6 +25,17 @@ public:
 
 private:
 	void OnPostEngineInit();
+
+	/** 内容浏览器右键菜单："Transcode GIF to WebP" */
+	void RegisterMenus();
+
+	/** 批量转码，设置取自 UAnimatedTextureFactory 的默认对象 */
+	static void TranscodeToWebp(const TArray<FAssetData>& Assets);
+
+	/** 材质实例常量覆盖了动画纹理参数时，把材质节点需要的伴随参数一起覆盖（见 UAnimatedTextureFunctionLibrary::GetCompanionTextureParameters） */
+	static void OnObjectPropertyChanged(UObject* Object, struct FPropertyChangedEvent& Event);
+
+	FDelegateHandle PropertyChangedHandle;
 };
 
 DECLARE_LOG_CATEGORY_EXTERN(LogAnimTextureEditor, Log, All);
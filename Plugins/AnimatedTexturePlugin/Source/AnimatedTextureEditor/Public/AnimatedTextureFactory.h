@@ -13,17 +13,31 @@
 #include "CoreMinimal.h"
 #include "Factories/Factory.h"
 #include "EditorReimportHandler.h"	// UnrealEd
+#include "AnimatedTexture2D.h"
 #include "AnimatedTextureFactory.generated.h"
 
 /**
  * Import & Reimport Animated Texture Source, such as .gif file
  * @see class UTextureFactory
  */
-UCLASS()
+UCLASS(config = EditorPerProjectUserSettings)
 class ANIMATEDTEXTUREEDITOR_API UAnimatedTextureFactory : public UFactory, public FReimportHandler
 {
 	GENERATED_UCLASS_BODY()
 
+public:
+	/** Re-encode imported GIFs as animated WebP, the original GIF is kept as editor-only source data */
+	UPROPERTY(EditAnywhere, config, Category = Import)
+		bool bTranscodeGifToWebp = false;
+
+	/** Merge identical frames, crop frames to their changed rectangles and re-encode imported GIFs as lossless WebP when that composites at least 25% fewer pixels without growing the file */
+	UPROPERTY(EditAnywhere, config, Category = Import, meta = (EditCondition = "!bTranscodeGifToWebp"))
+		bool bOptimizeAnimation = false;
+
+	/** Also used by the "Transcode GIF to WebP" asset action */
+	UPROPERTY(EditAnywhere, config, Category = Import, meta = (EditCondition = "bTranscodeGifToWebp"))
+		FAnimatedTextureWebpSettings WebpSettings;
+
 public:
 	//~ Begin UFactory Interface
 	virtual bool FactoryCanImport(const FString& Filename) override;